@@ -0,0 +1,365 @@
+/**
+ ******************************************************************************
+ * File Name          : RP_Log_Bench_Target.c
+ * Description        : RP_Log on-target benchmark (DWT cycle counter)
+ ******************************************************************************
+ * @attention
+ * Copyright (c) 2026 SZU RobotPilots.
+ *
+ * 用 DWT CYCCNT 测量 write() 各等级的周期数、write()/work() 栈用量、work() 发送吞吐量
+ * 适用于 Cortex-M3/M4/M7（STM32F1/F4/F7/H7），用法见 RP_Log_Bench_Target.h
+ *
+ ******************************************************************************
+ */
+
+#include "RP_Log_Bench_Target.h"
+#include <stddef.h>
+
+/* Private define ------------------------------------------------------------*/
+
+// DWT 周期计数器寄存器（与 RP_Log.c 相同，可在编译选项中重定向）
+#ifndef RP_LOG_BENCH_CYCCNT
+#define RP_LOG_BENCH_CYCCNT (*(volatile uint32_t *)0xE0001004UL) // DWT->CYCCNT
+#define RP_LOG_BENCH_DWT_CTRL (*(volatile uint32_t *)0xE0001000UL) // DWT->CTRL
+#define RP_LOG_BENCH_DWT_LAR (*(volatile uint32_t *)0xE0001FB0UL)  // DWT->LAR（Cortex-M7 需解锁）
+#define RP_LOG_BENCH_DEMCR (*(volatile uint32_t *)0xE000EDFCUL)    // CoreDebug->DEMCR
+#endif
+
+#define RP_LOG_BENCH_PATTERN 0xCDCDCDCDUL    // 栈着色值
+#define RP_LOG_BENCH_SKIP_WORDS 16           // 着色时跳过当前栈帧附近的字数
+#define RP_LOG_BENCH_STACK_OVER 0xFFFFFFFFUL // 栈用量超过着色深度
+#define RP_LOG_BENCH_DRAIN_EVERY 8           // 每写入几条清空一次缓冲区（不计时），避免缓冲区满
+
+#define RP_LOG_BENCH_NOINLINE __attribute__((noinline))
+
+/* Private types -------------------------------------------------------------*/
+
+// 日志内容种类
+typedef enum
+{
+    RP_LOG_BENCH_FMT_NONE = 0, // 无参数
+    RP_LOG_BENCH_FMT_INT,      // 两个 int
+    RP_LOG_BENCH_FMT_STR,      // 一个字符串
+    RP_LOG_BENCH_FMT_FLOAT,    // 一个 double
+    RP_LOG_BENCH_FMT_MIXED     // 整型、浮点、字符串混合（栈用量测试）
+} RP_LogBenchFmt_t;
+
+/* Private variables --------------------------------------------------------*/
+
+static const char *g_bench_level_names[] = {"FATAL", "ERROR", "WARN", "INFO", "DEBUG", "TRACE"};
+static volatile uint32_t g_bench_tx_bytes; // RP_LogBench_CountTx 累计的字节数
+
+/* Public variables --------------------------------------------------------*/
+
+RP_LogBenchResult_t g_rp_log_bench;
+
+/* Private function prototypes -----------------------------------------------*/
+
+extern uint32_t SystemCoreClock;
+
+static void RP_LogBench_DwtEnable(void);                                                   // 使能 DWT 计数
+static uint8_t RP_LogBench_IsPending(RP_Log_t *log);                                       // 是否还有待发送数据
+static int RP_LogBench_Drain(RP_Log_t *log);                                               // 发完所有日志
+static int RP_LogBench_WriteOne(RP_Log_t *log, RP_LogLevel_t level, int fmt, uint32_t i);  // 写一条测试日志
+static void RP_LogBench_Measure(RP_Log_t *log, RP_LogLevel_t level, int fmt,
+                                RP_LogBenchCycles_t *cycles);                              // 测量 write() 周期数
+static uint32_t *RP_LogBench_Paint(void);                                                  // 栈着色
+static uint32_t RP_LogBench_StackUse(void (*fn)(RP_Log_t *), RP_Log_t *log);               // 测量栈用量
+static void RP_LogBench_StackWrite(RP_Log_t *log);                                         // 栈用量测试：write()
+static void RP_LogBench_StackWork(RP_Log_t *log);                                          // 栈用量测试：work()
+static void RP_LogBench_Throughput(RP_Log_t *log);                                         // 吞吐量测试
+static void RP_LogBench_Report(RP_Log_t *log, const char *name, const RP_LogBenchCycles_t *cycles); // 输出一项周期数
+
+/* Private functions ---------------------------------------------------------*/
+
+static void RP_LogBench_DwtEnable(void)
+{
+    RP_LOG_BENCH_DEMCR |= (1UL << 24); // TRCENA
+    RP_LOG_BENCH_DWT_LAR = 0xC5ACCE55UL;
+    RP_LOG_BENCH_DWT_CTRL |= 1UL; // CYCCNTENA
+}
+
+static uint8_t RP_LogBench_IsPending(RP_Log_t *log)
+{
+    if (log->get_count(log) != 0)
+    {
+        return 1;
+    }
+    for (uint8_t id = 0; id < RP_LOG_SINK_MAX; id++)
+    {
+        RP_LogSink_t *sink = log->sinks[id];
+        if (sink != NULL && (sink->tx_pending != 0 || sink->tx_busy || sink->dropped_seen != log->dropped))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 循环调用 work() 直到发完，超时返回 -1
+static int RP_LogBench_Drain(RP_Log_t *log)
+{
+    uint32_t timeout = SystemCoreClock / 1000UL * RP_LOG_BENCH_DRAIN_TIMEOUT_MS;
+    uint32_t start = RP_LOG_BENCH_CYCCNT;
+
+    while (RP_LogBench_IsPending(log))
+    {
+        if (RP_LOG_BENCH_CYCCNT - start > timeout)
+        {
+            return -1;
+        }
+        log->work(log);
+    }
+    return 0;
+}
+
+static int RP_LogBench_WriteOne(RP_Log_t *log, RP_LogLevel_t level, int fmt, uint32_t i)
+{
+    switch (fmt)
+    {
+    case RP_LOG_BENCH_FMT_NONE:
+        return log->write(log, level, RP_LOG_FILE, __LINE__, "System started");
+    case RP_LOG_BENCH_FMT_INT:
+        return log->write(log, level, RP_LOG_FILE, __LINE__, "motor %d speed %d", (int)(i & 7), (int)i);
+    case RP_LOG_BENCH_FMT_STR:
+        return log->write(log, level, RP_LOG_FILE, __LINE__, "Motor Offline:%s", "chassis_lf");
+    case RP_LOG_BENCH_FMT_FLOAT:
+        return log->write(log, level, RP_LOG_FILE, __LINE__, "pid out %.3f", (double)i * 0.001);
+    default:
+        return log->write(log, level, RP_LOG_FILE, __LINE__, "id=%u t=%ld v=%.2f s=%s",
+                          (unsigned int)i, (long)i * 3, (double)i * 0.5, "gimbal");
+    }
+}
+
+// 测量 RP_LOG_BENCH_ITER 次 write() 的周期数（已扣除读取 CYCCNT 的开销）
+static void RP_LogBench_Measure(RP_Log_t *log, RP_LogLevel_t level, int fmt, RP_LogBenchCycles_t *cycles)
+{
+    uint32_t sum = 0;
+
+    cycles->min = 0xFFFFFFFFUL;
+    cycles->max = 0;
+
+    for (uint32_t i = 0; i < RP_LOG_BENCH_ITER; i++)
+    {
+        if (i % RP_LOG_BENCH_DRAIN_EVERY == 0)
+        {
+            RP_LogBench_Drain(log);
+        }
+
+        uint32_t t0 = RP_LOG_BENCH_CYCCNT;
+        RP_LogBench_WriteOne(log, level, fmt, i);
+        uint32_t t1 = RP_LOG_BENCH_CYCCNT;
+
+        uint32_t c = t1 - t0;
+        c = (c > g_rp_log_bench.overhead) ? c - g_rp_log_bench.overhead : 0;
+        sum += c;
+        if (c < cycles->min)
+        {
+            cycles->min = c;
+        }
+        if (c > cycles->max)
+        {
+            cycles->max = c;
+        }
+    }
+
+    cycles->avg = sum / RP_LOG_BENCH_ITER;
+    RP_LogBench_Drain(log);
+}
+
+// 从当前栈帧下方 RP_LOG_BENCH_SKIP_WORDS 字处开始向下着色，返回着色区最低地址
+// 返回后该区域不再属于任何栈帧，随后的调用会从着色区上方开始使用
+static RP_LOG_BENCH_NOINLINE uint32_t *RP_LogBench_Paint(void)
+{
+    volatile uint32_t marker = 0;
+    volatile uint32_t *top = (volatile uint32_t *)((uintptr_t)&marker & ~(uintptr_t)3) - RP_LOG_BENCH_SKIP_WORDS;
+
+    for (uint32_t i = 1; i <= RP_LOG_BENCH_STACK_PROBE / 4; i++)
+    {
+        top[-(int32_t)i] = RP_LOG_BENCH_PATTERN;
+    }
+    return (uint32_t *)(top - RP_LOG_BENCH_STACK_PROBE / 4);
+}
+
+// 着色后调用 fn，从最低地址向上找到第一个被改写的字，返回其到本函数栈帧的距离（字节）
+// 结果包含本函数与 fn 之间的少量栈帧开销；着色区被全部改写时返回 RP_LOG_BENCH_STACK_OVER
+static RP_LOG_BENCH_NOINLINE uint32_t RP_LogBench_StackUse(void (*fn)(RP_Log_t *), RP_Log_t *log)
+{
+    volatile uint32_t marker = 0;
+    uint32_t *bottom = RP_LogBench_Paint();
+
+    fn(log);
+
+    volatile uint32_t *p = bottom;
+    while ((uintptr_t)p < (uintptr_t)&marker && *p == RP_LOG_BENCH_PATTERN)
+    {
+        p++;
+    }
+    if (p == bottom)
+    {
+        return RP_LOG_BENCH_STACK_OVER;
+    }
+    return (uint32_t)((uintptr_t)&marker - (uintptr_t)p);
+}
+
+static RP_LOG_BENCH_NOINLINE void RP_LogBench_StackWrite(RP_Log_t *log)
+{
+    RP_LogBench_WriteOne(log, RP_LOG_LEVEL_INFO, RP_LOG_BENCH_FMT_MIXED, 1234);
+}
+
+static RP_LOG_BENCH_NOINLINE void RP_LogBench_StackWork(RP_Log_t *log)
+{
+    log->work(log);
+}
+
+// 写满缓冲区后计时发完：总耗时受串口限制，work() 周期数为 CPU 开销
+// 阻塞式 RP_Log_Transmit 的等待时间计入 work() 周期数
+static void RP_LogBench_Throughput(RP_Log_t *log)
+{
+    RP_LogBenchResult_t *r = &g_rp_log_bench;
+    uint32_t lines = 0;
+
+    RP_LogBench_Drain(log);
+    while (lines < 0xFFFF && RP_LogBench_WriteOne(log, RP_LOG_LEVEL_INFO, RP_LOG_BENCH_FMT_INT, lines) == 0)
+    {
+        lines++;
+    }
+    for (uint8_t id = 0; id < RP_LOG_SINK_MAX; id++)
+    {
+        if (log->sinks[id] != NULL)
+        {
+            log->sinks[id]->dropped_seen = log->dropped; // 写满时的那一条不计入
+        }
+    }
+
+    uint32_t timeout = SystemCoreClock / 1000UL * RP_LOG_BENCH_DRAIN_TIMEOUT_MS;
+    uint32_t work_cycles = 0;
+    g_bench_tx_bytes = 0;
+    uint32_t t0 = RP_LOG_BENCH_CYCCNT;
+
+    while (RP_LogBench_IsPending(log) && RP_LOG_BENCH_CYCCNT - t0 <= timeout)
+    {
+        uint32_t w0 = RP_LOG_BENCH_CYCCNT;
+        log->work(log);
+        work_cycles += RP_LOG_BENCH_CYCCNT - w0;
+    }
+
+    uint32_t elapsed = RP_LOG_BENCH_CYCCNT - t0;
+    if (elapsed == 0)
+    {
+        elapsed = 1;
+    }
+
+    r->drain_lines = lines;
+    r->drain_bytes = g_bench_tx_bytes;
+    r->drain_us = (uint32_t)((uint64_t)elapsed * 1000000ULL / r->core_hz);
+    r->drain_work_cycles = work_cycles;
+    r->drain_bytes_per_s = (uint32_t)((uint64_t)r->drain_bytes * r->core_hz / elapsed);
+    r->link_bytes_per_s = RP_LOG_BENCH_BAUD / 10;
+}
+
+static void RP_LogBench_Report(RP_Log_t *log, const char *name, const RP_LogBenchCycles_t *cycles)
+{
+    log->write(log, RP_LOG_LEVEL_INFO, RP_LOG_FILE, __LINE__, "bench write %s: min %lu avg %lu max %lu cyc", name,
+               (unsigned long)cycles->min, (unsigned long)cycles->avg, (unsigned long)cycles->max);
+    RP_LogBench_Drain(log);
+}
+
+/* Public functions --------------------------------------------------------*/
+
+/**
+ * @brief  运行全部测试，结果写入 g_rp_log_bench 并以 INFO 日志输出
+ * @param  log: 日志模块实例指针（测试期间不能有其他任务写日志或调用 work()）
+ * @retval None
+ */
+void RP_LogBench_Run(RP_Log_t *log)
+{
+    RP_LogBenchResult_t *r = &g_rp_log_bench;
+
+    if (log == NULL)
+    {
+        return;
+    }
+
+    RP_LogBench_DwtEnable();
+    RP_LogBench_Drain(log);
+
+    RP_LogOutputRange_t range = log->config_param.output_range;
+    log->config_param.output_range = RP_LOG_OUTPUT_ALL;
+    r->core_hz = SystemCoreClock;
+
+    // 读取 CYCCNT 本身的开销
+    r->overhead = 0xFFFFFFFFUL;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        uint32_t t0 = RP_LOG_BENCH_CYCCNT;
+        uint32_t t1 = RP_LOG_BENCH_CYCCNT;
+        if (t1 - t0 < r->overhead)
+        {
+            r->overhead = t1 - t0;
+        }
+    }
+
+    // 各等级（两个 int 参数）
+    for (int level = RP_LOG_LEVEL_FATAL; level <= RP_LOG_LEVEL_TRACE; level++)
+    {
+        RP_LogBench_Measure(log, (RP_LogLevel_t)level, RP_LOG_BENCH_FMT_INT, &r->level[level]);
+    }
+
+    // 不同参数
+    RP_LogBench_Measure(log, RP_LOG_LEVEL_INFO, RP_LOG_BENCH_FMT_NONE, &r->none);
+    RP_LogBench_Measure(log, RP_LOG_LEVEL_INFO, RP_LOG_BENCH_FMT_STR, &r->str);
+    RP_LogBench_Measure(log, RP_LOG_LEVEL_INFO, RP_LOG_BENCH_FMT_FLOAT, &r->flt);
+
+    // 被运行时过滤的等级
+    log->config_param.output_range = RP_LOG_OUTPUT_FATAL_ONLY;
+    RP_LogBench_Measure(log, RP_LOG_LEVEL_TRACE, RP_LOG_BENCH_FMT_INT, &r->filtered);
+    log->config_param.output_range = RP_LOG_OUTPUT_ALL;
+
+    // 栈用量：write() 使用最复杂的参数；work() 处理一条同样的日志（延迟格式化时在此格式化）
+    RP_LogBench_Drain(log);
+    r->write_stack = RP_LogBench_StackUse(RP_LogBench_StackWrite, log);
+    r->work_stack = RP_LogBench_StackUse(RP_LogBench_StackWork, log);
+    RP_LogBench_Drain(log);
+
+    // 吞吐量
+    RP_LogBench_Throughput(log);
+
+    // 输出结果
+    log->write(log, RP_LOG_LEVEL_INFO, RP_LOG_FILE, __LINE__, "bench core %lu Hz, CYCCNT overhead %lu cyc",
+               (unsigned long)r->core_hz, (unsigned long)r->overhead);
+    RP_LogBench_Drain(log);
+    for (int level = RP_LOG_LEVEL_FATAL; level <= RP_LOG_LEVEL_TRACE; level++)
+    {
+        RP_LogBench_Report(log, g_bench_level_names[level], &r->level[level]);
+    }
+    RP_LogBench_Report(log, "no args", &r->none);
+    RP_LogBench_Report(log, "%s", &r->str);
+    RP_LogBench_Report(log, "%f", &r->flt);
+    RP_LogBench_Report(log, "filtered", &r->filtered);
+
+    log->write(log, RP_LOG_LEVEL_INFO, RP_LOG_FILE, __LINE__, "bench stack write %s%lu B, work %s%lu B",
+               r->write_stack == RP_LOG_BENCH_STACK_OVER ? ">" : "",
+               (unsigned long)(r->write_stack == RP_LOG_BENCH_STACK_OVER ? RP_LOG_BENCH_STACK_PROBE : r->write_stack),
+               r->work_stack == RP_LOG_BENCH_STACK_OVER ? ">" : "",
+               (unsigned long)(r->work_stack == RP_LOG_BENCH_STACK_OVER ? RP_LOG_BENCH_STACK_PROBE : r->work_stack));
+    RP_LogBench_Drain(log);
+    log->write(log, RP_LOG_LEVEL_INFO, RP_LOG_FILE, __LINE__,
+               "bench drain %lu lines %lu B in %lu us (work %lu cyc), %lu B/s, link %lu B/s",
+               (unsigned long)r->drain_lines, (unsigned long)r->drain_bytes, (unsigned long)r->drain_us,
+               (unsigned long)r->drain_work_cycles, (unsigned long)r->drain_bytes_per_s,
+               (unsigned long)r->link_bytes_per_s);
+    RP_LogBench_Drain(log);
+
+    log->config_param.output_range = range;
+}
+
+/**
+ * @brief  统计发送字节数（在 RP_Log_Transmit 发送成功时调用，可在中断中调用）
+ * @param  length: 本次发送的字节数
+ * @retval None
+ */
+void RP_LogBench_CountTx(uint16_t length)
+{
+    g_bench_tx_bytes += length;
+}
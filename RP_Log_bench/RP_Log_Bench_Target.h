@@ -0,0 +1,111 @@
+/**
+  ******************************************************************************
+  * File Name          : RP_Log_Bench_Target.h
+  * Description        : RP_Log on-target benchmark (DWT cycle counter)
+  ******************************************************************************
+  * @attention
+  * Copyright (c) 2026 SZU RobotPilots.
+  ******************************************************************************
+  *
+  * ==============================================================================
+                       ##### How To Use #####
+  * ==============================================================================
+  * (#) 将 RP_Log_Bench_Target.c 加入工程（与 RP_Log.c 使用相同的配置宏），需 Cortex-M3 及以上
+  *     （STM32F1/F4 等），测试结束后从工程中移除
+  *
+  * (#) 统计发送字节数（可选，用于计算串口利用率）：在 RP_Log_Transmit 成功时调用
+  *     int RP_Log_Transmit(const uint8_t *data, uint16_t length)
+  *     {
+  *         if (HAL_UART_Transmit_DMA(&huart1, data, length) == HAL_OK) {
+  *             RP_LogBench_CountTx(length);
+  *             return 0;
+  *         }
+  *         return -1;
+  *     }
+  *
+  * (#) 在日志线程启动前调用一次（测试期间自行调用 work()，不能有其他任务写日志）：
+  *     RP_LogBench_Run(&g_rp_log);
+  *     结果写入 g_rp_log_bench（可在调试器中查看），并以 INFO 日志输出
+  *
+  * (#) 在 RTOS 任务中运行时任务栈需比 RP_LOG_BENCH_STACK_PROBE 多约 512 字节；
+  *     裸机下中断与 main 共用栈，栈用量可能偏大
+  *
+  * ==============================================================================
+                       ##### Measurements #####
+  * ==============================================================================
+  * - 各等级 write() 的周期数（最小/平均/最大，已扣除读取 CYCCNT 的开销）
+  * - 不同参数的 write() 周期数、被 output_range 过滤掉的 write() 周期数
+  * - write() 与 work() 的栈用量（栈着色后查看最深被改写的位置）
+  * - 写满缓冲区后 work() 发完所有日志的耗时：输出字节/秒与 RP_LOG_BENCH_BAUD / 10 比较
+  *
+  ******************************************************************************
+  */
+
+#ifndef __RP_LOG_BENCH_TARGET_H
+#define __RP_LOG_BENCH_TARGET_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "RP_Log.h"
+
+/*Config param start----------------------------------------------------------*/
+#ifndef RP_LOG_BENCH_ITER
+#define RP_LOG_BENCH_ITER 64 // 每项测量次数
+#endif
+#ifndef RP_LOG_BENCH_BAUD
+#define RP_LOG_BENCH_BAUD 115200 // 日志串口波特率（8N1，每字节 10 位）
+#endif
+#ifndef RP_LOG_BENCH_STACK_PROBE
+#define RP_LOG_BENCH_STACK_PROBE 2048 // 栈着色深度（字节）
+#endif
+#ifndef RP_LOG_BENCH_DRAIN_TIMEOUT_MS
+#define RP_LOG_BENCH_DRAIN_TIMEOUT_MS 5000 // 等待缓冲区发完的最长时间
+#endif
+    /*Config param end------------------------------------------------------------*/
+
+    /* Exported types ------------------------------------------------------------*/
+
+    // 一项周期数统计
+    typedef struct
+    {
+        uint32_t min; // 最小周期数
+        uint32_t avg; // 平均周期数
+        uint32_t max; // 最大周期数（含中断打断）
+    } RP_LogBenchCycles_t;
+
+    // 测试结果
+    typedef struct
+    {
+        uint32_t core_hz;                  // 内核时钟
+        uint32_t overhead;                 // 读取两次 CYCCNT 的开销（已从结果中扣除）
+        RP_LogBenchCycles_t level[6];      // 各等级 write()（两个 int 参数）
+        RP_LogBenchCycles_t none;          // 无参数
+        RP_LogBenchCycles_t str;           // 一个 %s
+        RP_LogBenchCycles_t flt;           // 一个 %f
+        RP_LogBenchCycles_t filtered;      // 被 output_range 过滤
+        uint32_t write_stack;              // write() 栈用量（字节，0xFFFFFFFF=超过 RP_LOG_BENCH_STACK_PROBE）
+        uint32_t work_stack;               // work() 栈用量（同上）
+        uint32_t drain_lines;              // 吞吐量测试的日志条数
+        uint32_t drain_bytes;              // 吞吐量测试发送的字节数（未调用 RP_LogBench_CountTx 时为 0）
+        uint32_t drain_us;                 // 发完所有日志的耗时
+        uint32_t drain_work_cycles;        // 其中 work() 本身的周期数
+        uint32_t drain_bytes_per_s;        // 实际输出字节/秒
+        uint32_t link_bytes_per_s;         // 串口理论字节/秒（RP_LOG_BENCH_BAUD / 10）
+    } RP_LogBenchResult_t;
+
+    /* Exported variables --------------------------------------------------------*/
+    extern RP_LogBenchResult_t g_rp_log_bench;
+
+    /* Exported functions --------------------------------------------------------*/
+
+    void RP_LogBench_Run(RP_Log_t *log);        // 运行全部测试并输出结果
+    void RP_LogBench_CountTx(uint16_t length);  // 统计发送字节数（在 RP_Log_Transmit 中调用）
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
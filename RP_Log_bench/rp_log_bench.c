@@ -0,0 +1,458 @@
+/**
+ ******************************************************************************
+ * File Name          : rp_log_bench.c
+ * Description        : RP_Log host benchmark (PC, POSIX)
+ ******************************************************************************
+ * @attention
+ * Copyright (c) 2026 SZU RobotPilots.
+ *
+ * 在 PC 上编译 RP_Log.c，测量 RB_Push、write()、work() 的耗时，用于修改前后对比
+ * 直接包含 RP_Log.c 以便调用内部静态函数；RP_Log_Transmit 由 rp_log_bench_port.c 提供
+ * 数值只用于同一台电脑上的前后对比，单片机上的周期数见 RP_Log_Bench_Target.c
+ *
+ * 编译：gcc -O2 -pthread -I../RP_Log_master rp_log_bench.c rp_log_bench_port.c -o rp_log_bench
+ *       其他配置在两个文件上加相同的 -D，如 -DRP_LOG_USE_DEFERRED=1 -DRP_LOG_USE_BINARY=1
+ * 用法：rp_log_bench [-n 每项次数] [-r 重复轮数] [-t 线程数] [-csv]
+ *
+ ******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#ifndef USE_HAL_DRIVER
+#define USE_HAL_DRIVER // 时间戳使用 HAL_GetTick()（由 rp_log_bench_port.c 提供）
+#endif
+
+#include "rp_log_bench_port.h"
+#include "RP_Log.c"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Private define ------------------------------------------------------------*/
+
+#define BENCH_CHUNK 16        // 每批写入条数，批与批之间在计时外清空缓冲区
+#define BENCH_THREAD_MAX 64   // 最多生产者线程数
+
+/* Private types -------------------------------------------------------------*/
+
+// 日志内容种类
+typedef enum
+{
+    BENCH_FMT_NONE = 0, // 无参数
+    BENCH_FMT_INT,      // 两个 int
+    BENCH_FMT_FLOAT,    // 一个 double
+    BENCH_FMT_STR,      // 一个字符串
+    BENCH_FMT_MIXED,    // 整型、浮点、字符串混合
+    BENCH_FMT_COUNT
+} Bench_Fmt_t;
+
+// 命令行选项
+typedef struct
+{
+    uint32_t n;       // 每项测量次数
+    uint32_t repeat;  // 重复轮数（取最快一轮）
+    uint32_t threads; // 并发写测试的生产者线程数（0=跳过）
+    int csv;          // 输出 CSV
+} Bench_Opt_t;
+
+// 生产者线程参数
+typedef struct
+{
+    pthread_t id;
+    uint32_t ops;    // 写入次数
+    uint32_t failed; // 写入失败（缓冲区满）次数
+#if RP_LOG_USE_STAGE
+    RP_LogStage_t *stage; // 本线程的暂存区（前 RP_LOG_STAGE_MAX 个线程注册成功）
+#endif
+} Bench_Thread_t;
+
+/* Private variables --------------------------------------------------------*/
+
+static const char *g_bench_fmt_names[BENCH_FMT_COUNT] = {"none", "2 int", "float", "string", "mixed"};
+
+static Bench_Opt_t g_opt = {200000, 5, 4, 0};
+static RP_LogConfigParam_t g_bench_config; // 启动时的默认配置，每项测试前恢复
+static volatile int g_bench_go;            // 生产者开始
+static volatile int g_bench_stop;          // 消费者退出
+#if RP_LOG_USE_STAGE
+static RP_LogStage_t g_bench_stages[BENCH_THREAD_MAX]; // 生产者线程的暂存区（注册后不能释放）
+#endif
+
+/* Private functions ---------------------------------------------------------*/
+
+// 单调时钟（纳秒）
+static uint64_t Bench_Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 恢复默认配置并清空缓冲区
+static void Bench_Reset(void)
+{
+    g_rp_log.dropped = 0;
+    g_rp_log.flush(&g_rp_log);
+    g_rp_log.config_param = g_bench_config;
+}
+
+// 处理完缓冲区中的所有日志
+static void Bench_Drain(void)
+{
+    while (RP_Log_IsPending(&g_rp_log) || g_rp_log_uart.tx_pending != 0)
+    {
+        g_rp_log.work(&g_rp_log);
+    }
+}
+
+// 写一条指定种类的日志
+static int Bench_WriteOne(RP_LogLevel_t level, int fmt, uint32_t i)
+{
+    switch (fmt)
+    {
+    case BENCH_FMT_NONE:
+        return g_rp_log.write(&g_rp_log, level, RP_LOG_FILE, __LINE__, "System started");
+    case BENCH_FMT_INT:
+        return g_rp_log.write(&g_rp_log, level, RP_LOG_FILE, __LINE__, "motor %d speed %d", (int)(i & 7), (int)i);
+    case BENCH_FMT_FLOAT:
+        return g_rp_log.write(&g_rp_log, level, RP_LOG_FILE, __LINE__, "pid out %.3f", (double)i * 0.001);
+    case BENCH_FMT_STR:
+        return g_rp_log.write(&g_rp_log, level, RP_LOG_FILE, __LINE__, "Motor Offline:%s", "chassis_lf");
+    default:
+        return g_rp_log.write(&g_rp_log, level, RP_LOG_FILE, __LINE__, "id=%u t=%ld v=%.2f s=%s",
+                              i, (long)i * 3, (double)i * 0.5, "gimbal");
+    }
+}
+
+// 输出一行结果（mbps < 0 时不输出吞吐量）
+static void Bench_Report(const char *name, double ns, double mbps, uint64_t ops, uint64_t dropped)
+{
+    if (g_opt.csv)
+    {
+        printf("%s,%.1f,%.1f,%llu,%llu\n", name, ns, mbps < 0 ? 0.0 : mbps,
+               (unsigned long long)ops, (unsigned long long)dropped);
+    }
+    else if (mbps < 0)
+    {
+        printf("%-28s %10.1f %10s %10llu %8llu\n", name, ns, "-",
+               (unsigned long long)ops, (unsigned long long)dropped);
+    }
+    else
+    {
+        printf("%-28s %10.1f %10.1f %10llu %8llu\n", name, ns, mbps,
+               (unsigned long long)ops, (unsigned long long)dropped);
+    }
+}
+
+// RB_Push：每轮从空缓冲区开始连续写入，直到快满
+static void Bench_RbPush(uint16_t length)
+{
+    uint8_t data[RP_LOG_ENTRY_MAX_SIZE];
+    char name[64];
+    double best = 1e30;
+    uint64_t ops = 0;
+    uint64_t dropped = 0;
+
+    if (length > RP_LOG_ENTRY_MAX_SIZE)
+    {
+        length = RP_LOG_ENTRY_MAX_SIZE;
+    }
+    memset(data, 'x', sizeof(data));
+
+    uint32_t per_round = RP_LOG_RING_BUFFER_SIZE / length;
+    if (per_round > RP_LOG_RING_BUFFER_CNT)
+    {
+        per_round = RP_LOG_RING_BUFFER_CNT;
+    }
+    per_round = (per_round > 1) ? per_round - 1 : 1;
+
+    for (uint32_t r = 0; r < g_opt.repeat; r++)
+    {
+        uint64_t total = 0;
+        ops = 0;
+        while (ops < g_opt.n)
+        {
+            Bench_Reset();
+            uint64_t t0 = Bench_Now();
+            for (uint32_t k = 0; k < per_round; k++)
+            {
+                if (RB_Push(g_rp_log.ring_buffer, data, length, RP_LOG_ENTRY_TEXT, RP_LOG_LEVEL_INFO) < 0)
+                {
+                    dropped++;
+                }
+            }
+            total += Bench_Now() - t0;
+            ops += per_round;
+        }
+        if ((double)total / ops < best)
+        {
+            best = (double)total / ops;
+        }
+    }
+
+    snprintf(name, sizeof(name), "RB_Push %uB", length);
+    Bench_Report(name, best, -1, ops, dropped);
+}
+
+// write()：每批 BENCH_CHUNK 条计时，批间清空缓冲区（不计时）
+static void Bench_Write(const char *name, RP_LogLevel_t level, int fmt, RP_LogOutputRange_t range)
+{
+    double best = 1e30;
+    uint64_t ops = 0;
+    uint64_t dropped = 0;
+
+    for (uint32_t r = 0; r < g_opt.repeat; r++)
+    {
+        uint64_t total = 0;
+        Bench_Reset();
+        g_rp_log.config_param.output_range = range;
+        ops = 0;
+        while (ops < g_opt.n)
+        {
+            uint32_t dropped0 = g_rp_log.dropped;
+            uint64_t t0 = Bench_Now();
+            for (uint32_t k = 0; k < BENCH_CHUNK; k++)
+            {
+                Bench_WriteOne(level, fmt, (uint32_t)ops + k);
+            }
+            total += Bench_Now() - t0;
+            ops += BENCH_CHUNK;
+            g_bench_tick++;
+
+            dropped += g_rp_log.dropped - dropped0;
+            Bench_Drain();
+        }
+        if ((double)total / ops < best)
+        {
+            best = (double)total / ops;
+        }
+    }
+
+    Bench_Report(name, best, -1, ops, dropped);
+}
+
+// work()：先写满缓冲区（不计时），再计时处理完所有日志，结果为每行耗时和输出吞吐量
+static void Bench_Work(int fmt)
+{
+    char name[64];
+    double best = 1e30;
+    double best_mbps = 0;
+    uint64_t lines = 0;
+
+    for (uint32_t r = 0; r < g_opt.repeat; r++)
+    {
+        uint64_t total = 0;
+        uint64_t bytes = 0;
+        Bench_Reset();
+        lines = 0;
+        while (lines < g_opt.n)
+        {
+            uint32_t k = 0;
+            while (Bench_WriteOne(RP_LOG_LEVEL_INFO, fmt, k) == 0)
+            {
+                k++;
+            }
+            g_rp_log_uart.dropped_seen = g_rp_log.dropped; // 写满时的那一条不计入
+            if (k == 0)
+            {
+                break;
+            }
+
+            uint64_t b0 = g_bench_tx_bytes;
+            uint64_t t0 = Bench_Now();
+            Bench_Drain();
+            total += Bench_Now() - t0;
+            bytes += g_bench_tx_bytes - b0;
+            lines += k;
+            g_bench_tick++;
+        }
+        if (lines != 0 && (double)total / lines < best)
+        {
+            best = (double)total / lines;
+            best_mbps = (double)bytes * 1000.0 / (double)total;
+        }
+    }
+
+    snprintf(name, sizeof(name), "work %s", g_bench_fmt_names[fmt]);
+    Bench_Report(name, best, best_mbps, lines, 0);
+}
+
+// 并发写：生产者线程
+static void *Bench_Producer(void *arg)
+{
+    Bench_Thread_t *t = (Bench_Thread_t *)arg;
+#if RP_LOG_USE_STAGE
+    g_rp_log.add_stage(&g_rp_log, t->stage);
+#endif
+    while (!__atomic_load_n(&g_bench_go, __ATOMIC_ACQUIRE))
+    {
+    }
+    for (uint32_t i = 0; i < t->ops; i++)
+    {
+        if (Bench_WriteOne(RP_LOG_LEVEL_INFO, BENCH_FMT_INT, i) != 0)
+        {
+            t->failed++;
+        }
+    }
+    return NULL;
+}
+
+// 并发写：消费者线程（日志线程）
+static void *Bench_Consumer(void *arg)
+{
+    (void)arg;
+    while (!__atomic_load_n(&g_bench_stop, __ATOMIC_ACQUIRE))
+    {
+        g_rp_log.work(&g_rp_log);
+    }
+    return NULL;
+}
+
+// 多个线程同时写，另一线程运行 work()；结果为单个线程每次写入的平均耗时
+static void Bench_Contention(uint32_t threads)
+{
+    Bench_Thread_t t[BENCH_THREAD_MAX];
+    pthread_t consumer;
+    char name[64];
+    uint32_t started = 0;
+
+    Bench_Reset();
+    g_bench_go = 0;
+    g_bench_stop = 0;
+    if (pthread_create(&consumer, NULL, Bench_Consumer, NULL) != 0)
+    {
+        fprintf(stderr, "rp_log_bench: pthread_create failed\n");
+        return;
+    }
+    for (; started < threads; started++)
+    {
+        t[started].ops = g_opt.n / threads;
+        t[started].failed = 0;
+#if RP_LOG_USE_STAGE
+        t[started].stage = &g_bench_stages[started];
+#endif
+        if (pthread_create(&t[started].id, NULL, Bench_Producer, &t[started]) != 0)
+        {
+            break;
+        }
+    }
+
+    uint64_t t0 = Bench_Now();
+    __atomic_store_n(&g_bench_go, 1, __ATOMIC_RELEASE);
+
+    uint64_t ops = 0;
+    uint64_t failed = 0;
+    for (uint32_t i = 0; i < started; i++)
+    {
+        pthread_join(t[i].id, NULL);
+        ops += t[i].ops;
+        failed += t[i].failed;
+    }
+    uint64_t total = Bench_Now() - t0;
+
+    __atomic_store_n(&g_bench_stop, 1, __ATOMIC_RELEASE);
+    pthread_join(consumer, NULL);
+    Bench_Drain();
+
+    snprintf(name, sizeof(name), "write x%u threads", started);
+    Bench_Report(name, ops ? (double)total * started / ops : 0.0, -1, ops, failed);
+}
+
+static void Bench_Usage(void)
+{
+    fprintf(stderr, "usage: rp_log_bench [-n count] [-r repeat] [-t threads] [-csv]\n");
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(int argc, char **argv)
+{
+    static const char *level_names[] = {"FATAL", "ERROR", "WARN", "INFO", "DEBUG", "TRACE"};
+    char name[64];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-csv") == 0)
+        {
+            g_opt.csv = 1;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+        {
+            g_opt.n = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-r") == 0)
+        {
+            g_opt.repeat = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "-t") == 0)
+        {
+            g_opt.threads = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            Bench_Usage();
+            return 1;
+        }
+    }
+    if (g_opt.n < BENCH_CHUNK || g_opt.repeat == 0)
+    {
+        Bench_Usage();
+        return 1;
+    }
+    if (g_opt.threads > BENCH_THREAD_MAX)
+    {
+        g_opt.threads = BENCH_THREAD_MAX;
+    }
+
+    g_rp_log.recover(&g_rp_log); // RP_LOG_USE_NOINIT 时启用各输出
+    g_bench_config = g_rp_log.config_param;
+    g_bench_tick = 123456;
+
+    if (g_opt.csv)
+    {
+        printf("case,ns_per_op,mb_per_s,ops,dropped\n");
+    }
+    else
+    {
+        printf("RP_Log host bench: DEFERRED=%d LITE=%d BINARY=%d TS=%s TX_CPLT=%d STAGE=%d RING=%d/%d ENTRY=%d\n",
+               RP_LOG_USE_DEFERRED, RP_LOG_USE_LITE_FORMAT, RP_LOG_USE_BINARY,
+               RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT ? "DWT" : "HAL", RP_LOG_USE_TX_CPLT, RP_LOG_USE_STAGE,
+               RP_LOG_RING_BUFFER_SIZE, RP_LOG_RING_BUFFER_CNT, RP_LOG_ENTRY_MAX_SIZE);
+        printf("%-28s %10s %10s %10s %8s\n", "case", "ns/op", "MB/s", "ops", "dropped");
+    }
+
+    // 环形缓冲区
+    Bench_RbPush(16);
+    Bench_RbPush(64);
+    Bench_RbPush(200);
+
+    // 写日志：不同内容
+    for (int fmt = 0; fmt < BENCH_FMT_COUNT; fmt++)
+    {
+        snprintf(name, sizeof(name), "write INFO %s", g_bench_fmt_names[fmt]);
+        Bench_Write(name, RP_LOG_LEVEL_INFO, fmt, RP_LOG_OUTPUT_ALL);
+    }
+
+    // 写日志：各等级
+    for (int level = RP_LOG_LEVEL_FATAL; level <= RP_LOG_LEVEL_TRACE; level++)
+    {
+        snprintf(name, sizeof(name), "write %s 2 int", level_names[level]);
+        Bench_Write(name, (RP_LogLevel_t)level, BENCH_FMT_INT, RP_LOG_OUTPUT_ALL);
+    }
+
+    // 运行时过滤掉的等级
+    Bench_Write("write TRACE filtered", RP_LOG_LEVEL_TRACE, BENCH_FMT_INT, RP_LOG_OUTPUT_FATAL_ONLY);
+
+    // 日志线程处理
+    Bench_Work(BENCH_FMT_INT);
+    Bench_Work(BENCH_FMT_MIXED);
+
+    // 并发写
+    if (g_opt.threads != 0)
+    {
+        Bench_Contention(g_opt.threads);
+    }
+
+    return 0;
+}
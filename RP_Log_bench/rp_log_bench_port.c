@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ * File Name          : rp_log_bench_port.c
+ * Description        : RP_Log host benchmark port (fake HAL / DWT / UART)
+ ******************************************************************************
+ * @attention
+ * Copyright (c) 2026 SZU RobotPilots.
+ *
+ * RP_Log_Transmit 的强定义：只统计字节数，立即视为发送完成
+ * 单独编译，覆盖 RP_Log.c 中的弱定义（同一编译单元内无法覆盖）
+ *
+ ******************************************************************************
+ */
+
+#include "rp_log_bench_port.h"
+#include "RP_Log.h"
+
+/* Private define ------------------------------------------------------------*/
+
+#define RP_LOG_BENCH_CYC_STEP 168 // 每次读取 CYCCNT 前进的周期数（168MHz 下约 1us）
+
+/* Public variables --------------------------------------------------------*/
+
+volatile uint32_t g_bench_tick;
+volatile uint32_t g_bench_cyccnt;
+volatile uint32_t g_bench_dwt_ctrl;
+volatile uint32_t g_bench_dwt_lar;
+volatile uint32_t g_bench_demcr;
+volatile uint64_t g_bench_tx_bytes;
+volatile uint64_t g_bench_tx_calls;
+volatile uint32_t g_bench_tx_sum;
+uint32_t SystemCoreClock = 168000000UL;
+
+/* Public functions --------------------------------------------------------*/
+
+uint32_t HAL_GetTick(void)
+{
+    return g_bench_tick;
+}
+
+volatile uint32_t *RP_LogBench_Cyccnt(void)
+{
+    g_bench_cyccnt += RP_LOG_BENCH_CYC_STEP;
+    return &g_bench_cyccnt;
+}
+
+/**
+ * @brief  串口发送替身：统计字节数，不产生输出
+ * @param  data: 待发送数据指针
+ * @param  length: 数据长度
+ * @retval 0=成功
+ */
+int RP_Log_Transmit(const uint8_t *data, uint16_t length)
+{
+    g_bench_tx_bytes += length;
+    g_bench_tx_calls++;
+    g_bench_tx_sum += data[0] + data[length - 1];
+
+#if RP_LOG_USE_TX_CPLT
+    // 模拟 DMA 立即完成（RP_Log 允许在 RP_Log_Transmit 返回前通知完成）
+    g_rp_log.tx_cplt(&g_rp_log);
+#endif
+    return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ * File Name          : rp_log_bench_port.h
+ * Description        : RP_Log host benchmark port (fake HAL / DWT)
+ ******************************************************************************
+ * @attention
+ * Copyright (c) 2026 SZU RobotPilots.
+ *
+ * 在 PC 上编译 RP_Log.c 所需的替身：HAL_GetTick、DWT 寄存器、SystemCoreClock
+ * 以及统计发送字节数的 RP_Log_Transmit（见 rp_log_bench_port.c）
+ * 须在包含 RP_Log.c 之前包含
+ *
+ ******************************************************************************
+ */
+
+#ifndef RP_LOG_BENCH_PORT_H
+#define RP_LOG_BENCH_PORT_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+/* Exported variables --------------------------------------------------------*/
+
+extern volatile uint32_t g_bench_tick;      // HAL_GetTick() 返回值（由测试程序推进）
+extern volatile uint32_t g_bench_cyccnt;    // 假 DWT->CYCCNT（每次读取前进 RP_LOG_BENCH_CYC_STEP）
+extern volatile uint32_t g_bench_dwt_ctrl;  // 假 DWT->CTRL
+extern volatile uint32_t g_bench_dwt_lar;   // 假 DWT->LAR
+extern volatile uint32_t g_bench_demcr;     // 假 CoreDebug->DEMCR
+extern volatile uint64_t g_bench_tx_bytes;  // 累计发送字节数
+extern volatile uint64_t g_bench_tx_calls;  // 累计 RP_Log_Transmit 调用次数
+extern volatile uint32_t g_bench_tx_sum;    // 发送内容校验（防止发送被优化掉）
+extern uint32_t SystemCoreClock;
+
+/* Exported functions --------------------------------------------------------*/
+
+uint32_t HAL_GetTick(void);                 // 假 HAL 时基
+volatile uint32_t *RP_LogBench_Cyccnt(void); // 读取假 CYCCNT（读一次前进一步）
+
+// RP_Log.c 中的 DWT 寄存器重定向到假寄存器
+#define RP_LOG_DWT_CYCCNT (*RP_LogBench_Cyccnt())
+#define RP_LOG_DWT_CTRL g_bench_dwt_ctrl
+#define RP_LOG_DWT_LAR g_bench_dwt_lar
+#define RP_LOG_DEMCR g_bench_demcr
+
+// 任务暂存区按线程查找（RP_LOG_USE_STAGE）
+#define RP_LOG_TASK_SELF() ((void *)pthread_self())
+
+#endif
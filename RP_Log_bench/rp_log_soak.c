@@ -0,0 +1,929 @@
+/**
+ ******************************************************************************
+ * File Name          : rp_log_soak.c
+ * Description        : RP_Log link soak / replay simulator (PC, POSIX)
+ ******************************************************************************
+ * @attention
+ * Copyright (c) 2026 SZU RobotPilots.
+ *
+ * 按原始时间把比赛中录下的 .LOG 重新经 write() 写入，模拟串口波特率、DMA 发送完成、
+ * TF_Log 模块接收缓冲区（RINGBUF_SIZE）和 TF 卡周期同步（SYNC_INTERVAL）时的停顿，
+ * 报告每种配置下的丢弃率、最大排队深度和端到端延迟分位数，用于赛前确定缓冲区尺寸
+ *
+ * 虚拟时间离散事件仿真，与电脑快慢无关，同一输入和参数结果完全相同
+ * 直接包含 RP_Log.c 以便读取读写指针；运行时参数可以逗号分隔多个取值，逐一组合运行
+ * 编译期参数（RP_LOG_ENTRY_MAX_SIZE、RP_LOG_USE_DEFERRED 等）在编译时加 -D，与 rp_log_bench 相同
+ *
+ * 编译：gcc -O2 -pthread -I../RP_Log_master -I../RP_Log_tools rp_log_soak.c rp_log_bench_port.c \
+ *           ../RP_Log_tools/rp_log_host.c -o rp_log_soak
+ * 用法：rp_log_soak [-R arena] [-B batch_max] [-b baud] [-m ringbuf] [-y sync_ms] [-k stall_ms]
+ *                   [-c card_Bps] [-p work_us] [-N] [-S] [-O] [-M] [-x speed] [-l loops]
+ *                   [-e app.elf] [-f dwt_hz] [-csv] match.LOG
+ *
+ ******************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+#ifndef USE_HAL_DRIVER
+#define USE_HAL_DRIVER // 时间戳使用 HAL_GetTick()（由 rp_log_bench_port.c 提供，此处为仿真时间）
+#endif
+
+#include "rp_log_bench_port.h"
+#include "RP_Log.c"
+#include "rp_log_host.h"
+
+#include <stdlib.h>
+
+/* Private define ------------------------------------------------------------*/
+
+#define SOAK_SWEEP_MAX 8                // 每个运行时参数最多取值个数
+#define SOAK_ARENA_MAX (64 * 1024)      // -R 最大值
+#define SOAK_TEXT_MAX 1024              // 重放的一条日志正文最大长度
+#define SOAK_DISCARDED UINT64_MAX       // DISCARD_OLDEST 丢掉的条目（写入时间表中的标记）
+#define SOAK_NEVER UINT64_MAX           // 没有下一事件
+#define SOAK_TAIL_US (60ULL * 1000000)  // 最后一条日志之后最多再仿真的时间
+
+/* Private types -------------------------------------------------------------*/
+
+// 重放的一条日志
+typedef struct
+{
+    uint64_t time;   // 相对第一条的时间（微秒）
+    uint32_t text;   // 正文在 g_soak_pool 中的偏移（以 '\0' 结尾）
+    uint32_t file;   // 文件名在 g_soak_pool 中的偏移
+    uint16_t line;   // 行号
+    uint8_t level;   // 等级
+} Soak_Record_t;
+
+// 一组运行时参数（每种组合运行一次）
+typedef struct
+{
+    uint32_t arena;    // RP_Log_Init() 的内存字节数
+    uint32_t batch;    // 串口输出的 batch_max
+    uint32_t baud;     // 串口波特率（8N1，每字节 10 位）
+    uint32_t ringbuf;  // TF_Log 模块接收缓冲区字节数（CMD:RINGBUF_SIZE）
+    uint32_t sync_ms;  // TF_Log 模块同步间隔（CMD:SYNC_INTERVAL，0=不同步）
+} Soak_Param_t;
+
+// 发往 TF_Log 模块的一次发送（到卡之前）
+typedef struct
+{
+    double end;     // 本块最后一个字节在模块接收字节流中的位置
+    uint32_t first; // 本块携带的第一条日志在 delivered 中的序号
+    uint32_t count; // 本块携带的日志条数
+} Soak_Chunk_t;
+
+// 可增长数组
+typedef struct
+{
+    void *data;
+    size_t len;
+    size_t cap;
+} Soak_Vec_t;
+
+// 一次运行的状态和结果
+typedef struct
+{
+    const Soak_Param_t *param;
+    uint64_t now;              // 仿真时间（微秒）
+    uint64_t next_work;        // 日志线程下一次超时醒来的时间
+    uint64_t tx_done;          // 当前发送完成的时间（SOAK_NEVER=空闲）
+    uint32_t tx_length;        // 当前发送的字节数
+    uint16_t acc[2];           // 各缓冲区已计入发送的条目位置（0=主缓冲区，1=高优先级通道）
+    uint8_t notified;          // notify 已调用，日志线程待唤醒
+
+    // 模块
+    double card_pos;           // 已写入 TF 卡的字节位置
+    double card_time;          // card_pos 对应的时间
+    double received;           // 模块已接收的字节位置
+    size_t chunk_head;         // chunks 中最早一块的序号
+
+    // 统计
+    uint64_t written;          // write() 成功条数
+    uint64_t dropped;          // write() 因缓冲区满失败条数
+    uint64_t discarded;        // DISCARD_OLDEST 丢掉的条数
+    uint64_t module_lost;      // 模块接收缓冲区溢出丢掉的条数
+    uint64_t module_lost_bytes;
+    uint64_t tx_bytes;         // 串口发送字节数
+    uint32_t peak_bytes;       // 主缓冲区（含高优先级通道）最高占用字节数
+    uint32_t peak_entries;     // 最多条目数
+    double module_peak;        // 模块接收缓冲区最高占用字节数
+    Soak_Vec_t delivered;      // 已发到模块的各条日志的写入时间（uint64_t）
+    Soak_Vec_t uart_lat;       // 写入到离开串口的延迟（uint32_t 微秒）
+    Soak_Vec_t card_lat;       // 写入到写入 TF 卡的延迟
+    Soak_Vec_t chunks;         // Soak_Chunk_t
+} Soak_Run_t;
+
+/* Private variables --------------------------------------------------------*/
+
+static char *g_soak_pool;                  // 正文和文件名
+static size_t g_soak_pool_len, g_soak_pool_cap;
+static Soak_Record_t *g_soak_records;
+static size_t g_soak_count, g_soak_cap;
+static uint64_t g_soak_span;               // 第一条到最后一条的时间
+
+static uint64_t g_soak_stamp[2][65536];    // 各缓冲区按条目位置记录的写入时间
+static uint64_t g_soak_arena[SOAK_ARENA_MAX / 8];
+static RP_Log_t g_soak_log;
+static RP_LogSink_t g_soak_sink;
+#if RP_LOG_USE_COMPRESS
+static RP_LogCompress_t g_soak_lz;
+#endif
+static Soak_Run_t *g_soak_run;             // 当前运行（发送、唤醒回调中使用）
+
+// 命令行选项
+static uint32_t g_opt_stall_ms = 20;       // 每次同步 TF 卡期间停止写卡的时间
+static uint32_t g_opt_card_bps = 200000;   // 模块写 TF 卡的速度（字节/秒）
+static uint32_t g_opt_work_us = 1000;      // 日志线程的等待超时（osDelay / osThreadFlagsWait）
+static int g_opt_notify = 0;               // notify 唤醒日志线程
+static int g_opt_blocking = 0;             // 阻塞发送（HAL_UART_Transmit），否则 DMA
+static int g_opt_oldest = 0;               // RP_LOG_OVERFLOW_DISCARD_OLDEST
+static int g_opt_module_oldest = 0;        // 模块 RINGBUF_POLICY_DISCARD_OLDEST
+static double g_opt_speed = 1.0;           // 重放速度（2=两倍速）
+static uint32_t g_opt_loops = 1;           // 重复重放次数
+static int g_opt_csv = 0;
+
+/* Private functions ---------------------------------------------------------*/
+
+static void *Soak_Push(Soak_Vec_t *vec, size_t size)
+{
+    if (vec->len == vec->cap)
+    {
+        size_t cap = vec->cap ? vec->cap * 2 : 1024;
+        void *data = realloc(vec->data, cap * size);
+        if (data == NULL)
+        {
+            fprintf(stderr, "rp_log_soak: out of memory\n");
+            exit(1);
+        }
+        vec->data = data;
+        vec->cap = cap;
+    }
+    return (uint8_t *)vec->data + vec->len++ * size;
+}
+
+// 存入字符串池，返回偏移
+static uint32_t Soak_Intern(const char *s, size_t n)
+{
+    if (g_soak_pool_len + n + 1 > g_soak_pool_cap)
+    {
+        size_t cap = g_soak_pool_cap ? g_soak_pool_cap * 2 : 65536;
+        while (cap < g_soak_pool_len + n + 1)
+        {
+            cap *= 2;
+        }
+        g_soak_pool = (char *)realloc(g_soak_pool, cap);
+        if (g_soak_pool == NULL)
+        {
+            fprintf(stderr, "rp_log_soak: out of memory\n");
+            exit(1);
+        }
+        g_soak_pool_cap = cap;
+    }
+    uint32_t off = (uint32_t)g_soak_pool_len;
+    memcpy(g_soak_pool + off, s, n);
+    g_soak_pool[off + n] = '\0';
+    g_soak_pool_len += n + 1;
+    return off;
+}
+
+// 文件名只存一份（二进制帧模式下记录的是文件名地址，写入后不能变）
+static uint32_t Soak_File(const char *s, size_t n)
+{
+    static uint32_t files[256];
+    static size_t count;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strlen(g_soak_pool + files[i]) == n && memcmp(g_soak_pool + files[i], s, n) == 0)
+        {
+            return files[i];
+        }
+    }
+    uint32_t off = Soak_Intern(s, n);
+    if (count < sizeof(files) / sizeof(files[0]))
+    {
+        files[count++] = off;
+    }
+    return off;
+}
+
+// 读入录下的日志：每行取等级、文件、行号、正文和主控时间戳（没有时用模块时间，再没有时沿用上一行）
+// 二进制帧需 -e 指定 ELF 还原正文；变量采样行按普通日志重放
+static int Soak_Load(const char *path, const RP_LogHostElf_t *elf, uint32_t dwt_hz)
+{
+    RP_LogHostMap_t map;
+    if (RP_LogHost_MapFile(&map, path) != 0)
+    {
+        fprintf(stderr, "rp_log_soak: cannot open %s\n", path);
+        return -1;
+    }
+
+    RP_LogHostBuf_t inflated;
+    RP_LogHostInflate_t inflate = {0};
+    int lz = RP_LogHost_Inflate(map.data, map.size, &inflated, &inflate);
+    if (lz < 0)
+    {
+        fprintf(stderr, "rp_log_soak: out of memory\n");
+        RP_LogHost_UnmapFile(&map);
+        return -1;
+    }
+    const uint8_t *data = lz ? (const uint8_t *)inflated.data : map.data;
+    size_t size = lz ? inflated.len : map.size;
+
+    static uint8_t scratch[RP_LOG_HOST_FRAME_MAX];
+    static char text[RP_LOG_HOST_LINE_MAX];
+    int has_time = 0;
+    uint64_t last_tick = 0, last_time = 0, first = 0;
+    int64_t anchor = 0;
+    int anchored = 0;
+
+    for (size_t pos = 0; pos < size;)
+    {
+        const uint8_t *p = data + pos;
+        const uint8_t *nl = (const uint8_t *)memchr(p, '\n', size - pos);
+        size_t n = nl ? (size_t)(nl - p) : size - pos;
+        RP_LogHostLine_t info;
+
+        pos += n + (nl ? 1 : 0);
+        if (n > 0 && p[n - 1] == '\r')
+        {
+            n--;
+        }
+        if (RP_LogHost_ParseLine(p, n, elf, dwt_hz, &info) < 0)
+        {
+            continue;
+        }
+
+        // 正文：二进制帧先还原为文本行
+        const char *line = (const char *)p + info.prefix_len;
+        size_t len = n - info.prefix_len;
+        if (info.is_frame)
+        {
+            RP_LogHostFrame_t frame;
+            if (RP_LogHost_FrameDecode(p + info.prefix_len, len, scratch, &frame) != RP_LOG_HOST_FRAME_OK)
+            {
+                continue;
+            }
+            int m = RP_LogHost_FormatFrame(text, sizeof(text), elf, &frame, dwt_hz);
+            if (m <= 0)
+            {
+                continue;
+            }
+            line = text;
+            len = (size_t)m;
+        }
+        const char *body = NULL;
+        for (size_t i = 0; i + 2 < len; i++)
+        {
+            if (line[i] == ']' && line[i + 1] == ':' && line[i + 2] == ' ')
+            {
+                body = line + i + 3;
+                break;
+            }
+        }
+        if (body == NULL)
+        {
+            continue;
+        }
+        size_t body_len = len - (size_t)(body - line);
+        if (body_len > SOAK_TEXT_MAX)
+        {
+            body_len = SOAK_TEXT_MAX;
+        }
+
+        // 时间：主控复位（时间戳回退）后接着上一行继续
+        uint64_t time = last_time;
+        if (info.has_tick)
+        {
+            if (!anchored || info.tick_us < last_tick)
+            {
+                anchor = (int64_t)last_time - (int64_t)info.tick_us;
+                anchored = 1;
+            }
+            last_tick = info.tick_us;
+            time = (uint64_t)(anchor + (int64_t)info.tick_us);
+        }
+        else if (info.has_clock && !anchored)
+        {
+            time = (uint64_t)info.sec_of_day * 1000000;
+        }
+        if (!has_time)
+        {
+            has_time = 1;
+            first = time;
+            last_time = time;
+            if (anchored)
+            {
+                anchor -= (int64_t)first;
+                time = last_time = 0;
+                first = 0;
+            }
+        }
+        if (time < last_time)
+        {
+            time = last_time; // 不同时间源混用时保持单调
+        }
+        last_time = time;
+
+        if (g_soak_count == g_soak_cap)
+        {
+            g_soak_cap = g_soak_cap ? g_soak_cap * 2 : 4096;
+            g_soak_records = (Soak_Record_t *)realloc(g_soak_records, g_soak_cap * sizeof(Soak_Record_t));
+            if (g_soak_records == NULL)
+            {
+                fprintf(stderr, "rp_log_soak: out of memory\n");
+                exit(1);
+            }
+        }
+        Soak_Record_t *rec = &g_soak_records[g_soak_count++];
+        rec->time = time - first;
+        rec->text = Soak_Intern(body, body_len);
+        rec->file = Soak_File((info.file != NULL) ? info.file : "?", (info.file != NULL) ? info.file_len : 1);
+        rec->line = info.line;
+        rec->level = (uint8_t)info.level;
+    }
+
+    if (lz)
+    {
+        RP_LogHost_BufFree(&inflated);
+    }
+    RP_LogHost_UnmapFile(&map);
+    if (g_soak_count != 0)
+    {
+        g_soak_span = g_soak_records[g_soak_count - 1].time;
+    }
+    return 0;
+}
+
+// 逗号分隔的取值列表
+static int Soak_ParseList(const char *s, uint32_t *values)
+{
+    int count = 0;
+    while (*s != '\0' && count < SOAK_SWEEP_MAX)
+    {
+        char *end;
+        values[count++] = (uint32_t)strtoul(s, &end, 0);
+        if (*end != ',')
+        {
+            break;
+        }
+        s = end + 1;
+    }
+    return count;
+}
+
+// 模块写卡推进到时间 t：写卡速度恒定，每个同步间隔开头停顿 g_opt_stall_ms
+// 每块最后一个字节写入 TF 卡时计入块中各条日志的端到端延迟
+static void Soak_CardDrain(Soak_Run_t *run, double t)
+{
+    double rate = (double)g_opt_card_bps / 1e6; // 字节/微秒
+    double interval = (double)run->param->sync_ms * 1000.0;
+    double stall = (double)g_opt_stall_ms * 1000.0;
+
+    for (;;)
+    {
+        // 最后一个字节已写入 TF 卡的块
+        Soak_Chunk_t *chunks = (Soak_Chunk_t *)run->chunks.data;
+        while (run->chunk_head < run->chunks.len && chunks[run->chunk_head].end <= run->card_pos)
+        {
+            Soak_Chunk_t *c = &chunks[run->chunk_head++];
+            double done = run->card_time - (run->card_pos - c->end) / rate;
+            const uint64_t *times = (const uint64_t *)run->delivered.data;
+            for (uint32_t i = 0; i < c->count; i++)
+            {
+                *(uint32_t *)Soak_Push(&run->card_lat, sizeof(uint32_t)) = (uint32_t)(done - (double)times[c->first + i]);
+            }
+        }
+        if (run->card_time >= t)
+        {
+            break;
+        }
+        if (run->card_pos >= run->received)
+        {
+            run->card_time = t; // 没有待写入的数据
+            break;
+        }
+
+        // 每个同步间隔开头的停顿期间不写卡
+        double seg_end = t;
+        if (interval > 0)
+        {
+            double start = (double)(uint64_t)(run->card_time / interval) * interval;
+            if (run->card_time < start + stall)
+            {
+                run->card_time = (start + stall < t) ? start + stall : t;
+                continue;
+            }
+            if (start + interval < seg_end)
+            {
+                seg_end = start + interval;
+            }
+        }
+
+        double target = run->card_pos + (seg_end - run->card_time) * rate;
+        if (target > run->received)
+        {
+            target = run->received;
+        }
+        run->card_time += (target - run->card_pos) / rate;
+        run->card_pos = target;
+    }
+}
+
+// 一次发送到达模块：接收缓冲区放不下时按模块的溢出策略丢弃，丢掉的块中的日志不计延迟
+static void Soak_ModuleReceive(Soak_Run_t *run, uint32_t length, uint32_t first, uint32_t count)
+{
+    double fill = run->received - run->card_pos;
+    double space = (double)run->param->ringbuf - fill;
+    Soak_Chunk_t *chunks = (Soak_Chunk_t *)run->chunks.data;
+
+    if (length > space)
+    {
+        if (!g_opt_module_oldest)
+        {
+            // DISCARD_NEWEST：只收下放得下的部分，本块不完整
+            double accept = (space > 0) ? space : 0;
+            run->received += accept;
+            run->module_lost += count;
+            run->module_lost_bytes += (uint64_t)(length - accept);
+            return;
+        }
+
+        // DISCARD_OLDEST：丢掉最早的数据，被丢到的块不完整
+        double drop = length - space;
+        if (drop > fill)
+        {
+            drop = fill;
+        }
+        run->card_pos += drop;
+        run->module_lost_bytes += (uint64_t)drop;
+        while (run->chunk_head < run->chunks.len)
+        {
+            double start = (run->chunk_head > 0) ? chunks[run->chunk_head - 1].end : 0.0;
+            if (start >= run->card_pos)
+            {
+                break;
+            }
+            run->module_lost += chunks[run->chunk_head++].count; // 全部或开头一部分被丢掉的块
+        }
+    }
+
+    run->received += length;
+    Soak_Chunk_t *c = (Soak_Chunk_t *)Soak_Push(&run->chunks, sizeof(Soak_Chunk_t));
+    c->end = run->received;
+    c->first = first;
+    c->count = count;
+    if (run->received - run->card_pos > run->module_peak)
+    {
+        run->module_peak = run->received - run->card_pos;
+    }
+}
+
+// 读指针越过的条目计入本次发送（零拷贝发送在完成时前进，延迟格式化记录在发送前前进）
+static void Soak_Deliver(Soak_Run_t *run, uint32_t length)
+{
+    uint32_t first = (uint32_t)run->delivered.len;
+
+    for (int ring = 0; ring < 2; ring++)
+    {
+#if RP_LOG_USE_LANE
+        RP_LogRingBuffer_t *rb = ring ? g_soak_log.lane : g_soak_log.ring_buffer;
+#else
+        RP_LogRingBuffer_t *rb = g_soak_log.ring_buffer;
+        if (ring)
+        {
+            break;
+        }
+#endif
+        uint16_t end = RB_ENTRY_POS(rb->cursor[g_soak_sink.id]);
+        for (; run->acc[ring] != end; run->acc[ring]++)
+        {
+            uint64_t t = g_soak_stamp[ring][run->acc[ring]];
+            if (t == SOAK_DISCARDED)
+            {
+                continue;
+            }
+            *(uint64_t *)Soak_Push(&run->delivered, sizeof(uint64_t)) = t;
+            *(uint32_t *)Soak_Push(&run->uart_lat, sizeof(uint32_t)) = (uint32_t)(run->now - t);
+        }
+    }
+
+    Soak_CardDrain(run, (double)run->now);
+    Soak_ModuleReceive(run, length, first, (uint32_t)(run->delivered.len - first));
+}
+
+// 串口输出：按波特率计算发送完成时间，完成事件中调用 sink_cplt()
+static int Soak_Transmit(RP_LogSink_t *sink, const uint8_t *data, uint16_t length)
+{
+    (void)sink;
+    (void)data;
+    g_soak_run->tx_done = g_soak_run->now + (uint64_t)length * 10 * 1000000 / g_soak_run->param->baud;
+    g_soak_run->tx_bytes += length;
+    g_soak_run->tx_length = length;
+    return 0;
+}
+
+// 唤醒日志线程
+static void Soak_Notify(RP_Log_t *log)
+{
+    (void)log;
+    g_soak_run->notified = 1;
+}
+
+// 记录缓冲区最高占用
+static void Soak_Peak(Soak_Run_t *run)
+{
+    RP_LogRingBuffer_t *rb = g_soak_log.ring_buffer;
+    uint32_t bytes = (uint16_t)(RB_DATA_POS(rb->head) - RB_DATA_POS(rb->tail));
+    uint32_t entries = RB_GetCount(rb);
+#if RP_LOG_USE_LANE
+    bytes += (uint16_t)(RB_DATA_POS(g_soak_log.lane->head) - RB_DATA_POS(g_soak_log.lane->tail));
+    entries += RB_GetCount(g_soak_log.lane);
+#endif
+    if (bytes > run->peak_bytes)
+    {
+        run->peak_bytes = bytes;
+    }
+    if (entries > run->peak_entries)
+    {
+        run->peak_entries = entries;
+    }
+}
+
+// 重放一条日志，成功时按条目位置记下写入时间
+static void Soak_Write(Soak_Run_t *run, const Soak_Record_t *rec)
+{
+    RP_LogRingBuffer_t *rb = g_soak_log.ring_buffer;
+    uint16_t head = RB_ENTRY_POS(rb->head);
+#if RP_LOG_USE_LANE
+    uint16_t lane_head = RB_ENTRY_POS(g_soak_log.lane->head);
+#endif
+
+    g_bench_tick = (uint32_t)(run->now / 1000);
+    if (g_soak_log.write(&g_soak_log, (RP_LogLevel_t)rec->level, g_soak_pool + rec->file, rec->line, "%s",
+                         g_soak_pool + rec->text) != 0)
+    {
+        run->dropped++;
+        return;
+    }
+    run->written++;
+
+#if RP_LOG_USE_LANE
+    if (RB_ENTRY_POS(g_soak_log.lane->head) != lane_head)
+    {
+        g_soak_stamp[1][lane_head] = run->now;
+    }
+    else
+#endif
+    {
+        g_soak_stamp[0][head] = run->now;
+    }
+    Soak_Peak(run);
+}
+
+// 运行一次日志线程：读指针落在 tail 之前说明其后的条目已被 DISCARD_OLDEST 丢掉（work() 将读指针移到 tail），
+// 先标记出来，不计入发送
+static void Soak_Work(Soak_Run_t *run)
+{
+    RP_LogRingBuffer_t *rb = g_soak_log.ring_buffer;
+    uint16_t before = RB_ENTRY_POS(rb->cursor[g_soak_sink.id]);
+    uint16_t tail = RB_ENTRY_POS(rb->tail);
+
+    g_bench_tick = (uint32_t)(run->now / 1000);
+    if ((uint16_t)(before - tail) > (uint16_t)(RB_ENTRY_POS(rb->head) - tail))
+    {
+        for (; before != tail; before++)
+        {
+            g_soak_stamp[0][before] = SOAK_DISCARDED;
+            run->discarded++;
+        }
+    }
+
+    uint64_t busy = run->tx_done;
+    g_soak_log.work(&g_soak_log);
+    if (g_opt_blocking && run->tx_done != busy)
+    {
+        run->next_work = run->tx_done; // 阻塞发送期间日志线程不再运行
+    }
+}
+
+// 按一组参数运行一次仿真
+static void Soak_Run(Soak_Run_t *run)
+{
+    RP_LogConfigParam_t cfg = g_rp_log_config_default;
+    cfg.output_range = RP_LOG_OUTPUT_ALL;
+    cfg.stats_period_ms = 0; // 统计行不在录下的日志中
+    cfg.overflow_policy = g_opt_oldest ? RP_LOG_OVERFLOW_DISCARD_OLDEST : RP_LOG_OVERFLOW_DISCARD_NEWEST;
+
+    memset(&g_soak_log, 0, sizeof(g_soak_log));
+    memset(g_soak_arena, 0, sizeof(g_soak_arena));
+    g_soak_log.notify = Soak_Notify;
+    if (RP_Log_Init(&g_soak_log, g_soak_arena, run->param->arena, &cfg) != 0)
+    {
+        fprintf(stderr, "rp_log_soak: arena %u too small\n", (unsigned)run->param->arena);
+        return;
+    }
+    g_soak_log.recover(&g_soak_log);
+
+    memset(&g_soak_sink, 0, sizeof(g_soak_sink));
+    g_soak_sink.transmit = Soak_Transmit;
+    g_soak_sink.output_range = RP_LOG_OUTPUT_ALL;
+    g_soak_sink.batch_max = (uint16_t)run->param->batch;
+    g_soak_sink.async = !g_opt_blocking;
+#if RP_LOG_USE_COMPRESS
+    memset(&g_soak_lz, 0, sizeof(g_soak_lz));
+    g_soak_sink.compress = &g_soak_lz;
+#endif
+    g_soak_run = run;
+    g_soak_log.add_sink(&g_soak_log, &g_soak_sink);
+
+    run->tx_done = SOAK_NEVER;
+    uint64_t loop_span = (uint64_t)((double)g_soak_span / g_opt_speed) + 1000;
+    uint64_t total = (uint64_t)g_soak_count * g_opt_loops;
+    uint64_t index = 0;
+    uint64_t last = 0;
+
+    for (;;)
+    {
+        uint64_t t_write = SOAK_NEVER;
+        if (index < total)
+        {
+            const Soak_Record_t *rec = &g_soak_records[index % g_soak_count];
+            t_write = (index / g_soak_count) * loop_span + (uint64_t)((double)rec->time / g_opt_speed);
+        }
+        uint64_t t_work = (g_opt_notify && run->notified && !(g_opt_blocking && run->tx_done != SOAK_NEVER))
+                              ? run->now
+                              : run->next_work;
+
+        if (t_write == SOAK_NEVER && run->tx_done == SOAK_NEVER && !RP_Log_IsPending(&g_soak_log) &&
+            g_soak_sink.tx_pending == 0)
+        {
+            break;
+        }
+        if (t_write == SOAK_NEVER && run->now > last + SOAK_TAIL_US)
+        {
+            break;
+        }
+
+        // 同一时刻：发送完成先于日志线程，日志线程先于写入
+        if (run->tx_done <= t_work && run->tx_done <= t_write)
+        {
+            run->now = run->tx_done;
+            run->tx_done = SOAK_NEVER;
+            uint32_t length = run->tx_length;
+            if (!g_opt_blocking)
+            {
+                g_soak_log.sink_cplt(&g_soak_log, &g_soak_sink);
+            }
+            Soak_Deliver(run, length);
+        }
+        else if (t_work <= t_write)
+        {
+            run->now = (t_work > run->now) ? t_work : run->now;
+            run->notified = 0;
+            run->next_work = run->now + g_opt_work_us;
+            Soak_Work(run);
+        }
+        else
+        {
+            run->now = (t_write > run->now) ? t_write : run->now;
+            Soak_Write(run, &g_soak_records[index % g_soak_count]);
+            last = run->now;
+            index++;
+        }
+    }
+
+    Soak_CardDrain(run, 1e18);
+}
+
+static int Soak_CmpU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// 分位数（毫秒），vec 须已排序
+static double Soak_Pct(const Soak_Vec_t *vec, double pct)
+{
+    if (vec->len == 0)
+    {
+        return 0.0;
+    }
+    size_t i = (size_t)(pct / 100.0 * (double)(vec->len - 1) + 0.5);
+    return ((const uint32_t *)vec->data)[i] / 1000.0;
+}
+
+static void Soak_Report(Soak_Run_t *run)
+{
+    const Soak_Param_t *p = run->param;
+    uint64_t total = run->written + run->dropped;
+    uint64_t lost = run->dropped + run->discarded + run->module_lost;
+    double lost_pct = total ? 100.0 * (double)lost / (double)total : 0.0;
+
+    qsort(run->uart_lat.data, run->uart_lat.len, sizeof(uint32_t), Soak_CmpU32);
+    qsort(run->card_lat.data, run->card_lat.len, sizeof(uint32_t), Soak_CmpU32);
+
+    if (g_opt_csv)
+    {
+        printf("%u,%u,%u,%u,%u,%llu,%llu,%llu,%llu,%.3f,%u,%u,%.0f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+               p->arena, p->batch, p->baud, p->ringbuf, p->sync_ms, (unsigned long long)total,
+               (unsigned long long)run->dropped, (unsigned long long)run->discarded,
+               (unsigned long long)run->module_lost, lost_pct, run->peak_bytes, run->peak_entries, run->module_peak,
+               Soak_Pct(&run->uart_lat, 50), Soak_Pct(&run->uart_lat, 99), Soak_Pct(&run->uart_lat, 100),
+               Soak_Pct(&run->card_lat, 50), Soak_Pct(&run->card_lat, 99), Soak_Pct(&run->card_lat, 99.9),
+               Soak_Pct(&run->card_lat, 100));
+        return;
+    }
+    printf("%6u %5u %7u %6u %5u | %8llu %6llu %6llu %6llu %6.2f%% | %5u %4u %6.0f | %7.1f %7.1f %7.1f | %7.1f %7.1f "
+           "%7.1f %7.1f\n",
+           p->arena, p->batch, p->baud, p->ringbuf, p->sync_ms, (unsigned long long)total,
+           (unsigned long long)run->dropped, (unsigned long long)run->discarded, (unsigned long long)run->module_lost,
+           lost_pct, run->peak_bytes, run->peak_entries, run->module_peak, Soak_Pct(&run->uart_lat, 50),
+           Soak_Pct(&run->uart_lat, 99), Soak_Pct(&run->uart_lat, 100), Soak_Pct(&run->card_lat, 50),
+           Soak_Pct(&run->card_lat, 99), Soak_Pct(&run->card_lat, 99.9), Soak_Pct(&run->card_lat, 100));
+}
+
+static void Soak_Usage(void)
+{
+    fprintf(stderr,
+            "usage: rp_log_soak [options] match.LOG\n"
+            "  list options take comma separated values, every combination is simulated:\n"
+            "  -R  RP_Log_Init() arena bytes (default %u, max %u)\n"
+            "  -B  uart sink batch_max (default 512)\n"
+            "  -b  uart baud rate, 8N1 (default 115200)\n"
+            "  -m  TF_Log RINGBUF_SIZE (default 8192)\n"
+            "  -y  TF_Log SYNC_INTERVAL in ms, 0=never (default 500)\n"
+            "  other options:\n"
+            "  -k  card stall per sync in ms (default 20)\n"
+            "  -c  card write speed in bytes/s (default 200000)\n"
+            "  -p  log thread wait timeout in us (default 1000)\n"
+            "  -N  notify wakes the log thread     -S  blocking transmit instead of DMA\n"
+            "  -O  RP_LOG_OVERFLOW_DISCARD_OLDEST   -M  module RINGBUF_POLICY_DISCARD_OLDEST\n"
+            "  -x  replay speed factor (default 1)  -l  replay the log N times (default 1)\n"
+            "  -e  app.elf for binary recordings    -f  dwt_hz\n"
+            "  -csv  machine readable output\n",
+            (unsigned)sizeof(RP_LogArena_t), (unsigned)SOAK_ARENA_MAX);
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(int argc, char **argv)
+{
+    uint32_t arenas[SOAK_SWEEP_MAX] = {(uint32_t)sizeof(RP_LogArena_t)};
+    uint32_t batches[SOAK_SWEEP_MAX] = {512};
+    uint32_t bauds[SOAK_SWEEP_MAX] = {115200};
+    uint32_t ringbufs[SOAK_SWEEP_MAX] = {8192};
+    uint32_t syncs[SOAK_SWEEP_MAX] = {500};
+    int n_arena = 1, n_batch = 1, n_baud = 1, n_ringbuf = 1, n_sync = 1;
+    const char *elf_path = NULL;
+    uint32_t dwt_hz = 0;
+    int first = argc;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *opt = argv[i];
+        if (opt[0] != '-')
+        {
+            first = i;
+            break;
+        }
+        if (strcmp(opt, "-N") == 0)
+            g_opt_notify = 1;
+        else if (strcmp(opt, "-S") == 0)
+            g_opt_blocking = 1;
+        else if (strcmp(opt, "-O") == 0)
+            g_opt_oldest = 1;
+        else if (strcmp(opt, "-M") == 0)
+            g_opt_module_oldest = 1;
+        else if (strcmp(opt, "-csv") == 0)
+            g_opt_csv = 1;
+        else if (i + 1 >= argc)
+        {
+            Soak_Usage();
+            return 2;
+        }
+        else
+        {
+            const char *v = argv[++i];
+            if (strcmp(opt, "-R") == 0)
+                n_arena = Soak_ParseList(v, arenas);
+            else if (strcmp(opt, "-B") == 0)
+                n_batch = Soak_ParseList(v, batches);
+            else if (strcmp(opt, "-b") == 0)
+                n_baud = Soak_ParseList(v, bauds);
+            else if (strcmp(opt, "-m") == 0)
+                n_ringbuf = Soak_ParseList(v, ringbufs);
+            else if (strcmp(opt, "-y") == 0)
+                n_sync = Soak_ParseList(v, syncs);
+            else if (strcmp(opt, "-k") == 0)
+                g_opt_stall_ms = (uint32_t)strtoul(v, NULL, 0);
+            else if (strcmp(opt, "-c") == 0)
+                g_opt_card_bps = (uint32_t)strtoul(v, NULL, 0);
+            else if (strcmp(opt, "-p") == 0)
+                g_opt_work_us = (uint32_t)strtoul(v, NULL, 0);
+            else if (strcmp(opt, "-x") == 0)
+                g_opt_speed = atof(v);
+            else if (strcmp(opt, "-l") == 0)
+                g_opt_loops = (uint32_t)strtoul(v, NULL, 0);
+            else if (strcmp(opt, "-e") == 0)
+                elf_path = v;
+            else if (strcmp(opt, "-f") == 0)
+                dwt_hz = (uint32_t)strtoul(v, NULL, 0);
+            else
+            {
+                Soak_Usage();
+                return 2;
+            }
+        }
+    }
+    if (first >= argc || g_opt_speed <= 0 || g_opt_loops == 0 || g_opt_card_bps == 0 || g_opt_work_us == 0)
+    {
+        Soak_Usage();
+        return 2;
+    }
+    for (int i = 0; i < n_arena; i++)
+    {
+        if (arenas[i] > SOAK_ARENA_MAX)
+        {
+            Soak_Usage();
+            return 2;
+        }
+    }
+    for (int i = 0; i < n_baud; i++)
+    {
+        if (bauds[i] == 0)
+        {
+            Soak_Usage();
+            return 2;
+        }
+    }
+
+    RP_LogHostElf_t elf;
+    const RP_LogHostElf_t *elf_ptr = NULL;
+    if (elf_path != NULL)
+    {
+        if (RP_LogHost_ElfOpen(&elf, elf_path) != 0)
+        {
+            fprintf(stderr, "rp_log_soak: cannot load ELF %s\n", elf_path);
+            return 1;
+        }
+        elf_ptr = &elf;
+    }
+    for (int i = first; i < argc; i++)
+    {
+        if (Soak_Load(argv[i], elf_ptr, dwt_hz) != 0)
+        {
+            return 1;
+        }
+    }
+    if (g_soak_count == 0)
+    {
+        fprintf(stderr, "rp_log_soak: no RP_Log lines found\n");
+        return 1;
+    }
+
+    if (g_opt_csv)
+    {
+        printf("arena,batch,baud,ringbuf,sync_ms,messages,dropped,discarded,module_lost,lost_pct,peak_bytes,"
+               "peak_entries,module_peak,uart_p50_ms,uart_p99_ms,uart_max_ms,card_p50_ms,card_p99_ms,card_p999_ms,"
+               "card_max_ms\n");
+    }
+    else
+    {
+        printf("RP_Log soak: %llu lines over %.1f s x%u at %.2fx, DEFERRED=%d BINARY=%d COMPRESS=%d LANE=%d ENTRY=%d, "
+               "%s%s, card %u B/s stall %u ms\n",
+               (unsigned long long)g_soak_count, (double)g_soak_span / 1e6, (unsigned)g_opt_loops, g_opt_speed,
+               RP_LOG_USE_DEFERRED, RP_LOG_USE_BINARY, RP_LOG_USE_COMPRESS, RP_LOG_USE_LANE, RP_LOG_ENTRY_MAX_SIZE,
+               g_opt_blocking ? "blocking" : "DMA", g_opt_notify ? " + notify" : "", (unsigned)g_opt_card_bps,
+               (unsigned)g_opt_stall_ms);
+        printf("%6s %5s %7s %6s %5s | %8s %6s %6s %6s %7s | %5s %4s %6s | %7s %7s %7s | %7s %7s %7s %7s\n", "arena",
+               "batch", "baud", "ringbf", "sync", "messages", "drop", "disc", "module", "lost", "peakB", "peakN",
+               "modB", "uart50", "uart99", "uartmx", "card50", "card99", "card999", "cardmx");
+    }
+
+    for (int a = 0; a < n_arena; a++)
+        for (int b = 0; b < n_batch; b++)
+            for (int u = 0; u < n_baud; u++)
+                for (int m = 0; m < n_ringbuf; m++)
+                    for (int y = 0; y < n_sync; y++)
+                    {
+                        Soak_Param_t param = {arenas[a], batches[b], bauds[u], ringbufs[m], syncs[y]};
+                        Soak_Run_t run;
+                        memset(&run, 0, sizeof(run));
+                        run.param = &param;
+                        Soak_Run(&run);
+                        Soak_Report(&run);
+                        free(run.delivered.data);
+                        free(run.uart_lat.data);
+                        free(run.card_lat.data);
+                        free(run.chunks.data);
+                    }
+
+    if (elf_ptr != NULL)
+    {
+        RP_LogHost_ElfClose(&elf);
+    }
+    return 0;
+}
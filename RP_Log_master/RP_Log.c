@@ -7,7 +7,15 @@
  * Copyright (c) 2026 SZU RobotPilots.
  *
  * 使用环形缓冲区实现无阻塞日志写入，避免串口正忙导致的日志丢失
+ * 支持多路输出（串口、RTT 和用户注册的输出共用一个环形缓冲区，各自读取）
  * 支持RTT输出（需设置 RP_LOG_USE_RTT 为 1）
+ * 支持延迟格式化（需设置 RP_LOG_USE_DEFERRED 为 1）
+ * 支持串口输出流式压缩（需设置 RP_LOG_USE_COMPRESS 为 1）
+ * 支持复位后找回缓冲区中的日志（需设置 RP_LOG_USE_NOINIT 为 1）和异常中同步发出
+ * 支持变量采样（需设置 RP_LOG_USE_TELEMETRY 为 1，与日志共用缓冲区和输出）
+ * 支持 FATAL/ERROR/WARN 使用单独的高优先级通道（需设置 RP_LOG_USE_LANE 为 1），不被低等级日志挤占
+ * 支持注册任务写入各自的暂存区（需设置 RP_LOG_USE_STAGE 为 1），work() 按时间戳并入，丢弃按任务报告
+ * 支持按模块设置输出等级（需设置 RP_LOG_USE_FILTER 为 1），宏中先判断，被过滤时不调用 write()
  * 串口发送需用户实现 RP_Log_Transmit 函数
  *
  ******************************************************************************
@@ -15,22 +23,417 @@
 
 #include "RP_Log.h"
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 // #include "usart.h"
 // #include "stm32f4xx_hal.h"
 
 /* Private define ------------------------------------------------------------*/
 
+#ifndef RP_LOG_USE_RTT
 #define RP_LOG_USE_RTT 0 // RTT输出配置（启用请将此值改为 1）
+#endif
 
 #if RP_LOG_USE_RTT
 #include "SEGGER_RTT.h"
 #endif
 
+// 零拷贝发送：RP_LOG_USE_TX_CPLT 为 0 时 RP_Log_Transmit 返回即释放 data 所在的缓冲区，DMA 发送时必须为 1
+// 工程启用了 HAL 的 UART 和 DMA 模块时要求在编译选项（或包含 RP_Log.h 之前）明确设置，阻塞发送设为 0 即可
+#if defined(RP_LOG_TX_CPLT_DEFAULT) && defined(HAL_UART_MODULE_ENABLED) && defined(HAL_DMA_MODULE_ENABLED)
+#warning "RP_LOG_USE_TX_CPLT is not set: define it as 1 if RP_Log_Transmit uses DMA (and call tx_cplt() on completion), or as 0 for blocking transmit"
+#endif
+
+#if (RP_LOG_RING_BUFFER_SIZE & (RP_LOG_RING_BUFFER_SIZE - 1)) != 0 || RP_LOG_RING_BUFFER_SIZE > 32768
+#error "RP_LOG_RING_BUFFER_SIZE must be a power of 2 and no more than 32768"
+#endif
+#if (RP_LOG_RING_BUFFER_CNT & (RP_LOG_RING_BUFFER_CNT - 1)) != 0 || RP_LOG_RING_BUFFER_CNT > 16384
+#error "RP_LOG_RING_BUFFER_CNT must be a power of 2 and no more than 16384"
+#endif
+#if RP_LOG_ENTRY_MAX_SIZE > RP_LOG_RING_BUFFER_SIZE || RP_LOG_ENTRY_MAX_SIZE > 2047
+#error "RP_LOG_ENTRY_MAX_SIZE must not exceed RP_LOG_RING_BUFFER_SIZE or 2047"
+#endif
+#if RP_LOG_USE_LANE
+#if (RP_LOG_LANE_SIZE & (RP_LOG_LANE_SIZE - 1)) != 0 || RP_LOG_LANE_SIZE < RP_LOG_ENTRY_MAX_SIZE || RP_LOG_LANE_SIZE > 32768
+#error "RP_LOG_LANE_SIZE must be a power of 2, no less than RP_LOG_ENTRY_MAX_SIZE and no more than 32768"
+#endif
+#if (RP_LOG_LANE_CNT & (RP_LOG_LANE_CNT - 1)) != 0 || RP_LOG_LANE_CNT < 2 || RP_LOG_LANE_CNT > 16384
+#error "RP_LOG_LANE_CNT must be a power of 2 between 2 and 16384"
+#endif
+#endif
+#if RP_LOG_USE_STAGE
+#if (RP_LOG_STAGE_SIZE & (RP_LOG_STAGE_SIZE - 1)) != 0 || RP_LOG_STAGE_SIZE < RP_LOG_ENTRY_MAX_SIZE || RP_LOG_STAGE_SIZE > 32768
+#error "RP_LOG_STAGE_SIZE must be a power of 2, no less than RP_LOG_ENTRY_MAX_SIZE and no more than 32768"
+#endif
+#if (RP_LOG_STAGE_CNT & (RP_LOG_STAGE_CNT - 1)) != 0 || RP_LOG_STAGE_CNT < 2 || RP_LOG_STAGE_CNT > 16384
+#error "RP_LOG_STAGE_CNT must be a power of 2 between 2 and 16384"
+#endif
+#if RP_LOG_STAGE_MAX < 1 || RP_LOG_STAGE_MAX > 32
+#error "RP_LOG_STAGE_MAX must be between 1 and 32"
+#endif
+#endif
+
+#if RP_LOG_USE_FILTER
+#if RP_LOG_MODULE_MAX < 1 || RP_LOG_MODULE_MAX >= RP_LOG_MODULE_ALL
+#error "RP_LOG_MODULE_MAX must be between 1 and 254"
+#endif
+#endif
+#if RP_LOG_HEX_LINE_BYTES < 1 || RP_LOG_HEX_LINE_BYTES > 64
+#error "RP_LOG_HEX_LINE_BYTES must be between 1 and 64"
+#endif
+
+#if RP_LOG_USE_DEFERRED && RP_LOG_TX_BUFFER_SIZE < RP_LOG_ENTRY_MAX_SIZE
+#error "RP_LOG_TX_BUFFER_SIZE must not be less than RP_LOG_ENTRY_MAX_SIZE"
+#endif
+#if RP_LOG_TX_BUFFER_SIZE < 64
+#error "RP_LOG_TX_BUFFER_SIZE must be at least 64"
+#endif
+
+#if RP_LOG_USE_BINARY
+#if !RP_LOG_USE_DEFERRED
+#error "RP_LOG_USE_BINARY requires RP_LOG_USE_DEFERRED"
+#endif
+// 记录帧负载最大长度：等级 + 行号 + 时间戳 + 两个地址 + 参数区
+#define RP_LOG_FRAME_PAYLOAD_MAX (1 + 2 + 8 + 4 + 4 + RP_LOG_DEFER_ARG_MAX)
+// 单帧最大长度（全部转义时）：同步字节 + (类型 + 序号 + 负载 + CRC) * 2 + "\r\n"
+#define RP_LOG_TX_UNIT_SIZE (1 + (3 + RP_LOG_FRAME_PAYLOAD_MAX + 2) * 2 + 2)
+#if RP_LOG_TX_BUFFER_SIZE < RP_LOG_TX_UNIT_SIZE
+#error "RP_LOG_TX_BUFFER_SIZE is too small for one binary frame"
+#endif
+#else
+#define RP_LOG_TX_UNIT_SIZE RP_LOG_ENTRY_MAX_SIZE // tx_buffer 中单条日志最大长度
+#endif
+
+// 是否需要在本机生成文本行（二进制帧模式下只有 text 为 1 的输出需要，如 RTT）
+// 二进制帧模式下注册其他文本输出时需在编译选项中设为 1
+#ifndef RP_LOG_NEED_TEXT
+#define RP_LOG_NEED_TEXT (!RP_LOG_USE_BINARY || RP_LOG_USE_RTT)
+#endif
+
+// 是否需要封装帧（二进制帧、压缩帧）
+#define RP_LOG_NEED_FRAME (RP_LOG_USE_BINARY || RP_LOG_USE_COMPRESS)
+
+#if RP_LOG_USE_COMPRESS
+#if RP_LOG_COMPRESS_WINDOW_BITS < 8 || RP_LOG_COMPRESS_WINDOW_BITS > 12
+#error "RP_LOG_COMPRESS_WINDOW_BITS must be between 8 and 12"
+#endif
+#if RP_LOG_COMPRESS_HASH_BITS < 4 || RP_LOG_COMPRESS_HASH_BITS > 14
+#error "RP_LOG_COMPRESS_HASH_BITS must be between 4 and 14"
+#endif
+#if RP_LOG_COMPRESS_BLOCK_SIZE < 96
+#error "RP_LOG_TX_BUFFER_SIZE is too small for compression"
+#endif
+// 延迟格式化时一条日志整行进入同一块
+#if RP_LOG_USE_DEFERRED && (RP_LOG_COMPRESS_BLOCK_SIZE < RP_LOG_TX_UNIT_SIZE || \
+                            (RP_LOG_NEED_TEXT && RP_LOG_COMPRESS_BLOCK_SIZE < RP_LOG_ENTRY_MAX_SIZE))
+#error "RP_LOG_TX_BUFFER_SIZE is too small for one compressed entry"
+#endif
+#define RP_LOG_LZ_WINDOW (1U << RP_LOG_COMPRESS_WINDOW_BITS)                           // 最大匹配距离
+#define RP_LOG_LZ_MATCH_MAX (3U + (1U << (16 - RP_LOG_COMPRESS_WINDOW_BITS)) - 1U)     // 最大匹配长度
+#define RP_LOG_LZ_PAYLOAD_MAX (1 + RP_LOG_COMPRESS_BLOCK_SIZE + (RP_LOG_COMPRESS_BLOCK_SIZE + 7) / 8) // 压缩块最大长度
+#endif
+
+// 是否统计 write() 周期数、是否使用 DWT 周期计数器（时间戳或周期统计）
+#define RP_LOG_STATS_TIMED (RP_LOG_USE_STATS && RP_LOG_STATS_CYCLES)
+#define RP_LOG_NEED_DWT (RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT || RP_LOG_STATS_TIMED)
+
+// 是否有时间来源（限频、去重的时间间隔）
+#if RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT || defined(USE_HAL_DRIVER)
+#define RP_LOG_HAS_CLOCK 1
+#else
+#define RP_LOG_HAS_CLOCK 0
+#endif
+
+// 是否需要解析格式说明符（延迟格式化打包参数、内置格式化、去重计算参数摘要）
+#define RP_LOG_NEED_SPEC (RP_LOG_USE_DEFERRED || RP_LOG_USE_LITE_FORMAT || RP_LOG_USE_DEDUP)
+
+#if RP_LOG_NEED_DWT
+// DWT 周期计数器寄存器（可在编译选项中重定向到其他地址）
+#ifndef RP_LOG_DWT_CYCCNT
+#define RP_LOG_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004UL) // DWT->CYCCNT
+#define RP_LOG_DWT_CTRL (*(volatile uint32_t *)0xE0001000UL)   // DWT->CTRL
+#define RP_LOG_DWT_LAR (*(volatile uint32_t *)0xE0001FB0UL)    // DWT->LAR（Cortex-M7 需解锁）
+#define RP_LOG_DEMCR (*(volatile uint32_t *)0xE000EDFCUL)      // CoreDebug->DEMCR
+#endif
+extern uint32_t SystemCoreClock;
+#endif
+
+#if RP_LOG_USE_STAGE
+// 当前任务句柄（任务暂存区按此查找，可在编译选项中替换为其他 RTOS 的接口）
+#ifndef RP_LOG_TASK_SELF
+void *xTaskGetCurrentTaskHandle(void); // FreeRTOS（INCLUDE_xTaskGetCurrentTaskHandle 为 1）
+#define RP_LOG_TASK_SELF() xTaskGetCurrentTaskHandle()
+#endif
+// 是否在中断中：中断里的日志直接写主缓冲区，不记在被打断的任务名下
+#ifndef RP_LOG_IN_ISR
+#if defined(__CC_ARM) // ARMCC V5
+static __inline uint32_t RP_Log_Ipsr(void)
+{
+    register uint32_t ipsr __asm("ipsr");
+    return ipsr;
+}
+#define RP_LOG_IN_ISR() (RP_Log_Ipsr() != 0)
+#elif defined(__arm__) // GCC、ARMCLANG（AC6）
+static inline uint32_t RP_Log_Ipsr(void)
+{
+    uint32_t ipsr;
+    __asm volatile("mrs %0, ipsr" : "=r"(ipsr));
+    return ipsr;
+}
+#define RP_LOG_IN_ISR() (RP_Log_Ipsr() != 0)
+#else
+#define RP_LOG_IN_ISR() 0
+#endif
+#endif
+#endif
+
+// 格式说明符标志
+#define RP_LOG_FLAG_LEFT 0x01  // '-' 左对齐
+#define RP_LOG_FLAG_PLUS 0x02  // '+' 正数显示符号
+#define RP_LOG_FLAG_SPACE 0x04 // ' ' 正数前加空格
+#define RP_LOG_FLAG_ALT 0x08   // '#' 0x/0 前缀
+#define RP_LOG_FLAG_ZERO 0x10  // '0' 用 0 填充宽度
+
+// 模块自己写的提示行（丢弃提示、采样、统计、复位找回）的来源，固定不变，不随 RP_Log.c 的修改而变
+#define RP_LOG_SELF_FILE "RP_Log"
+#define RP_LOG_SELF_LINE 0
+
+#define RB_DATA_MASK(rb_) ((uint16_t)((rb_)->size - 1)) // 数据位置掩码
+#define RB_ENTRY_MASK(rb_) ((uint16_t)((rb_)->cnt - 1)) // 条目位置掩码
+#define RB_ALIGN 8                                      // RP_Log_Init() 中缓冲区头部的对齐字节数
+
+#if RP_LOG_USE_LANE
+// 高优先级通道占用的字节数：头部 | 条目描述 | 数据，补齐到 RB_ALIGN，主缓冲区紧随其后
+#define RB_LANE_BYTES                                                                                   \
+    ((uint32_t)(sizeof(RP_LogRingBuffer_t) + RP_LOG_LANE_CNT * sizeof(uint32_t) + RP_LOG_LANE_SIZE + \
+                RB_ALIGN - 1) &                                                                         \
+     ~(uint32_t)(RB_ALIGN - 1))
+// 输出当前读取的缓冲区
+#define RB_SINK_RING(log_, sink_) ((sink_)->lane ? (log_)->lane : (log_)->ring_buffer)
+#else
+#define RB_SINK_RING(log_, sink_) ((log_)->ring_buffer)
+#endif
+
+// 读写指针打包：条目指针(高16位) | 数据指针(低16位)
+#define RB_INDEX(data_, entry_) (((uint32_t)(uint16_t)(entry_) << 16) | (uint16_t)(data_))
+#define RB_DATA_POS(index_) ((uint16_t)(index_))
+#define RB_ENTRY_POS(index_) ((uint16_t)((index_) >> 16))
+
+// 条目描述：提交标记(高16位，由条目指针生成) | 等级(3位) | 类型(2位) | 长度(11位)
+// 提交标记与条目指针一一对应，上一圈残留的描述不会被误认为已提交
+// 等级放在描述中，各输出按等级跳过条目时不必读取数据
+#define RB_ENTRY_TAG(pos_) ((uint16_t)(((pos_) & 0x7FFF) | 0x8000))
+#define RB_ENTRY_MAKE(pos_, type_, level_, length_)                                 \
+    (((uint32_t)RB_ENTRY_TAG(pos_) << 16) | ((uint32_t)((level_) & 0x07) << 13) | \
+     ((uint32_t)((type_) & 0x03) << 11) | ((length_) & 0x07FF))
+#define RB_ENTRY_LENGTH(word_) ((uint16_t)((word_) & 0x07FF))
+#define RB_ENTRY_TYPE(word_) ((uint8_t)(((word_) >> 11) & 0x03))
+#define RB_ENTRY_LEVEL(word_) ((uint8_t)(((word_) >> 13) & 0x07))
+
+/* Atomic port ---------------------------------------------------------------*/
+// 读写指针、条目描述都是对齐的 32 位变量，在 Cortex-M 上读写天然原子
+// 预留空间使用 LDREX/STREX 实现的 CAS，不关中断，中断和多个任务可同时写日志
+#if defined(__CC_ARM) // ARMCC V5
+#define RB_DMB() __dmb(0xF)
+static __inline int RB_CAS(volatile uint32_t *ptr, uint32_t *expected, uint32_t desired)
+{
+    uint32_t current = __ldrex(ptr);
+    if (current != *expected)
+    {
+        __clrex();
+        *expected = current;
+        return 0;
+    }
+    return __strex(desired, ptr) == 0;
+}
+#elif defined(__ARM_ARCH_6M__) // Cortex-M0/M0+ 无 LDREX/STREX，只能短暂关中断
+#define RB_DMB() __asm volatile("dmb" ::: "memory")
+static inline int RB_CAS(volatile uint32_t *ptr, uint32_t *expected, uint32_t desired)
+{
+    uint32_t primask;
+    int ok = 0;
+    __asm volatile("mrs %0, primask\n cpsid i" : "=r"(primask)::"memory");
+    if (*ptr == *expected)
+    {
+        *ptr = desired;
+        ok = 1;
+    }
+    else
+    {
+        *expected = *ptr;
+    }
+    __asm volatile("msr primask, %0" ::"r"(primask) : "memory");
+    return ok;
+}
+#else // GCC、ARMCLANG（AC6）
+#define RB_DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define RB_CAS(ptr, expected, desired) \
+    __atomic_compare_exchange_n((ptr), (expected), (desired), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#endif
+
+// 原子加（基于 CAS），用于丢弃计数
+static __inline void RB_AtomicAdd(volatile uint32_t *ptr, uint32_t value)
+{
+    uint32_t old = *ptr;
+    while (!RB_CAS(ptr, &old, old + value))
+    {
+    }
+}
+
+// 原子交换（基于 CAS），返回旧值
+static __inline uint32_t RB_AtomicSwap(volatile uint32_t *ptr, uint32_t value)
+{
+    uint32_t old = *ptr;
+    while (!RB_CAS(ptr, &old, value))
+    {
+    }
+    return old;
+}
+
+#if RP_LOG_USE_STATS
+// 原子取最大值（基于 CAS），只有超过当前值时才写入，稳定后只剩一次读取
+static __inline void RB_AtomicMax(volatile uint32_t *ptr, uint32_t value)
+{
+    uint32_t old = *ptr;
+    while (value > old && !RB_CAS(ptr, &old, value))
+    {
+    }
+}
+
+// 统计计数加一（多个生产者同时写日志，需原子加）
+#define RP_LOG_STATS_INC(counter_) RB_AtomicAdd(&(counter_), 1)
+#else
+#define RP_LOG_STATS_INC(counter_) ((void)0)
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+
+// 时间戳原始计数（DWT 为扩展到 64 位的周期数，HAL 为毫秒）
+#if RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT
+typedef uint64_t RP_LogTick_t;
+#else
+typedef uint32_t RP_LogTick_t;
+#endif
+
+#if RP_LOG_USE_DEFERRED
+// 延迟格式化记录头（其后紧跟打包后的参数）
+typedef struct
+{
+    const char *file;       // 源文件名（RP_LOG_FILE）
+    const char *format;     // 格式化字符串（需为常量）
+    RP_LogTick_t timestamp; // 写入时的时间戳（原始计数）
+    uint16_t line;          // 行号
+    uint8_t level;          // 日志等级
+    uint8_t args_len;       // 参数区长度
+} RP_LogDeferredHdr_t;
+
+// 记录头加参数区不能超过单条日志最大长度
+typedef char RP_LogDeferredSizeCheck_t[(sizeof(RP_LogDeferredHdr_t) + RP_LOG_DEFER_ARG_MAX <= RP_LOG_ENTRY_MAX_SIZE) ? 1 : -1];
+#endif
+
+// 原始数据记录头（其后紧跟数据，RP_LOG_HEX / RP_LOG_RAW）
+typedef struct
+{
+    const char *file;       // 源文件名（RP_LOG_FILE）
+    RP_LogTick_t timestamp; // 写入时的时间戳（原始计数）
+    uint16_t line;          // 行号
+    uint8_t level;          // 日志等级
+    uint8_t kind;           // 显示方式 | RP_LOG_DATA_CUT
+} RP_LogDataHdr_t;
+
+// 单条原始数据最多字节数
+#define RP_LOG_DATA_MAX (RP_LOG_ENTRY_MAX_SIZE - sizeof(RP_LogDataHdr_t))
+
+#if RP_LOG_USE_TELEMETRY
+#if RP_LOG_TELEMETRY_VAR_MAX < 1 || RP_LOG_TELEMETRY_VAR_MAX > 255
+#error "RP_LOG_TELEMETRY_VAR_MAX must be between 1 and 255"
+#endif
+#if RP_LOG_TELEMETRY_LEVEL < RP_LOG_LVL_FATAL || RP_LOG_TELEMETRY_LEVEL > RP_LOG_LVL_TRACE
+#error "RP_LOG_TELEMETRY_LEVEL must be one of RP_LOG_LVL_XXX"
+#endif
+// 变量采样记录头（其后按注册顺序紧跟各变量的原始值）
+typedef struct
+{
+    RP_LogTick_t timestamp; // 采样时的时间戳（原始计数）
+    uint16_t seq;           // 采样序号
+    uint8_t count;          // 变量数（采样时已注册的变量数）
+    uint8_t reserved;
+} RP_LogSampleHdr_t;
+
+// 一次采样的记录不能超过单条日志最大长度
+typedef char RP_LogSampleSizeCheck_t[(sizeof(RP_LogSampleHdr_t) + RP_LOG_TELEMETRY_VAR_MAX * 4 <= RP_LOG_ENTRY_MAX_SIZE) ? 1 : -1];
+#if RP_LOG_USE_BINARY && (1 + 2 + 8 + 1 + RP_LOG_TELEMETRY_VAR_MAX * 4 > RP_LOG_FRAME_PAYLOAD_MAX || \
+                          1 + RP_LOG_TELEMETRY_VAR_MAX * 5 > RP_LOG_FRAME_PAYLOAD_MAX)
+#error "RP_LOG_TELEMETRY_VAR_MAX is too large for one frame, increase RP_LOG_DEFER_ARG_MAX"
+#endif
+
+// 各变量类型的字节数（RP_LogVarType_t）
+static const uint8_t g_var_sizes[] = {1, 1, 2, 2, 4, 4, 4};
+#endif
+
+#if RP_LOG_NEED_SPEC
+// 格式说明符对应的参数类型
+typedef enum
+{
+    RP_LOG_ARG_NONE = 0, // 无参数（%%）
+    RP_LOG_ARG_INT,      // int 及更短的整型、%c
+    RP_LOG_ARG_LONG,     // long
+    RP_LOG_ARG_LLONG,    // long long、intmax_t
+    RP_LOG_ARG_SIZE,     // size_t、ptrdiff_t
+    RP_LOG_ARG_DOUBLE,   // double（float 按 double 传参）
+    RP_LOG_ARG_STR,      // 字符串（按值拷贝）
+    RP_LOG_ARG_PTR       // 指针
+} RP_LogArgType_t;
+
+// 单个格式说明符解析结果
+typedef struct
+{
+    const char *start;  // 指向 '%'
+    const char *end;    // 指向转换字符之后
+    uint8_t width_star; // 宽度为 '*'
+    uint8_t prec_star;  // 精度为 '*'
+    uint8_t type;       // 参数类型（RP_LogArgType_t）
+    uint8_t flags;      // 标志（RP_LOG_FLAG_XXX）
+    uint8_t half;       // 'h' 个数（1=short，2=char）
+    char conv;          // 转换字符
+    int16_t width;      // 最小宽度
+    int16_t prec;       // 精度（-1=未指定）
+} RP_LogSpec_t;
+
+// 取出的单个参数
+typedef struct
+{
+    union
+    {
+        long long i;   // 整型（按符号扩展）
+        double f;      // 浮点
+        const void *p; // 指针、字符串
+    } v;
+    int16_t str_len;   // 字符串长度（-1=以 '\0' 结尾）
+} RP_LogArg_t;
+
+// 格式化输出位置
+typedef struct
+{
+    char *buf; // 输出缓冲区
+    int size;  // 缓冲区大小（含结尾 '\0'）
+    int len;   // 已写入长度
+} RP_LogOut_t;
+#endif
+
 /* Private variables --------------------------------------------------------*/
 
+#if RP_LOG_NEED_TEXT
 static const char *g_level_names[] = { // 日志等级字符串
     "FATAL", "ERROR", "WARN ", "INFO ", "DEBUG", "TRACE"};
+#endif
+
+#if RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT
+static volatile uint32_t g_dwt_epoch; // CYCCNT 回绕次数(高31位) | 上次采样时 CYCCNT 的最高位(第0位)
+#endif
+#if RP_LOG_NEED_DWT
+static volatile uint8_t g_dwt_ready; // DWT 计数器已使能
+#endif
 
 #if RP_LOG_USE_RTT
 #define RP_LOG_COLOR_FATAL "\033[1;35m"
@@ -51,322 +454,4769 @@ static const char *g_level_colors[] = { // 日志颜色
 static int RP_Log_Write(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line, const char *format, ...); // 写日志
 static void RP_Log_Work(RP_Log_t *log);                                                                           // 处理输出
 static uint16_t RP_Log_GetCount(RP_Log_t *log);                                                                   // 获取数量
+static int RP_Log_GetStats(RP_Log_t *log, RP_LogStats_t *stats);                                                  // 读取运行统计
 static void RP_Log_Flush(RP_Log_t *log);                                                                          // 清空缓冲区
+static void RP_Log_TxCplt(RP_Log_t *log);                                                                         // 发送完成通知
+static int RP_Log_AddSink(RP_Log_t *log, RP_LogSink_t *sink);                                                   // 注册输出
+static void RP_Log_RemoveSink(RP_Log_t *log, RP_LogSink_t *sink);                                               // 移除输出
+static void RP_Log_SinkReset(RP_Log_t *log, RP_LogSink_t *sink);                                                // 清除输出的发送状态
+static void RP_Log_SinkCplt(RP_Log_t *log, RP_LogSink_t *sink);                                                 // 输出发送完成通知
+static void RP_Log_SinkWork(RP_Log_t *log, RP_LogSink_t *sink);                                                 // 处理一个输出
+static RP_LogRingBuffer_t *RP_Log_SinkSelect(RP_Log_t *log, RP_LogSink_t *sink, uint8_t mask);                 // 选择输出读取的缓冲区
+static void RP_Log_SinkRelease(RP_Log_t *log, RP_LogSink_t *sink);                                              // 不再使用读指针处的条目时取消登记
+static int RP_Log_Evict(RP_Log_t *log, uint16_t length);                                                        // DISCARD_OLDEST 腾出空间
+static void RP_Log_StartTransmit(RP_Log_t *log, RP_LogSink_t *sink, const uint8_t *data, uint16_t length,
+                                 uint16_t advance);                                                             // 启动发送
+static uint16_t RP_Log_FormatDropped(RP_Log_t *log, RP_LogSink_t *sink, uint8_t *buffer, uint32_t count);      // 格式化丢弃提示行
+static uint8_t RP_Log_IsPending(RP_Log_t *log);                                                                 // 是否还有待处理数据
+static uint8_t RP_Log_RangeMask(RP_LogOutputRange_t range);                                                     // 输出范围对应的等级位掩码
+static int RP_Log_UartTransmit(RP_LogSink_t *sink, const uint8_t *data, uint16_t length);                      // 默认串口输出
+static uint8_t RP_Log_LevelEnabled(RP_Log_t *log, RP_LogLevel_t level);                                         // 等级是否在输出范围内
+static int RP_Log_Recover(RP_Log_t *log);                                                                       // 复位后找回日志
+static void RP_Log_PanicFlush(RP_Log_t *log);                                                                   // 异常中同步发出全部日志
+static int RP_Log_PanicDrain(RP_Log_t *log, RP_LogSink_t *sink, RP_LogRingBuffer_t *rb, uint8_t mask);         // 轮询发出一个缓冲区
+#if RP_LOG_USE_NOINIT
+static uint32_t RP_Log_NoinitHash(uint32_t hash, const uint8_t *data, uint16_t length);                          // FNV-1a 累加
+static uint32_t RP_Log_NoinitLayout(RP_LogRingBuffer_t *rb);                                                    // 缓冲区布局摘要
+static int RP_Log_NoinitRom(const char *p);                                                                      // 指针是否在只读区
+static uint16_t RP_Log_RecoverRing(RP_Log_t *log, RP_LogRingBuffer_t *rb);                                      // 检查并找回一个缓冲区
+static int RP_Log_NoinitCheck(RP_LogRingBuffer_t *rb, uint16_t data_pos, uint16_t length, uint8_t type);       // 检查记录中的指针
+#endif
+static RP_LogRingBuffer_t *RP_Log_Layout(void *buffer, uint32_t size, RP_LogRingBuffer_t **lane);               // 划分高优先级通道和主缓冲区
+static RP_LogRingBuffer_t *RP_Log_Reserve(RP_Log_t *log, uint8_t level, uint16_t length, uint32_t *index);      // 按等级预留空间
+static int RP_Log_Push(RP_Log_t *log, const uint8_t *data, uint16_t length, uint8_t type, uint8_t level);      // 按等级写入数据
+static RP_LogRingBuffer_t *RP_Log_ReserveRing(RP_Log_t *log, uint8_t level, uint16_t length, uint32_t *index);  // 在高优先级通道或主缓冲区预留空间
+#if RP_LOG_USE_STAGE
+static RP_LogStage_t *RP_Log_StageSelf(RP_Log_t *log, uint8_t level);                                          // 当前任务的暂存区
+static RP_LogRingBuffer_t *RP_Log_StageReserve(RP_LogStage_t *stage, uint16_t length, uint32_t *index);        // 在暂存区预留空间
+static void RP_Log_StageReport(RP_Log_t *log);                                                                  // 报告各暂存区的丢弃条数
+static void RP_Log_StageMerge(RP_Log_t *log);                                                                   // 按时间戳并入主缓冲区
+#endif
+static int RP_Log_WriteSite(RP_Log_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                            const char *format, ...);                                                            // 写日志（按调用位置去重）
+static int RP_Log_RateLimit(RP_Log_t *log, RP_LogSite_t *site, uint32_t period_ms, RP_LogLevel_t level,
+                            const char *file, int line);                                                        // 限频检查
+static int RP_Log_WriteData(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line, uint8_t kind,
+                            const void *data, uint16_t length);                                                 // 写原始数据
+static int RP_Log_WriteArgs(RP_Log_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                            const char *format, const void *args, uint16_t length);                             // 写已打包参数的日志
+static int RP_Log_Submit(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line,
+                         const char *format, va_list args);                                                     // 写入并统计（已通过等级过滤）
+static int RP_Log_Account(RP_Log_t *log, RP_LogLevel_t level, int ret);                                         // 统计写入结果并唤醒日志线程
+#if RP_LOG_STATS_TIMED
+static uint32_t RP_Log_TimedStart(void);                                                                        // write() 计时开始
+static void RP_Log_TimedEnd(RP_Log_t *log, uint32_t start);                                                     // write() 计时结束
+#endif
+static int RP_Log_AddVar(RP_Log_t *log, const char *name, const volatile void *addr, RP_LogVarType_t type);     // 注册采样变量
+static void RP_Log_Sample(RP_Log_t *log);                                                                       // 采样已注册的变量
+static int RP_Log_AddStage(RP_Log_t *log, RP_LogStage_t *stage);                                               // 注册任务暂存区
+static int RP_Log_SetFilter(RP_Log_t *log, uint8_t module, RP_LogOutputRange_t range);                          // 设置模块的输出等级
+static int RP_Log_FilterCmd(RP_Log_t *log, const char *cmd, uint16_t length);                                   // 处理串口过滤命令
+#if RP_LOG_USE_FILTER
+static uint16_t RP_Log_ParseUint(const char *s, uint16_t length, uint32_t *value);                              // 解析十进制数
+#endif
+static int RP_Log_VWrite(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line,
+                         const char *format, va_list args);                                                     // 格式化并写入缓冲区
+static uint32_t RP_Log_SiteTime(void);                                                                          // 调用位置状态使用的毫秒时间
+static void RP_Log_SiteReport(RP_Log_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                              const char *format);                                                              // 输出被抑制条数
+#if RP_LOG_USE_DEDUP
+static uint32_t RP_Log_Hash(uint32_t hash, const void *data, uint16_t length);                                  // FNV-1a 摘要
+static uint32_t RP_Log_HashArgs(const char *format, va_list args);                                             // 按格式串计算参数摘要
+static uint8_t RP_Log_SiteRepeat(RP_Log_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                                 uint32_t hash);                                                                // 去重检查
+#endif
+#if RP_LOG_USE_STATS
+static void RP_Log_StatsPeak(RP_Log_t *log);                                                                    // 更新缓冲区最高占用
+static void RP_Log_StatsReport(RP_Log_t *log);                                                                  // 输出统计行
+static void RP_Log_StatsUpdate(RP_Log_t *log);                                                                  // 周期维护统计
+#endif
+
+static RP_LogRingBuffer_t *RB_Layout(void *buffer, uint32_t size, uint16_t ref_size, uint16_t ref_cnt); // 在内存上划分缓冲区
+static void RB_Reset(RP_LogRingBuffer_t *rb);                                                       // 清空读写指针和条目描述
+static void RB_Attach(RP_LogRingBuffer_t *rb, uint8_t id);                                          // 启用输出的读指针
+static void RB_Detach(RP_LogRingBuffer_t *rb, uint8_t id);                                          // 停用输出的读指针
+static int RB_Reserve(RP_LogRingBuffer_t *rb, uint16_t length, uint32_t *index);                    // 预留空间（无锁）
+static void RB_Commit(RP_LogRingBuffer_t *rb, uint32_t index, uint16_t length, uint8_t type, uint8_t level); // 提交条目
+static void RB_CopyIn(RP_LogRingBuffer_t *rb, uint16_t pos, const uint8_t *data, uint16_t length); // 拷入数据（处理回绕）
+static void RB_CopyOut(RP_LogRingBuffer_t *rb, uint16_t pos, uint8_t *data, uint16_t length);      // 拷出数据（处理回绕）
+static int RB_Publish(RP_LogRingBuffer_t *rb, uint32_t index, uint16_t length, uint8_t type, uint8_t level); // 提交并检查是否需唤醒
+static int RB_Push(RP_LogRingBuffer_t *rb, const uint8_t *data, uint16_t length, uint8_t type, uint8_t level); // 写入数据
+static uint16_t RB_GetCount(RP_LogRingBuffer_t *rb);                                                // 获取条目数量
+static int RB_GetEntry(RP_LogRingBuffer_t *rb, uint16_t pos, uint16_t *length, uint8_t *type, uint8_t *level); // 读取条目描述
+static int RB_Front(RP_LogRingBuffer_t *rb, uint8_t id, uint16_t *length, uint8_t *type, uint8_t *level); // 获取输出的下一条目
+static uint16_t RB_Skip(RP_LogRingBuffer_t *rb, uint8_t id, uint8_t mask);                          // 跳过等级不在范围内的条目
+static uint16_t RB_Peek(RP_LogRingBuffer_t *rb, uint8_t id, const uint8_t **data, uint16_t max,
+                        uint8_t mask, uint8_t *level);                                              // 获取连续可读区域
+static void RB_Advance(RP_LogRingBuffer_t *rb, uint8_t id, uint16_t length);                        // 输出读指针前进
+static void RB_Reclaim(RP_LogRingBuffer_t *rb);                                                     // 回收各输出都已读过的空间
+static int RB_Pin(RP_LogRingBuffer_t *rb, uint8_t id);                                             // 登记输出正在读取
+static void RB_Unpin(RP_LogRingBuffer_t *rb, uint8_t id);                                          // 取消登记
+static uint16_t RB_Catchup(RP_LogRingBuffer_t *rb, uint8_t id);                                    // 落在 tail 之前的读指针前进到 tail
+static int RB_Evict(RP_LogRingBuffer_t *rb, uint16_t length);                                      // 丢弃最早的条目腾出空间
+
+static RP_LogTick_t RP_Log_GetTimestamp(void);                                                                  // 读取时间戳原始计数
+#if RP_LOG_NEED_DWT
+static void RP_Log_DwtEnable(void);                                                                              // 使能 CYCCNT
+#endif
+#if RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT
+static void RP_Log_DwtUpdate(void);                                                                              // 维护 CYCCNT 高位
+#endif
+#if RP_LOG_NEED_TEXT
+static int RP_Log_FormatTimestamp(char *buf, int size, RP_LogTick_t ts);                                         // 格式化时间戳
+static int RP_Log_Format(char *buf, int size, const char *format, ...);                                          // 格式化（内置或 vsnprintf）
+static int RP_Log_VFormat(char *buf, int size, const char *format, va_list args);                                // 格式化（内置或 vsnprintf）
+#endif
+
+#if RP_LOG_NEED_SPEC
+static const char *RP_Log_ParseSpec(const char *p, RP_LogSpec_t *spec);                                           // 解析格式说明符
+#endif
+
+#if RP_LOG_USE_LITE_FORMAT && RP_LOG_NEED_TEXT
+static void RP_Log_LitePad(RP_LogOut_t *out, const RP_LogSpec_t *spec, uint8_t zero_fill, const char *prefix,
+                           uint8_t zeros, const char *body, uint8_t length);                                     // 按宽度输出
+static void RP_Log_LiteInt(RP_LogOut_t *out, const RP_LogSpec_t *spec, long long value, uint8_t ptr);           // 输出整数
+#if RP_LOG_LITE_FLOAT
+static uint8_t RP_Log_LiteTie(double frac, double scale, double product, uint8_t odd);                         // 恰好一半时是否进位
+static void RP_Log_LiteFloat(RP_LogOut_t *out, const RP_LogSpec_t *spec, double value);                         // 输出定点小数
+#endif
+static void RP_Log_LiteArg(RP_LogOut_t *out, const RP_LogSpec_t *spec, const RP_LogArg_t *arg);                  // 输出单个参数
+static int RP_Log_LiteFormat(char *buf, int size, const char *format, va_list args);                             // 内置格式化
+#endif
 
-static uint16_t RB_GetNextIndex(uint16_t index, uint16_t max);                    // 计算下一个索引
-static int RB_IsFull(RP_LogRingBuffer_t *rb);                                     // 判断缓冲区满
-static int RB_IsEmpty(RP_LogRingBuffer_t *rb);                                    // 判断缓冲区空
-static int RB_Push(RP_LogRingBuffer_t *rb, const uint8_t *data, uint16_t length); // 写入数据
-static int RB_Pop(RP_LogRingBuffer_t *rb, uint8_t *data, uint16_t *length);       // 读取数据
+#if RP_LOG_USE_DEFERRED
+static uint16_t RP_Log_PackArgs(uint8_t *dst, uint16_t size, const char *format, va_list args);                   // 打包参数
+static int RP_Log_WriteDeferred(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line,
+                                const char *format, va_list args);                                                // 写入延迟格式化记录
+static int RP_Log_PushDeferred(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line, const char *format,
+                               const uint8_t *args, uint16_t length);                                            // 拷入记录头和已打包的参数
+#if RP_LOG_NEED_TEXT
+#if !RP_LOG_USE_LITE_FORMAT
+static void RP_Log_SnprintfArg(RP_LogOut_t *out, const RP_LogSpec_t *spec, const RP_LogArg_t *arg);              // snprintf 输出单个参数
+#endif
+static int RP_Log_FormatArgs(char *buf, int size, const char *format, const uint8_t *args, uint16_t args_len);    // 按打包参数格式化
+static uint16_t RP_Log_FormatDeferred(RP_Log_t *log, const uint8_t *record, uint16_t length, uint8_t *buffer);   // 格式化延迟记录
+#endif
+static uint16_t RP_Log_FormatRecord(RP_Log_t *log, RP_LogSink_t *sink, const uint8_t *record, uint16_t length,
+                                    uint8_t *buffer);                                                           // 按输出格式处理延迟记录
+#endif
+
+#if RP_LOG_NEED_FRAME
+static uint16_t RP_Log_Crc16(uint16_t crc, const uint8_t *data, uint16_t length);                                 // CRC16-CCITT
+static uint16_t RP_Log_EncodeFrame(uint16_t *seq, uint8_t type, const uint8_t *payload, uint16_t length,
+                                   uint8_t *buffer);                                                              // 封装二进制帧
+#endif
+#if RP_LOG_USE_COMPRESS
+static uint16_t RP_Log_Compress(RP_Log_t *log, RP_LogSink_t *sink, const uint8_t *data, uint16_t length);       // 压缩一块到 tx_buffer
+#endif
+static int RP_Log_FormatData(RP_Log_t *log, RP_LogSink_t *sink, const uint8_t *record, uint16_t length,
+                             uint8_t *buffer, uint16_t size, uint8_t fit);                                    // 展开原始数据的一行（一帧）
+static int RP_Log_FormatSample(RP_Log_t *log, RP_LogSink_t *sink, const uint8_t *record, uint16_t length,
+                               uint8_t *buffer, uint16_t size, uint8_t fit);                                  // 展开一段采样记录
+static int RP_Log_FormatExpand(RP_Log_t *log, RP_LogSink_t *sink, uint8_t type, const uint8_t *record,
+                               uint16_t length, uint8_t *buffer, uint16_t size, uint8_t fit);                 // 展开一段原始数据或采样记录
+#if RP_LOG_USE_BINARY
+static uint16_t RP_Log_EncodeRecord(RP_LogSink_t *sink, const uint8_t *record, uint16_t length, uint8_t *buffer); // 封装记录帧
+#endif
 
 #if RP_LOG_USE_RTT
-static void RP_Log_RttOutput(RP_LogLevel_t level, const char *file, int line, const char *format, va_list args); // RTT输出
+static int RP_Log_RttTransmit(RP_LogSink_t *sink, const uint8_t *data, uint16_t length);                        // RTT输出已格式化行
 #endif
 
 /* Private functions --------------------------------------------------------*/
 
-// 计算下一个索引
-static uint16_t RB_GetNextIndex(uint16_t index, uint16_t max)
+// 在 buffer 上划分环形缓冲区：头部 | 条目描述 | 数据，空间不足时返回 NULL
+// 数据区取放得下的最大 2 的幂，条目数按 ref_cnt / ref_size 的比例分配（主缓冲区为 RP_LOG_RING_BUFFER_CNT / RP_LOG_RING_BUFFER_SIZE）
+// 只写尺寸和指针，不改动读写指针（RP_LOG_USE_NOINIT 时由 recover() 检查）
+static RP_LogRingBuffer_t *RB_Layout(void *buffer, uint32_t size, uint16_t ref_size, uint16_t ref_cnt)
+{
+    uintptr_t base = ((uintptr_t)buffer + RB_ALIGN - 1) & ~(uintptr_t)(RB_ALIGN - 1);
+    uint32_t skip = (uint32_t)(base - (uintptr_t)buffer);
+
+    if (buffer == NULL || size < skip + sizeof(RP_LogRingBuffer_t))
+    {
+        return NULL;
+    }
+
+    uint32_t avail = size - skip - sizeof(RP_LogRingBuffer_t);
+    uint32_t data_size = 32768;
+    uint32_t cnt;
+    for (;;)
+    {
+        cnt = data_size * ref_cnt / ref_size;
+        cnt = (cnt < 2) ? 2 : (cnt > 16384) ? 16384 : cnt;
+        if (data_size + cnt * sizeof(uint32_t) <= avail)
+        {
+            break;
+        }
+        data_size >>= 1;
+        if (data_size < RP_LOG_ENTRY_MAX_SIZE)
+        {
+            return NULL;
+        }
+    }
+
+    RP_LogRingBuffer_t *rb = (RP_LogRingBuffer_t *)base;
+    rb->entries = (volatile uint32_t *)(rb + 1);
+    rb->data = (uint8_t *)(rb->entries + cnt);
+    rb->size = (uint16_t)data_size;
+    rb->cnt = (uint16_t)cnt;
+    return rb;
+}
+
+// 清空读写指针和条目描述（保留尺寸、已启用输出和 RP_LOG_USE_NOINIT 的头部）
+// 残留的条目描述可能与新的条目指针对应同一个提交标记，需一并清零
+static void RB_Reset(RP_LogRingBuffer_t *rb)
+{
+    memset((void *)rb->entries, 0, rb->cnt * sizeof(uint32_t));
+    rb->head = 0;
+    rb->tail = 0;
+    for (uint8_t id = 0; id < RP_LOG_SINK_MAX; id++)
+    {
+        rb->cursor[id] = 0;
+        rb->entry_sent[id] = 0;
+    }
+    rb->pinned = 0;
+    rb->evicting = 0;
+}
+
+// 启用输出 id：读指针从尚未回收的最早条目开始，就绪后再参与回收和唤醒判断
+static void RB_Attach(RP_LogRingBuffer_t *rb, uint8_t id)
+{
+    rb->cursor[id] = rb->tail;
+    rb->entry_sent[id] = 0;
+
+    RB_DMB();
+    uint32_t active = rb->active;
+    while (!RB_CAS(&rb->active, &active, active | (1UL << id)))
+    {
+    }
+}
+
+// 停用输出 id：不再阻止空间回收和丢弃
+static void RB_Detach(RP_LogRingBuffer_t *rb, uint8_t id)
+{
+    uint32_t active = rb->active;
+    while (!RB_CAS(&rb->active, &active, active & ~(1UL << id)))
+    {
+    }
+    RB_Unpin(rb, id);
+}
+
+// 预留空间（无锁，可在中断中调用），成功返回 0
+// 生产者通过 CAS 同时推进数据写指针和条目写指针，互不覆盖
+static int RB_Reserve(RP_LogRingBuffer_t *rb, uint16_t length, uint32_t *index)
+{
+    uint32_t head = rb->head;
+
+    for (;;)
+    {
+        uint32_t tail = rb->tail;
+        uint16_t used = (uint16_t)(RB_DATA_POS(head) - RB_DATA_POS(tail));
+        uint16_t count = (uint16_t)(RB_ENTRY_POS(head) - RB_ENTRY_POS(tail));
+
+        // head 读取后被抢占，期间 tail 已越过旧 head：快照不一致，重读 head 后重试
+        if (count > rb->cnt || used > rb->size)
+        {
+            head = rb->head;
+            continue;
+        }
+
+        if (count >= rb->cnt || rb->size - used < length)
+        {
+            return -1;
+        }
+
+        uint32_t next = RB_INDEX(RB_DATA_POS(head) + length, RB_ENTRY_POS(head) + 1);
+        if (RB_CAS(&rb->head, &head, next))
+        {
+            break;
+        }
+    }
+
+    *index = head;
+    return 0;
+}
+
+// 提交条目（数据拷贝完成后调用），单次 32 位写入，消费者看到后才会读取数据
+static void RB_Commit(RP_LogRingBuffer_t *rb, uint32_t index, uint16_t length, uint8_t type, uint8_t level)
+{
+    uint16_t pos = RB_ENTRY_POS(index);
+
+    RB_DMB();
+    rb->entries[pos & RB_ENTRY_MASK(rb)] = RB_ENTRY_MAKE(pos, type, level, length);
+}
+
+// 拷入数据（处理回绕）
+static void RB_CopyIn(RP_LogRingBuffer_t *rb, uint16_t pos, const uint8_t *data, uint16_t length)
+{
+    uint16_t offset = pos & RB_DATA_MASK(rb);
+    uint16_t first = rb->size - offset;
+
+    if (first >= length)
+    {
+        memcpy(&rb->data[offset], data, length);
+    }
+    else
+    {
+        memcpy(&rb->data[offset], data, first);
+        memcpy(&rb->data[0], data + first, length - first);
+    }
+}
+
+// 拷出数据（处理回绕）
+static void RB_CopyOut(RP_LogRingBuffer_t *rb, uint16_t pos, uint8_t *data, uint16_t length)
+{
+    uint16_t offset = pos & RB_DATA_MASK(rb);
+    uint16_t first = rb->size - offset;
+
+    if (first >= length)
+    {
+        memcpy(data, &rb->data[offset], length);
+    }
+    else
+    {
+        memcpy(data, &rb->data[offset], first);
+        memcpy(data + first, &rb->data[0], length - first);
+    }
+}
+
+// 写入数据（预留、拷贝、提交），失败返回 -1
+// 返回 1 表示有输出已读到本条目：该输出此时可能正因缓冲区空或该条目未提交而等待
+static int RB_Push(RP_LogRingBuffer_t *rb, const uint8_t *data, uint16_t length, uint8_t type, uint8_t level)
+{
+    uint32_t index;
+
+    if (length > RP_LOG_ENTRY_MAX_SIZE)
+    {
+        length = RP_LOG_ENTRY_MAX_SIZE;
+    }
+
+    if (RB_Reserve(rb, length, &index) != 0)
+    {
+        return -1;
+    }
+
+    RB_CopyIn(rb, RB_DATA_POS(index), data, length);
+    return RB_Publish(rb, index, length, type, level);
+}
+
+// 提交已拷贝完的条目，返回值同 RB_Push()（分段拷入的写入方直接调用）
+static int RB_Publish(RP_LogRingBuffer_t *rb, uint32_t index, uint16_t length, uint8_t type, uint8_t level)
+{
+    RB_Commit(rb, index, length, type, level);
+
+    // 提交后再读各输出的读指针：若某个输出已前进到本条目，它前进后的检查一定能看到本次提交
+    RB_DMB();
+    uint32_t active = rb->active;
+    for (uint8_t id = 0; active != 0; id++, active >>= 1)
+    {
+        if ((active & 1UL) && RB_ENTRY_POS(rb->cursor[id]) == RB_ENTRY_POS(index))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 获取条目数量（含已预留未提交、尚未回收的条目）
+static uint16_t RB_GetCount(RP_LogRingBuffer_t *rb)
+{
+    return (uint16_t)(RB_ENTRY_POS(rb->head) - RB_ENTRY_POS(rb->tail));
+}
+
+// 读取条目描述，未提交时返回 -1
+static int RB_GetEntry(RP_LogRingBuffer_t *rb, uint16_t pos, uint16_t *length, uint8_t *type, uint8_t *level)
+{
+    uint32_t word = rb->entries[pos & RB_ENTRY_MASK(rb)];
+
+    if ((uint16_t)(word >> 16) != RB_ENTRY_TAG(pos))
+    {
+        return -1;
+    }
+    RB_DMB();
+
+    *length = RB_ENTRY_LENGTH(word);
+    *type = RB_ENTRY_TYPE(word);
+    *level = RB_ENTRY_LEVEL(word);
+    return 0;
+}
+
+// 获取输出 id 的下一条目，已读完或尚未提交时返回 -1
+static int RB_Front(RP_LogRingBuffer_t *rb, uint8_t id, uint16_t *length, uint8_t *type, uint8_t *level)
 {
-    return (index + 1) % max;
+    uint16_t pos = RB_ENTRY_POS(rb->cursor[id]);
+
+    if (pos == RB_ENTRY_POS(rb->head))
+    {
+        return -1;
+    }
+    return RB_GetEntry(rb, pos, length, type, level);
 }
 
-// 判断缓冲区满
-static int RB_IsFull(RP_LogRingBuffer_t *rb)
+// 跳过输出 id 不需要的已提交条目（等级不在 mask 中），返回跳过条数
+// 前进读指针后重新检查：期间提交的条目要么在这里看到，要么其生产者看到新的读指针并唤醒日志线程
+static uint16_t RB_Skip(RP_LogRingBuffer_t *rb, uint8_t id, uint8_t mask)
 {
-    return rb->count >= RP_LOG_RING_BUFFER_CNT;
+    uint16_t total = 0;
+
+    if (rb->entry_sent[id] != 0)
+    {
+        return 0;
+    }
+
+    for (;;)
+    {
+        uint32_t cursor = rb->cursor[id];
+        uint16_t data_pos = RB_DATA_POS(cursor);
+        uint16_t entry_pos = RB_ENTRY_POS(cursor);
+        uint16_t head_pos = RB_ENTRY_POS(rb->head);
+        uint16_t count = 0;
+
+        while (entry_pos != head_pos)
+        {
+            uint16_t entry_len;
+            uint8_t type;
+            uint8_t level;
+            if (RB_GetEntry(rb, entry_pos, &entry_len, &type, &level) != 0 || (mask & (1U << level)))
+            {
+                break;
+            }
+            data_pos += entry_len;
+            entry_pos++;
+            count++;
+        }
+
+        if (count == 0)
+        {
+            return total;
+        }
+
+        rb->cursor[id] = RB_INDEX(data_pos, entry_pos);
+        RB_DMB();
+        total += count;
+    }
+}
+
+// 获取输出 id 从读指针开始的连续可读区域（不拷贝）
+// 相邻的已提交文本条目合并为一段，总长不超过 max（0=只取一条，首条总会取到），level 为首条的等级
+// 遇到缓冲区末尾、未提交、非文本或等级不在 mask 中的条目时截止，跨越末尾的条目只取前半段
+static uint16_t RB_Peek(RP_LogRingBuffer_t *rb, uint8_t id, const uint8_t **data, uint16_t max,
+                        uint8_t mask, uint8_t *level)
+{
+    uint32_t cursor = rb->cursor[id];
+    uint16_t head_pos = RB_ENTRY_POS(rb->head);
+    uint16_t offset = RB_DATA_POS(cursor) & RB_DATA_MASK(rb);
+    uint16_t contiguous = rb->size - offset;
+    uint16_t length = 0;
+    uint16_t sent = rb->entry_sent[id];
+
+    for (uint16_t pos = RB_ENTRY_POS(cursor); pos != head_pos; pos++)
+    {
+        uint16_t entry_len;
+        uint8_t type;
+        uint8_t entry_level;
+        if (RB_GetEntry(rb, pos, &entry_len, &type, &entry_level) != 0 || type != RP_LOG_ENTRY_TEXT ||
+            !(mask & (1U << entry_level)))
+        {
+            break;
+        }
+
+        uint16_t remain = entry_len - sent;
+        if (length != 0 && (max == 0 || length + remain > max))
+        {
+            break;
+        }
+
+        if (length == 0)
+        {
+            *level = entry_level;
+        }
+        length += remain;
+        sent = 0;
+        if (length >= contiguous)
+        {
+            length = contiguous;
+            break;
+        }
+    }
+
+    *data = &rb->data[offset];
+    return length;
+}
+
+// 输出 id 的读指针前进 length 字节（可跨越多个条目，最后一条可只读一部分）
+// 读指针只由该输出修改，单次 32 位写入；空间由 RB_Reclaim() 在所有输出读过后回收
+static void RB_Advance(RP_LogRingBuffer_t *rb, uint8_t id, uint16_t length)
+{
+    uint32_t cursor = rb->cursor[id];
+    uint16_t data_pos = RB_DATA_POS(cursor);
+    uint16_t entry_pos = RB_ENTRY_POS(cursor);
+    uint16_t head_pos = RB_ENTRY_POS(rb->head);
+
+    while (length != 0 && entry_pos != head_pos)
+    {
+        uint16_t entry_len;
+        uint8_t type;
+        uint8_t level;
+        if (RB_GetEntry(rb, entry_pos, &entry_len, &type, &level) != 0)
+        {
+            break;
+        }
+
+        uint16_t remain = entry_len - rb->entry_sent[id];
+        if (length < remain)
+        {
+            rb->entry_sent[id] += length;
+            data_pos += length;
+            break;
+        }
+
+        length -= remain;
+        data_pos += remain;
+        rb->entry_sent[id] = 0;
+        entry_pos++;
+    }
+
+    // 数据读取完成后才写读指针；写入后再检查后续条目，与 RB_Push 的唤醒判断配对
+    RB_DMB();
+    rb->cursor[id] = RB_INDEX(data_pos, entry_pos);
+    RB_DMB();
+}
+
+// 回收所有已启用输出都已读过的条目：tail 推进到最慢的输出所在条目的开头
+// 只在 work() 中调用；DISCARD_OLDEST 的写入方也会推进 tail，两者都用 CAS，被抢先时本次不回收
+// tail 始终落在条目边界上（发出一部分的条目整条保留），RB_Evict() 才能从 tail 逐条丢弃
+// 已被丢弃越过的读指针（落在 tail 之前，由 RB_Catchup() 处理）不参与比较；没有已启用的输出时保留数据
+static void RB_Reclaim(RP_LogRingBuffer_t *rb)
+{
+    uint32_t tail = rb->tail;
+    uint16_t count = (uint16_t)(RB_ENTRY_POS(rb->head) - RB_ENTRY_POS(tail));
+    uint32_t active = rb->active;
+    uint32_t slowest = 0xFFFFFFFFUL;
+
+    for (uint8_t id = 0; active != 0; id++, active >>= 1)
+    {
+        uint16_t lag = (uint16_t)(RB_ENTRY_POS(rb->cursor[id]) - RB_ENTRY_POS(tail));
+        if ((active & 1UL) && lag <= count && lag < slowest)
+        {
+            slowest = lag;
+        }
+    }
+
+    if (slowest == 0xFFFFFFFFUL || slowest == 0)
+    {
+        return;
+    }
+
+    // 读指针之前的条目都已提交；期间被丢弃、复用时描述对不上，本次不回收
+    uint16_t data_pos = RB_DATA_POS(tail);
+    uint16_t entry_pos = RB_ENTRY_POS(tail);
+    for (uint16_t i = 0; i < slowest; i++)
+    {
+        uint16_t entry_len;
+        uint8_t type;
+        uint8_t level;
+        if (RB_GetEntry(rb, entry_pos, &entry_len, &type, &level) != 0)
+        {
+            return;
+        }
+        data_pos += entry_len;
+        entry_pos++;
+    }
+
+    // 各输出的数据读取（含 DMA 发送）完成后才允许生产者复用
+    RB_DMB();
+    (void)RB_CAS(&rb->tail, &tail, RB_INDEX(data_pos, entry_pos));
+}
+
+// 登记输出 id 正在读取（或零拷贝发送）读指针处的条目，RB_Evict() 不会丢弃读指针之后的条目
+// 先置位再检查 evicting，与 RB_Evict() 先置 evicting 再读 pinned 配对：两者至少有一方看到对方
+// 返回 -1 表示有写入方正在丢弃（可能没看到本次登记），本次不要读取
+static int RB_Pin(RP_LogRingBuffer_t *rb, uint8_t id)
+{
+    uint32_t pinned = rb->pinned;
+    while (!(pinned & (1UL << id)) && !RB_CAS(&rb->pinned, &pinned, pinned | (1UL << id)))
+    {
+    }
+
+    RB_DMB();
+    return (rb->evicting != 0) ? -1 : 0;
+}
+
+// 取消登记：读指针处的条目已不再被读取，可以丢弃
+static void RB_Unpin(RP_LogRingBuffer_t *rb, uint8_t id)
+{
+    uint32_t pinned = rb->pinned;
+    while ((pinned & (1UL << id)) && !RB_CAS(&rb->pinned, &pinned, pinned & ~(1UL << id)))
+    {
+    }
+}
+
+// 输出 id 的读指针在未登记期间被 RB_Evict() 越过（落在 tail 之前）时前进到 tail，返回未读就被丢弃的条数
+// 在 RB_Pin() 成功后调用，此后 tail 不会再越过该读指针
+static uint16_t RB_Catchup(RP_LogRingBuffer_t *rb, uint8_t id)
+{
+    uint32_t tail = rb->tail;
+    uint32_t cursor = rb->cursor[id];
+
+    if ((uint16_t)(RB_ENTRY_POS(cursor) - RB_ENTRY_POS(tail)) <= (uint16_t)(RB_ENTRY_POS(rb->head) - RB_ENTRY_POS(tail)))
+    {
+        return 0;
+    }
+
+    rb->entry_sent[id] = 0;
+    rb->cursor[id] = tail;
+    RB_DMB();
+    return (uint16_t)(RB_ENTRY_POS(tail) - RB_ENTRY_POS(cursor));
+}
+
+// 从 tail 开始丢弃已提交条目，直到放得下 length 字节的新条目，返回丢弃条数，-1=腾不出空间（不丢弃）
+// 写入方在预留失败时调用，可在中断中调用；同一时刻只有一个写入方丢弃，其余直接失败
+// 不越过已登记输出的读指针：正在读取或零拷贝发送的数据不会被复用；未登记输出由 RB_Catchup() 跳过被丢弃的条目
+static int RB_Evict(RP_LogRingBuffer_t *rb, uint16_t length)
+{
+    uint32_t expected = 0;
+    int ret = -1;
+
+    if (!RB_CAS(&rb->evicting, &expected, 1))
+    {
+        return -1;
+    }
+    RB_DMB();
+
+    uint32_t tail = rb->tail;
+    for (;;)
+    {
+        // 可丢弃到最慢的已登记输出；其读指针尚未由 RB_Catchup() 赶上 tail 时一条也不能丢
+        uint16_t total = (uint16_t)(RB_ENTRY_POS(rb->head) - RB_ENTRY_POS(tail));
+        uint16_t limit = total;
+        uint32_t pinned = rb->pinned & rb->active;
+        for (uint8_t id = 0; pinned != 0; id++, pinned >>= 1)
+        {
+            uint16_t lag = (uint16_t)(RB_ENTRY_POS(rb->cursor[id]) - RB_ENTRY_POS(tail));
+            if ((pinned & 1UL) && (lag > total || lag < limit))
+            {
+                limit = (lag > total) ? 0 : lag;
+            }
+        }
+
+        uint16_t data_pos = RB_DATA_POS(tail);
+        uint16_t entry_pos = RB_ENTRY_POS(tail);
+        uint16_t count = 0;
+        for (;;)
+        {
+            uint32_t head = rb->head;
+            uint16_t used = (uint16_t)(RB_DATA_POS(head) - data_pos);
+            uint16_t entries = (uint16_t)(RB_ENTRY_POS(head) - entry_pos);
+            uint16_t entry_len;
+            uint8_t type;
+            uint8_t level;
+
+            if (entries < rb->cnt && rb->size - used >= length)
+            {
+                ret = count;
+                break;
+            }
+            if (count >= limit || RB_GetEntry(rb, entry_pos, &entry_len, &type, &level) != 0)
+            {
+                break;
+            }
+            data_pos += entry_len;
+            entry_pos++;
+            count++;
+        }
+
+        // 期间 work() 回收推进了 tail：从新的 tail 重新计算
+        if (ret <= 0)
+        {
+            break;
+        }
+        RB_DMB();
+        if (RB_CAS(&rb->tail, &tail, RB_INDEX(data_pos, entry_pos)))
+        {
+            break;
+        }
+        ret = -1;
+    }
+
+    RB_DMB();
+    rb->evicting = 0;
+    return ret;
+}
+
+#if RP_LOG_NEED_SPEC
+// 解析格式说明符（p 指向 '%'），返回说明符之后的位置
+static const char *RP_Log_ParseSpec(const char *p, RP_LogSpec_t *spec)
+{
+    uint8_t lng = 0; // 'l' 个数
+    uint8_t size = 0;
+
+    spec->start = p++;
+    spec->width_star = 0;
+    spec->prec_star = 0;
+    spec->type = RP_LOG_ARG_NONE;
+    spec->flags = 0;
+    spec->half = 0;
+    spec->conv = '\0';
+    spec->width = 0;
+    spec->prec = -1;
+
+    // 标志
+    for (;; p++)
+    {
+        if (*p == '-')
+            spec->flags |= RP_LOG_FLAG_LEFT;
+        else if (*p == '+')
+            spec->flags |= RP_LOG_FLAG_PLUS;
+        else if (*p == ' ')
+            spec->flags |= RP_LOG_FLAG_SPACE;
+        else if (*p == '#')
+            spec->flags |= RP_LOG_FLAG_ALT;
+        else if (*p == '0')
+            spec->flags |= RP_LOG_FLAG_ZERO;
+        else
+            break;
+    }
+
+    // 宽度
+    if (*p == '*')
+    {
+        spec->width_star = 1;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9')
+    {
+        if (spec->width < 1000)
+        {
+            spec->width = spec->width * 10 + (*p - '0');
+        }
+        p++;
+    }
+
+    // 精度
+    if (*p == '.')
+    {
+        p++;
+        spec->prec = 0;
+        if (*p == '*')
+        {
+            spec->prec_star = 1;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9')
+        {
+            if (spec->prec < 1000)
+            {
+                spec->prec = spec->prec * 10 + (*p - '0');
+            }
+            p++;
+        }
+    }
+
+    // 长度修饰
+    while (*p == 'h' || *p == 'l' || *p == 'j' || *p == 'z' || *p == 't' || *p == 'L')
+    {
+        if (*p == 'l')
+        {
+            lng++;
+        }
+        else if (*p == 'h')
+        {
+            spec->half++;
+        }
+        else if (*p == 'j')
+        {
+            lng = 2;
+        }
+        else if (*p == 'z' || *p == 't')
+        {
+            size = 1;
+        }
+        p++;
+    }
+
+    // 转换字符
+    spec->conv = *p;
+    switch (*p)
+    {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+        spec->type = size ? RP_LOG_ARG_SIZE : (lng >= 2 ? RP_LOG_ARG_LLONG : (lng == 1 ? RP_LOG_ARG_LONG : RP_LOG_ARG_INT));
+        break;
+    case 'c':
+        spec->type = RP_LOG_ARG_INT;
+        break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        spec->type = RP_LOG_ARG_DOUBLE;
+        break;
+    case 's':
+        spec->type = RP_LOG_ARG_STR;
+        break;
+    case 'p':
+    case 'n':
+        spec->type = RP_LOG_ARG_PTR;
+        break;
+    case '\0':
+        spec->end = p;
+        return p;
+    default: // %% 及未知转换
+        break;
+    }
+
+    spec->end = p + 1;
+    return spec->end;
+}
+#endif
+
+#if RP_LOG_USE_LITE_FORMAT && RP_LOG_NEED_TEXT
+// 写入一个字符（缓冲区满时丢弃，保留结尾 '\0' 的位置）
+#define RP_LOG_PUT(out_, c_)                   \
+    do                                         \
+    {                                          \
+        if ((out_)->len < (out_)->size - 1)    \
+        {                                      \
+            (out_)->buf[(out_)->len++] = (c_); \
+        }                                      \
+    } while (0)
+
+// 按宽度输出：[空格][前缀][0填充][精度补0][主体][空格]
+static void RP_Log_LitePad(RP_LogOut_t *out, const RP_LogSpec_t *spec, uint8_t zero_fill, const char *prefix,
+                           uint8_t zeros, const char *body, uint8_t length)
+{
+    int total = (int)strlen(prefix) + zeros + length;
+    int pad = spec->width > total ? spec->width - total : 0;
+
+    if (!(spec->flags & RP_LOG_FLAG_LEFT) && !zero_fill)
+    {
+        for (; pad > 0; pad--)
+        {
+            RP_LOG_PUT(out, ' ');
+        }
+    }
+    for (; *prefix != '\0'; prefix++)
+    {
+        RP_LOG_PUT(out, *prefix);
+    }
+    if (!(spec->flags & RP_LOG_FLAG_LEFT))
+    {
+        for (; pad > 0; pad--)
+        {
+            RP_LOG_PUT(out, '0');
+        }
+    }
+    for (; zeros > 0; zeros--)
+    {
+        RP_LOG_PUT(out, '0');
+    }
+    for (uint8_t i = 0; i < length; i++)
+    {
+        RP_LOG_PUT(out, body[i]);
+    }
+    for (; pad > 0; pad--)
+    {
+        RP_LOG_PUT(out, ' ');
+    }
+}
+
+// 输出整数（%d %i %u %x %X %o %p），数值不超过 32 位时只用 32 位除法
+static void RP_Log_LiteInt(RP_LogOut_t *out, const RP_LogSpec_t *spec, long long value, uint8_t ptr)
+{
+    const char *digits = (spec->conv == 'X') ? "0123456789ABCDEF" : "0123456789abcdef";
+    char tmp[24]; // 64 位八进制最多 22 位
+    char *end = tmp + sizeof(tmp);
+    char *p = end;
+    char prefix[3] = {0, 0, 0};
+    unsigned long long u;
+    uint8_t base = 10;
+    uint8_t zeros = 0;
+
+    if (ptr || spec->conv == 'x' || spec->conv == 'X')
+    {
+        base = 16;
+    }
+    else if (spec->conv == 'o')
+    {
+        base = 8;
+    }
+
+    // 按长度修饰截断为实际类型
+    if (spec->conv == 'd' || spec->conv == 'i')
+    {
+        if (spec->type == RP_LOG_ARG_INT)
+        {
+            value = (spec->half == 1) ? (short)value : (spec->half >= 2) ? (signed char)value : (int)value;
+        }
+        else if (spec->type == RP_LOG_ARG_SIZE)
+        {
+            value = (long long)(ptrdiff_t)(size_t)value;
+        }
+
+        if (value < 0)
+        {
+            prefix[0] = '-';
+            u = 0ULL - (unsigned long long)value;
+        }
+        else
+        {
+            prefix[0] = (spec->flags & RP_LOG_FLAG_PLUS) ? '+' : (spec->flags & RP_LOG_FLAG_SPACE) ? ' ' : '\0';
+            u = (unsigned long long)value;
+        }
+    }
+    else if (ptr)
+    {
+        u = (unsigned long long)value;
+    }
+    else
+    {
+        switch (spec->type)
+        {
+        case RP_LOG_ARG_INT:
+            u = (spec->half == 1) ? (unsigned short)value : (spec->half >= 2) ? (unsigned char)value : (unsigned int)value;
+            break;
+        case RP_LOG_ARG_LONG:
+            u = (unsigned long)value;
+            break;
+        case RP_LOG_ARG_SIZE:
+            u = (size_t)value;
+            break;
+        default:
+            u = (unsigned long long)value;
+            break;
+        }
+    }
+
+    // 数字（从低位向前填充）
+    if (u <= 0xFFFFFFFFUL)
+    {
+        uint32_t v = (uint32_t)u;
+        while (v != 0)
+        {
+            *--p = digits[v % base];
+            v /= base;
+        }
+    }
+    else
+    {
+        while (u != 0)
+        {
+            *--p = digits[u % base];
+            u /= base;
+        }
+    }
+    if (p == end && spec->prec != 0)
+    {
+        *--p = '0';
+    }
+
+    // 精度补 0、前缀
+    uint8_t length = (uint8_t)(end - p);
+    if (spec->prec > length)
+    {
+        zeros = (uint8_t)(spec->prec - length > 255 ? 255 : spec->prec - length);
+    }
+    if (ptr || ((spec->flags & RP_LOG_FLAG_ALT) && base == 16 && p != end && *p != '0'))
+    {
+        prefix[0] = '0';
+        prefix[1] = (spec->conv == 'X') ? 'X' : 'x';
+    }
+    else if ((spec->flags & RP_LOG_FLAG_ALT) && base == 8 && zeros == 0 && (p == end || *p != '0'))
+    {
+        zeros = 1;
+    }
+
+    RP_Log_LitePad(out, spec, (spec->flags & RP_LOG_FLAG_ZERO) && spec->prec < 0, prefix, zeros, p, length);
+}
+
+#if RP_LOG_LITE_FLOAT
+// 小数部分乘以 10^prec 后余数恰为 0.5 时判断是否进位（product 为 frac * scale 舍入后的乘积）
+// Dekker 乘法求出乘积的舍入误差：真实值大于一半进位、小于一半舍去，恰好一半时向偶数舍入，与 printf 相同
+static uint8_t RP_Log_LiteTie(double frac, double scale, double product, uint8_t odd)
+{
+    const double split = 134217729.0; // 2^27 + 1，把 53 位尾数拆成两个 26 位
+    double c = split * frac;
+    double frac_hi = c - (c - frac);
+    double frac_lo = frac - frac_hi;
+    c = split * scale;
+    double scale_hi = c - (c - scale);
+    double scale_lo = scale - scale_hi;
+    double error = ((frac_hi * scale_hi - product) + frac_hi * scale_lo + frac_lo * scale_hi) + frac_lo * scale_lo;
+
+    return (error > 0.0) || (error == 0.0 && odd);
+}
+
+// 输出定点小数（%f，%e %g 也按 %f 输出），精度最多 9 位；不小于 2^64 时按 %e 格式输出（如 1.844674e+19）
+// 整数部分和小数部分分别转为整数输出，不使用 printf 的浮点代码，按二进制值本身舍入（与 printf 相同）
+static void RP_Log_LiteFloat(RP_LogOut_t *out, const RP_LogSpec_t *spec, double value)
+{
+    static const uint32_t pow10[] = {1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL,
+                                     1000000UL, 10000000UL, 100000000UL, 1000000000UL};
+    char tmp[32]; // 整数部分最多 20 位 + '.' + 9 位小数；指数格式为 1 位 + '.' + 9 位 + "e+308"
+    char *end = tmp + sizeof(tmp);
+    char *p = end;
+    char prefix[2] = {0, 0};
+    int prec = (spec->prec < 0) ? 6 : (spec->prec > 9 ? 9 : spec->prec);
+    int exp10 = -1; // 指数格式的指数，-1=定点格式
+
+    if (value != value)
+    {
+        RP_Log_LitePad(out, spec, 0, "", 0, "nan", 3);
+        return;
+    }
+    // -0.0 与 printf 相同输出负号（不依赖 libm 的 signbit）
+    if (value < 0 || (value == 0 && 1.0 / value < 0))
+    {
+        prefix[0] = '-';
+        value = -value;
+    }
+    else
+    {
+        prefix[0] = (spec->flags & RP_LOG_FLAG_PLUS) ? '+' : (spec->flags & RP_LOG_FLAG_SPACE) ? ' ' : '\0';
+    }
+    if (value > 1.7976931348623157e308)
+    {
+        RP_Log_LitePad(out, spec, 0, prefix, 0, "inf", 3);
+        return;
+    }
+    if (value >= 18446744073709551616.0)
+    {
+        // 超出 64 位整数范围：缩到 [1, 10) 按指数格式输出，多次除法的误差可能使末位与 printf 相差 1
+        exp10 = 0;
+        while (value >= 1e10)
+        {
+            value /= 1e10;
+            exp10 += 10;
+        }
+        while (value >= 10.0)
+        {
+            value /= 10.0;
+            exp10++;
+        }
+    }
+
+    // 拆分整数和小数部分（小数部分相减没有误差），舍入可能向整数进位
+    unsigned long long ip = (unsigned long long)value;
+    double frac = value - (double)ip;
+    double product = frac * pow10[prec];
+    uint32_t fp = (uint32_t)product;
+    double rest = product - (double)fp;
+    if (rest > 0.5 ||
+        (rest == 0.5 && RP_Log_LiteTie(frac, pow10[prec], product, (uint8_t)((prec > 0) ? (fp & 1U) : (ip & 1U)))))
+    {
+        fp++;
+    }
+    if (fp >= pow10[prec])
+    {
+        fp -= pow10[prec];
+        ip++;
+    }
+    if (exp10 >= 0 && ip >= 10)
+    {
+        ip = 1; // 9.99...5 进位为 10.0...，重新规格化
+        exp10++;
+    }
+
+    // 指数
+    if (exp10 >= 0)
+    {
+        do
+        {
+            *--p = (char)('0' + exp10 % 10);
+            exp10 /= 10;
+        } while (exp10 != 0);
+        if (end - p < 2)
+        {
+            *--p = '0';
+        }
+        *--p = '+';
+        *--p = 'e';
+    }
+
+    // 小数部分
+    for (int i = 0; i < prec; i++)
+    {
+        *--p = (char)('0' + fp % 10);
+        fp /= 10;
+    }
+    if (prec > 0 || (spec->flags & RP_LOG_FLAG_ALT))
+    {
+        *--p = '.';
+    }
+
+    // 整数部分
+    if (ip <= 0xFFFFFFFFUL)
+    {
+        uint32_t v = (uint32_t)ip;
+        do
+        {
+            *--p = (char)('0' + v % 10);
+            v /= 10;
+        } while (v != 0);
+    }
+    else
+    {
+        do
+        {
+            *--p = (char)('0' + ip % 10);
+            ip /= 10;
+        } while (ip != 0);
+    }
+
+    RP_Log_LitePad(out, spec, (spec->flags & RP_LOG_FLAG_ZERO) != 0, prefix, 0, p, (uint8_t)(end - p));
+}
+#endif
+
+// 输出单个已取出的参数
+static void RP_Log_LiteArg(RP_LogOut_t *out, const RP_LogSpec_t *spec, const RP_LogArg_t *arg)
+{
+    switch (spec->type)
+    {
+    case RP_LOG_ARG_INT:
+    case RP_LOG_ARG_LONG:
+    case RP_LOG_ARG_LLONG:
+    case RP_LOG_ARG_SIZE:
+        if (spec->conv == 'c')
+        {
+            char c = (char)arg->v.i;
+            RP_Log_LitePad(out, spec, 0, "", 0, &c, 1);
+        }
+        else
+        {
+            RP_Log_LiteInt(out, spec, arg->v.i, 0);
+        }
+        break;
+    case RP_LOG_ARG_DOUBLE:
+#if RP_LOG_LITE_FLOAT
+        RP_Log_LiteFloat(out, spec, arg->v.f);
+#else
+        RP_Log_LitePad(out, spec, 0, "", 0, "?", 1);
+#endif
+        break;
+    case RP_LOG_ARG_STR:
+    {
+        const char *str = (arg->v.p != NULL) ? (const char *)arg->v.p : "(null)";
+        int n = arg->str_len;
+        if (n < 0)
+        {
+            for (n = 0; str[n] != '\0' && (spec->prec < 0 || n < spec->prec) && n < 255; n++)
+            {
+            }
+        }
+        else if (spec->prec >= 0 && n > spec->prec)
+        {
+            n = spec->prec;
+        }
+        RP_Log_LitePad(out, spec, 0, "", 0, str, (uint8_t)n);
+        break;
+    }
+    case RP_LOG_ARG_PTR:
+        if (spec->conv == 'p') // 不支持 %n
+        {
+            RP_Log_LiteInt(out, spec, (long long)(uintptr_t)arg->v.p, 1);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// 内置格式化（替代 vsnprintf），返回写入长度
+// 支持 %d %i %u %x %X %o %c %s %p %f 及标志、宽度、精度、'*'、长度修饰，无递归，栈占用固定
+static int RP_Log_LiteFormat(char *buf, int size, const char *format, va_list args)
+{
+    RP_LogOut_t out = {buf, size, 0};
+    RP_LogSpec_t spec;
+    RP_LogArg_t arg;
+    const char *p = format;
+
+    if (size <= 0)
+    {
+        return 0;
+    }
+
+    while (*p != '\0')
+    {
+        // 普通字符
+        if (*p != '%')
+        {
+            RP_LOG_PUT(&out, *p);
+            p++;
+            continue;
+        }
+
+        p = RP_Log_ParseSpec(p, &spec);
+
+        if (spec.width_star)
+        {
+            int width = va_arg(args, int);
+            if (width < 0)
+            {
+                spec.flags |= RP_LOG_FLAG_LEFT;
+                width = -width;
+            }
+            spec.width = (int16_t)(width > 1000 ? 1000 : width);
+        }
+        if (spec.prec_star)
+        {
+            int prec = va_arg(args, int);
+            spec.prec = (int16_t)(prec < 0 ? -1 : (prec > 1000 ? 1000 : prec));
+        }
+
+        arg.str_len = -1;
+        switch (spec.type)
+        {
+        case RP_LOG_ARG_INT:
+            arg.v.i = va_arg(args, int);
+            break;
+        case RP_LOG_ARG_LONG:
+            arg.v.i = va_arg(args, long);
+            break;
+        case RP_LOG_ARG_LLONG:
+            arg.v.i = va_arg(args, long long);
+            break;
+        case RP_LOG_ARG_SIZE:
+            arg.v.i = (long long)va_arg(args, size_t);
+            break;
+        case RP_LOG_ARG_DOUBLE:
+            arg.v.f = va_arg(args, double);
+            break;
+        case RP_LOG_ARG_STR:
+        case RP_LOG_ARG_PTR:
+            arg.v.p = va_arg(args, const void *);
+            break;
+        case RP_LOG_ARG_NONE:
+        default:
+            if (spec.conv == '%')
+            {
+                RP_LOG_PUT(&out, '%');
+            }
+            continue;
+        }
+
+        RP_Log_LiteArg(&out, &spec, &arg);
+    }
+
+    buf[out.len] = '\0';
+    return out.len;
+}
+#endif
+
+#if RP_LOG_NEED_DWT
+// 使能 CYCCNT（第一次使用时调用，重复调用无副作用）
+static void RP_Log_DwtEnable(void)
+{
+    RP_LOG_DEMCR |= (1UL << 24); // TRCENA
+    RP_LOG_DWT_LAR = 0xC5ACCE55UL;
+    RP_LOG_DWT_CTRL |= 1UL; // CYCCNTENA
+    g_dwt_ready = 1;
+}
+#endif
+
+#if RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT
+// 维护 CYCCNT 高位（由 work() 周期调用，间隔需小于半个回绕周期，168MHz 时约 12.7s）
+// 只有消费者写 g_dwt_epoch，单次 32 位写入，生产者无需加锁
+static void RP_Log_DwtUpdate(void)
+{
+    if (!g_dwt_ready)
+    {
+        RP_Log_DwtEnable();
+    }
+
+    uint32_t epoch = g_dwt_epoch;
+    uint32_t msb = RP_LOG_DWT_CYCCNT >> 31;
+
+    // 最高位由 1 变 0 即发生一次回绕，+1 同时清除第0位并使高位加一
+    g_dwt_epoch = ((epoch & 1UL) && !msb) ? epoch + 1UL : ((epoch & ~1UL) | msb);
+}
+#endif
+
+// 读取时间戳原始计数（写日志时调用，只记录计数，换算留到格式化时）
+static RP_LogTick_t RP_Log_GetTimestamp(void)
+{
+#if RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT
+    if (!g_dwt_ready)
+    {
+        RP_Log_DwtUpdate();
+    }
+
+    // 先读高位再读计数：计数只会比采样时更新，最高位由 1 变 0 说明采样后又回绕了一次
+    uint32_t epoch = g_dwt_epoch;
+    RB_DMB();
+    uint32_t cnt = RP_LOG_DWT_CYCCNT;
+    uint32_t high = epoch >> 1;
+    if ((epoch & 1UL) && !(cnt >> 31))
+    {
+        high++;
+    }
+    return ((uint64_t)high << 32) | cnt;
+#elif defined(USE_HAL_DRIVER)
+    return HAL_GetTick();
+#else
+    return 0;
+#endif
+}
+
+#if RP_LOG_NEED_TEXT
+// 格式化时间戳，返回长度（没有时间源时不输出）
+// DWT: "[秒.微秒] "，64 位计数只在超过 32 位后才用 64 位除法；HAL: "[毫秒] "
+static int RP_Log_FormatTimestamp(char *buf, int size, RP_LogTick_t ts)
+{
+#if RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT
+    uint32_t freq = RP_LOG_DWT_FREQ_HZ;
+    uint32_t sec, rem;
+
+    if (freq == 0)
+    {
+        return 0;
+    }
+    if ((ts >> 32) == 0)
+    {
+        sec = (uint32_t)ts / freq;
+        rem = (uint32_t)ts % freq;
+    }
+    else
+    {
+        sec = (uint32_t)(ts / freq);
+        rem = (uint32_t)(ts - (uint64_t)sec * freq);
+    }
+
+    // 内核时钟为整 MHz 时只需一次 32 位除法
+    uint32_t per_us = freq / 1000000UL;
+    uint32_t us = (per_us * 1000000UL == freq) ? rem / per_us : (uint32_t)(((uint64_t)rem * 1000000UL) / freq);
+
+    return RP_Log_Format(buf, size, "[%lu.%06lu] ", (unsigned long)sec, (unsigned long)us);
+#elif defined(USE_HAL_DRIVER)
+    return RP_Log_Format(buf, size, "[%lu] ", (unsigned long)ts);
+#else
+    (void)buf;
+    (void)size;
+    (void)ts;
+    return 0;
+#endif
+}
+
+// 格式化到缓冲区（内置格式化或 vsnprintf），截断时返回值可能大于写入长度，调用者需自行限制
+static int RP_Log_VFormat(char *buf, int size, const char *format, va_list args)
+{
+#if RP_LOG_USE_LITE_FORMAT
+    return RP_Log_LiteFormat(buf, size, format, args);
+#else
+    return vsnprintf(buf, size, format, args);
+#endif
+}
+
+// 格式化到缓冲区（可变参数版本）
+static int RP_Log_Format(char *buf, int size, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int len = RP_Log_VFormat(buf, size, format, args);
+    va_end(args);
+    return len;
+}
+#endif
+
+#if RP_LOG_USE_DEFERRED
+// 按值拷贝一个参数到参数区，空间不足时停止打包
+#define RP_LOG_PACK_ARG(type_, value_)               \
+    do                                               \
+    {                                                \
+        type_ v_ = (value_);                         \
+        if (len + sizeof(v_) > size)                 \
+        {                                            \
+            return len;                              \
+        }                                            \
+        memcpy(dst + len, &v_, sizeof(v_));          \
+        len += sizeof(v_);                           \
+    } while (0)
+
+// 按格式串依次取出可变参数并打包（不做任何格式化）
+static uint16_t RP_Log_PackArgs(uint8_t *dst, uint16_t size, const char *format, va_list args)
+{
+    uint16_t len = 0;
+    RP_LogSpec_t spec;
+    const char *p = format;
+
+    while ((p = strchr(p, '%')) != NULL)
+    {
+        p = RP_Log_ParseSpec(p, &spec);
+
+        if (spec.width_star)
+        {
+            RP_LOG_PACK_ARG(int, va_arg(args, int));
+        }
+        if (spec.prec_star)
+        {
+            RP_LOG_PACK_ARG(int, va_arg(args, int));
+        }
+
+        switch (spec.type)
+        {
+        case RP_LOG_ARG_INT:
+            RP_LOG_PACK_ARG(int, va_arg(args, int));
+            break;
+        case RP_LOG_ARG_LONG:
+            RP_LOG_PACK_ARG(long, va_arg(args, long));
+            break;
+        case RP_LOG_ARG_LLONG:
+            RP_LOG_PACK_ARG(long long, va_arg(args, long long));
+            break;
+        case RP_LOG_ARG_SIZE:
+            RP_LOG_PACK_ARG(size_t, va_arg(args, size_t));
+            break;
+        case RP_LOG_ARG_DOUBLE:
+            RP_LOG_PACK_ARG(double, va_arg(args, double));
+            break;
+        case RP_LOG_ARG_PTR:
+            RP_LOG_PACK_ARG(const void *, va_arg(args, const void *));
+            break;
+        case RP_LOG_ARG_STR:
+        {
+            // 字符串可能位于调用者栈上，必须按值拷贝
+            const char *str = va_arg(args, const char *);
+            uint8_t n = 0;
+            if (str == NULL)
+            {
+                str = "(null)";
+            }
+            while (n < RP_LOG_DEFER_STR_MAX && str[n] != '\0')
+            {
+                n++;
+            }
+            if (len + 1 + n > size)
+            {
+                return len;
+            }
+            dst[len++] = n;
+            memcpy(dst + len, str, n);
+            len += n;
+            break;
+        }
+        case RP_LOG_ARG_NONE:
+        default:
+            break;
+        }
+    }
+
+    return len;
+}
+
+// 从参数区取出一个参数，数据不足时结束格式化
+#define RP_LOG_UNPACK_ARG(var_)                      \
+    do                                               \
+    {                                                \
+        if (pos + sizeof(var_) > args_len)           \
+        {                                            \
+            goto out;                                \
+        }                                            \
+        memcpy(&(var_), args + pos, sizeof(var_));   \
+        pos += sizeof(var_);                         \
+    } while (0)
+
+#if RP_LOG_NEED_TEXT
+#if !RP_LOG_USE_LITE_FORMAT
+// 使用 snprintf 输出单个参数（按解析结果重建说明符，'*' 替换为实际数值）
+static void RP_Log_SnprintfArg(RP_LogOut_t *out, const RP_LogSpec_t *spec, const RP_LogArg_t *arg)
+{
+    char fmt[32];
+    int f = 0;
+    int n = 0;
+    int prec = spec->prec;
+    char *buf = out->buf + out->len;
+    int size = out->size - out->len;
+
+    // 参数区中的字符串不以 '\0' 结尾，用精度限制读取长度
+    if (spec->type == RP_LOG_ARG_STR && (prec < 0 || prec > arg->str_len))
+    {
+        prec = arg->str_len;
+    }
+
+    fmt[f++] = '%';
+    if (spec->flags & RP_LOG_FLAG_LEFT)
+        fmt[f++] = '-';
+    if (spec->flags & RP_LOG_FLAG_PLUS)
+        fmt[f++] = '+';
+    if (spec->flags & RP_LOG_FLAG_SPACE)
+        fmt[f++] = ' ';
+    if (spec->flags & RP_LOG_FLAG_ALT)
+        fmt[f++] = '#';
+    if (spec->flags & RP_LOG_FLAG_ZERO)
+        fmt[f++] = '0';
+    if (spec->width > 0)
+    {
+        f += snprintf(fmt + f, sizeof(fmt) - f, "%d", spec->width);
+    }
+    if (prec >= 0)
+    {
+        f += snprintf(fmt + f, sizeof(fmt) - f, ".%d", prec);
+    }
+    switch (spec->type)
+    {
+    case RP_LOG_ARG_INT:
+        if (spec->half >= 1)
+            fmt[f++] = 'h';
+        if (spec->half >= 2)
+            fmt[f++] = 'h';
+        break;
+    case RP_LOG_ARG_LONG:
+        fmt[f++] = 'l';
+        break;
+    case RP_LOG_ARG_LLONG:
+        fmt[f++] = 'l';
+        fmt[f++] = 'l';
+        break;
+    case RP_LOG_ARG_SIZE:
+        fmt[f++] = 'z';
+        break;
+    default:
+        break;
+    }
+    fmt[f++] = spec->conv;
+    fmt[f] = '\0';
+
+    switch (spec->type)
+    {
+    case RP_LOG_ARG_INT:
+        n = snprintf(buf, size, fmt, (int)arg->v.i);
+        break;
+    case RP_LOG_ARG_LONG:
+        n = snprintf(buf, size, fmt, (long)arg->v.i);
+        break;
+    case RP_LOG_ARG_LLONG:
+        n = snprintf(buf, size, fmt, arg->v.i);
+        break;
+    case RP_LOG_ARG_SIZE:
+        n = snprintf(buf, size, fmt, (size_t)arg->v.i);
+        break;
+    case RP_LOG_ARG_DOUBLE:
+        n = snprintf(buf, size, fmt, arg->v.f);
+        break;
+    case RP_LOG_ARG_STR:
+        n = snprintf(buf, size, fmt, (const char *)arg->v.p);
+        break;
+    case RP_LOG_ARG_PTR:
+        if (spec->conv == 'p') // 不支持 %n
+        {
+            n = snprintf(buf, size, fmt, arg->v.p);
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (n > 0)
+    {
+        out->len += (n < size) ? n : size - 1;
+    }
+}
+#endif
+
+// 使用打包参数格式化（与写入时相同的顺序逐个取出参数），返回写入长度
+static int RP_Log_FormatArgs(char *buf, int size, const char *format, const uint8_t *args, uint16_t args_len)
+{
+    RP_LogOut_t out = {buf, size, 0};
+    uint16_t pos = 0;
+    const char *p = format;
+    RP_LogSpec_t spec;
+    RP_LogArg_t arg;
+
+    while (*p != '\0' && out.len < size - 1)
+    {
+        // 普通字符
+        if (*p != '%')
+        {
+            buf[out.len++] = *p++;
+            continue;
+        }
+
+        p = RP_Log_ParseSpec(p, &spec);
+        if (spec.type == RP_LOG_ARG_NONE)
+        {
+            if (spec.conv == '%')
+            {
+                buf[out.len++] = '%';
+            }
+            continue;
+        }
+
+        // '*' 宽度和精度
+        if (spec.width_star)
+        {
+            int width;
+            RP_LOG_UNPACK_ARG(width);
+            if (width < 0)
+            {
+                spec.flags |= RP_LOG_FLAG_LEFT;
+                width = -width;
+            }
+            spec.width = (int16_t)(width > 1000 ? 1000 : width);
+        }
+        if (spec.prec_star)
+        {
+            int prec;
+            RP_LOG_UNPACK_ARG(prec);
+            spec.prec = (int16_t)(prec < 0 ? -1 : (prec > 1000 ? 1000 : prec));
+        }
+
+        arg.str_len = -1;
+        switch (spec.type)
+        {
+        case RP_LOG_ARG_INT:
+        {
+            int v;
+            RP_LOG_UNPACK_ARG(v);
+            arg.v.i = v;
+            break;
+        }
+        case RP_LOG_ARG_LONG:
+        {
+            long v;
+            RP_LOG_UNPACK_ARG(v);
+            arg.v.i = v;
+            break;
+        }
+        case RP_LOG_ARG_LLONG:
+            RP_LOG_UNPACK_ARG(arg.v.i);
+            break;
+        case RP_LOG_ARG_SIZE:
+        {
+            size_t v;
+            RP_LOG_UNPACK_ARG(v);
+            arg.v.i = (long long)v;
+            break;
+        }
+        case RP_LOG_ARG_DOUBLE:
+            RP_LOG_UNPACK_ARG(arg.v.f);
+            break;
+        case RP_LOG_ARG_PTR:
+            RP_LOG_UNPACK_ARG(arg.v.p);
+            break;
+        case RP_LOG_ARG_STR:
+        {
+            uint8_t str_len;
+            RP_LOG_UNPACK_ARG(str_len);
+            if (pos + str_len > args_len)
+            {
+                goto out;
+            }
+            arg.v.p = args + pos;
+            arg.str_len = str_len;
+            pos += str_len;
+            break;
+        }
+        default:
+            continue;
+        }
+
+#if RP_LOG_USE_LITE_FORMAT
+        RP_Log_LiteArg(&out, &spec, &arg);
+#else
+        RP_Log_SnprintfArg(&out, &spec, &arg);
+#endif
+    }
+
+out:
+    if (out.len > size - 1)
+    {
+        out.len = size - 1;
+    }
+    return out.len;
+}
+#endif
+
+// 写入延迟格式化记录（只拷贝参数，不格式化）
+static int RP_Log_WriteDeferred(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line,
+                                const char *format, va_list args)
+{
+    uint8_t record[sizeof(RP_LogDeferredHdr_t) + RP_LOG_DEFER_ARG_MAX];
+    RP_LogDeferredHdr_t hdr;
+
+    hdr.file = file;
+    hdr.format = format;
+    hdr.timestamp = RP_Log_GetTimestamp();
+    hdr.line = (uint16_t)line;
+    hdr.level = (uint8_t)level;
+    hdr.args_len = (uint8_t)RP_Log_PackArgs(record + sizeof(hdr), RP_LOG_DEFER_ARG_MAX, format, args);
+    memcpy(record, &hdr, sizeof(hdr));
+
+    return RP_Log_Push(log, record, (uint16_t)(sizeof(hdr) + hdr.args_len), RP_LOG_ENTRY_DEFERRED, hdr.level);
+}
+
+// 写入参数已打包（不超过 RP_LOG_DEFER_ARG_MAX）的延迟格式化记录，记录头和参数分别拷入预留的空间，返回值同 RB_Push
+static int RP_Log_PushDeferred(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line, const char *format,
+                               const uint8_t *args, uint16_t length)
+{
+    RP_LogDeferredHdr_t hdr;
+
+    hdr.file = file;
+    hdr.format = format;
+    hdr.timestamp = RP_Log_GetTimestamp();
+    hdr.line = (uint16_t)line;
+    hdr.level = (uint8_t)level;
+    hdr.args_len = (uint8_t)length;
+
+    uint16_t total = (uint16_t)(sizeof(hdr) + length);
+    uint32_t index;
+    RP_LogRingBuffer_t *rb = RP_Log_Reserve(log, hdr.level, total, &index);
+    if (rb == NULL)
+    {
+        return -1;
+    }
+    RB_CopyIn(rb, RB_DATA_POS(index), (const uint8_t *)&hdr, sizeof(hdr));
+    if (length != 0) // 没有参数时 args 可以为 NULL
+    {
+        RB_CopyIn(rb, (uint16_t)(RB_DATA_POS(index) + sizeof(hdr)), args, length);
+    }
+    return RB_Publish(rb, index, total, RP_LOG_ENTRY_DEFERRED, hdr.level);
+}
+
+#if RP_LOG_NEED_TEXT
+// 将延迟格式化记录格式化为完整日志行，返回行长度
+static uint16_t RP_Log_FormatDeferred(RP_Log_t *log, const uint8_t *record, uint16_t length, uint8_t *buffer)
+{
+    RP_LogDeferredHdr_t hdr;
+    int len = 0;
+
+    if (length < sizeof(hdr))
+    {
+        return 0;
+    }
+    memcpy(&hdr, record, sizeof(hdr));
+    if (hdr.level > RP_LOG_LEVEL_TRACE || sizeof(hdr) + hdr.args_len > length)
+    {
+        return 0;
+    }
+
+    // 时间戳
+    if (log->config_param.use_timestamp)
+    {
+        len += RP_Log_FormatTimestamp((char *)buffer + len, RP_LOG_ENTRY_MAX_SIZE - len, hdr.timestamp);
+    }
+
+    // 等级和位置
+    len += RP_Log_Format((char *)buffer + len, RP_LOG_ENTRY_MAX_SIZE - len,
+                         "[%s][%s:%d]: ", g_level_names[hdr.level], hdr.file, hdr.line);
+    if (len >= RP_LOG_ENTRY_MAX_SIZE - 2)
+    {
+        len = RP_LOG_ENTRY_MAX_SIZE - 3;
+    }
+
+    // 用户内容
+    len += RP_Log_FormatArgs((char *)buffer + len, RP_LOG_ENTRY_MAX_SIZE - 2 - len,
+                             hdr.format, record + sizeof(hdr), hdr.args_len);
+
+    // 换行
+    buffer[len++] = '\r';
+    buffer[len++] = '\n';
+
+    return (uint16_t)len;
+}
+#endif
+
+// 按输出的格式处理一条延迟记录（二进制帧或文本行），写入 buffer，返回长度
+// 每个输出各自格式化一次，文本输出和二进制输出可以同时存在
+static uint16_t RP_Log_FormatRecord(RP_Log_t *log, RP_LogSink_t *sink, const uint8_t *record, uint16_t length,
+                                    uint8_t *buffer)
+{
+#if RP_LOG_USE_BINARY
+#if RP_LOG_NEED_TEXT
+    if (!sink->text)
+#endif
+    {
+        return RP_Log_EncodeRecord(sink, record, length, buffer);
+    }
+#endif
+#if RP_LOG_NEED_TEXT
+    (void)sink;
+    return RP_Log_FormatDeferred(log, record, length, buffer);
+#else
+    (void)log;
+#endif
+}
+#endif
+
+#if RP_LOG_NEED_FRAME
+// CRC16-CCITT（多项式 0x1021，初值 0xFFFF），半字节查表
+static uint16_t RP_Log_Crc16(uint16_t crc, const uint8_t *data, uint16_t length)
+{
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+    while (length--)
+    {
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (*data >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (*data & 0x0F)]);
+        data++;
+    }
+    return crc;
+}
+
+// 写入一个字节，帧内的 0x00、'\n'、'\r'、转义符和同步字节需转义
+#define RP_LOG_FRAME_PUT(byte_)                                                  \
+    do                                                                           \
+    {                                                                            \
+        uint8_t b_ = (byte_);                                                    \
+        if (b_ == 0x00 || b_ == '\n' || b_ == '\r' || b_ == RP_LOG_FRAME_ESC ||  \
+            b_ == RP_LOG_FRAME_SYNC)                                             \
+        {                                                                        \
+            buffer[len++] = RP_LOG_FRAME_ESC;                                    \
+            b_ ^= RP_LOG_FRAME_ESC_XOR;                                          \
+        }                                                                        \
+        buffer[len++] = b_;                                                      \
+    } while (0)
+
+// 封装一帧：同步字节 | 类型 | 序号(2) | 负载 | CRC16(2) | "\r\n"，返回帧长度
+// 类型到 CRC 之间的字节经过转义，帧内不会出现换行，TF_Log 模块仍按行记录
+static uint16_t RP_Log_EncodeFrame(uint16_t *seq, uint8_t type, const uint8_t *payload, uint16_t length, uint8_t *buffer)
+{
+    uint8_t head[3];
+    uint16_t len = 0;
+
+    head[0] = type;
+    head[1] = (uint8_t)*seq;
+    head[2] = (uint8_t)(*seq >> 8);
+    (*seq)++;
+
+    uint16_t crc = RP_Log_Crc16(0xFFFF, head, sizeof(head));
+    crc = RP_Log_Crc16(crc, payload, length);
+
+    buffer[len++] = RP_LOG_FRAME_SYNC;
+    for (uint16_t i = 0; i < sizeof(head); i++)
+    {
+        RP_LOG_FRAME_PUT(head[i]);
+    }
+    for (uint16_t i = 0; i < length; i++)
+    {
+        RP_LOG_FRAME_PUT(payload[i]);
+    }
+    RP_LOG_FRAME_PUT((uint8_t)crc);
+    RP_LOG_FRAME_PUT((uint8_t)(crc >> 8));
+    buffer[len++] = '\r';
+    buffer[len++] = '\n';
+
+    return len;
+}
+#endif
+
+#if RP_LOG_USE_COMPRESS
+// 三字节哈希，取乘积的高位
+#define RP_LOG_LZ_HASH(p_)                                                                  \
+    ((uint16_t)((uint32_t)(((uint32_t)(p_)[0] | ((uint32_t)(p_)[1] << 8) | ((uint32_t)(p_)[2] << 16)) * \
+                           2654435761UL) >> (32 - RP_LOG_COMPRESS_HASH_BITS)))
+
+// 将一块数据（不超过 RP_LOG_COMPRESS_BLOCK_SIZE）压缩为一个压缩帧写入 sink->tx_buffer，返回帧长度
+// LZSS：每个控制字节的 8 位依次说明后面 8 项（0=字面量 1 字节，1=匹配 2 字节：距离-1 | (长度-3) << 窗口位数）
+// data 可以就是 tx_buffer：先拷入窗口再输出；压缩块写在 tx_buffer 末尾，封装帧时从头部写，转义后也追不上读取位置
+static uint16_t RP_Log_Compress(RP_Log_t *log, RP_LogSink_t *sink, const uint8_t *data, uint16_t length)
+{
+    RP_LogCompress_t *c = sink->compress;
+    uint8_t *payload = sink->tx_buffer + RP_LOG_TX_BUFFER_SIZE - RP_LOG_LZ_PAYLOAD_MAX;
+    uint8_t *win = c->window;
+    uint16_t len = 0;
+
+    // 定期重置：解码器丢帧后从下一个重置块恢复
+    payload[len++] = RP_LOG_COMPRESS_WINDOW_BITS;
+    if (c->blocks == 0)
+    {
+        c->history = 0;
+        memset(c->hash, 0, sizeof(c->hash));
+        payload[0] |= RP_LOG_LZ_RESET;
+    }
+    if (++c->blocks >= RP_LOG_COMPRESS_RESET_BLOCKS)
+    {
+        c->blocks = 0;
+    }
+
+    memcpy(win + c->history, data, length);
+    uint16_t end = c->history + length;
+    uint16_t ctrl = 0;
+    uint8_t bit = 8;
+
+    for (uint16_t pos = c->history; pos < end;)
+    {
+        uint16_t match_len = 0;
+        uint16_t match_off = 0;
+
+        if (bit == 8)
+        {
+            ctrl = len;
+            payload[len++] = 0;
+            bit = 0;
+        }
+
+        // 只比较哈希表中的最近一个位置，以少量压缩率换取每字节常数时间
+        if (end - pos >= 3)
+        {
+            uint16_t h = RP_LOG_LZ_HASH(win + pos);
+            uint16_t cand = c->hash[h];
+            c->hash[h] = pos + 1;
+            if (cand != 0 && (uint16_t)(pos - (cand - 1)) <= RP_LOG_LZ_WINDOW)
+            {
+                uint16_t from = cand - 1;
+                uint16_t max = end - pos;
+                if (max > RP_LOG_LZ_MATCH_MAX)
+                {
+                    max = RP_LOG_LZ_MATCH_MAX;
+                }
+                while (match_len < max && win[from + match_len] == win[pos + match_len])
+                {
+                    match_len++;
+                }
+                match_off = pos - from;
+            }
+        }
+
+        if (match_len >= 3)
+        {
+            uint16_t v = (uint16_t)((match_off - 1) | ((match_len - 3) << RP_LOG_COMPRESS_WINDOW_BITS));
+            payload[ctrl] |= (uint8_t)(1U << bit);
+            payload[len++] = (uint8_t)v;
+            payload[len++] = (uint8_t)(v >> 8);
+
+            // 匹配覆盖的位置也记入哈希表，后续重复的行能找到更近的匹配
+            for (uint16_t k = 1; k < match_len && pos + k + 3 <= end; k++)
+            {
+                c->hash[RP_LOG_LZ_HASH(win + pos + k)] = pos + k + 1;
+            }
+            pos += match_len;
+        }
+        else
+        {
+            payload[len++] = win[pos++];
+        }
+        bit++;
+    }
+
+    // 保留最近一个窗口的数据作为下一块的历史
+    if (end > RP_LOG_LZ_WINDOW)
+    {
+        uint16_t shift = end - RP_LOG_LZ_WINDOW;
+        memmove(win, win + shift, RP_LOG_LZ_WINDOW);
+        for (uint16_t i = 0; i < (1U << RP_LOG_COMPRESS_HASH_BITS); i++)
+        {
+            c->hash[i] = (c->hash[i] > shift) ? (uint16_t)(c->hash[i] - shift) : 0;
+        }
+        end = RP_LOG_LZ_WINDOW;
+    }
+    c->history = end;
+
+    uint16_t frame = RP_Log_EncodeFrame(&c->seq, RP_LOG_FRAME_LZ, payload, len, sink->tx_buffer);
+#if RP_LOG_USE_STATS
+    log->stats.compress_in += length;
+    log->stats.compress_out += frame;
+#else
+    (void)log;
+#endif
+    return frame;
+}
+#endif
+
+#if RP_LOG_USE_BINARY
+// 按小端写入 n 字节
+#define RP_LOG_FRAME_LE(value_, n_)                                   \
+    do                                                                \
+    {                                                                 \
+        for (uint8_t i_ = 0; i_ < (n_); i_++)                         \
+        {                                                             \
+            payload[len++] = (uint8_t)((uint64_t)(value_) >> (8 * i_)); \
+        }                                                             \
+    } while (0)
+
+// 将延迟格式化记录封装为记录帧，返回帧长度
+// 负载：等级(1) | 行号(2) | 时间戳(4，DWT 为 8) | 文件名地址(4) | 格式串地址(4) | 打包参数
+// 文件名和格式串只传地址，由上位机从 ELF 中查找字符串
+static uint16_t RP_Log_EncodeRecord(RP_LogSink_t *sink, const uint8_t *record, uint16_t length, uint8_t *buffer)
+{
+    RP_LogDeferredHdr_t hdr;
+    uint8_t payload[RP_LOG_FRAME_PAYLOAD_MAX];
+    uint16_t len = 0;
+
+    if (length < sizeof(hdr))
+    {
+        return 0;
+    }
+    memcpy(&hdr, record, sizeof(hdr));
+    if (hdr.level > RP_LOG_LEVEL_TRACE || sizeof(hdr) + hdr.args_len > length)
+    {
+        return 0;
+    }
+
+    payload[len++] = hdr.level;
+    RP_LOG_FRAME_LE(hdr.line, 2);
+    RP_LOG_FRAME_LE(hdr.timestamp, sizeof(hdr.timestamp));
+    RP_LOG_FRAME_LE((uintptr_t)hdr.file, 4);
+    RP_LOG_FRAME_LE((uintptr_t)hdr.format, 4);
+    memcpy(payload + len, record + sizeof(hdr), hdr.args_len);
+    len += hdr.args_len;
+
+    return RP_Log_EncodeFrame(&sink->tx_seq, (sizeof(hdr.timestamp) == 8) ? (RP_LOG_FRAME_RECORD | RP_LOG_FRAME_TICK64) : RP_LOG_FRAME_RECORD,
+                              payload, len, buffer);
+}
+#endif
+
+#if RP_LOG_USE_RTT
+// RTT 输出（g_rp_log_rtt，batch_max 为 0，每次一行）：颜色只包裹头部，头部以 "]: " 结尾
+// 分段写入期间持有 RTT 锁，其他代码同时使用 RTT 时各行不会交错
+static int RP_Log_RttTransmit(RP_LogSink_t *sink, const uint8_t *data, uint16_t length)
+{
+    uint16_t hdr_len = 0;
+
+    for (uint16_t i = 0; i + 2 < length; i++)
+    {
+        if (data[i] == ']' && data[i + 1] == ':' && data[i + 2] == ' ')
+        {
+            hdr_len = i + 3;
+            break;
+        }
+    }
+
+    SEGGER_RTT_LOCK();
+    if (g_rp_log.config_param.rtt_use_color && hdr_len != 0 && sink->level <= RP_LOG_LEVEL_TRACE)
+    {
+        SEGGER_RTT_WriteNoLock(0, g_level_colors[sink->level], strlen(g_level_colors[sink->level]));
+        SEGGER_RTT_WriteNoLock(0, data, hdr_len);
+        SEGGER_RTT_WriteNoLock(0, RP_LOG_COLOR_RESET, sizeof(RP_LOG_COLOR_RESET) - 1);
+        SEGGER_RTT_WriteNoLock(0, data + hdr_len, length - hdr_len);
+    }
+    else
+    {
+        SEGGER_RTT_WriteNoLock(0, data, length);
+    }
+    SEGGER_RTT_UNLOCK();
+
+    return 0;
+}
+#endif
+
+// 格式化丢弃提示行（与普通日志格式一致，便于上位机按行解析），返回行长度
+static uint16_t RP_Log_FormatDropped(RP_Log_t *log, RP_LogSink_t *sink, uint8_t *buffer, uint32_t count)
+{
+#if RP_LOG_USE_BINARY
+#if RP_LOG_NEED_TEXT
+    if (!sink->text)
+#endif
+    {
+        // 丢弃帧负载：丢弃条数(4)
+        uint8_t payload[4] = {(uint8_t)count, (uint8_t)(count >> 8), (uint8_t)(count >> 16), (uint8_t)(count >> 24)};
+        (void)log;
+        return RP_Log_EncodeFrame(&sink->tx_seq, RP_LOG_FRAME_DROPPED, payload, sizeof(payload), buffer);
+    }
+#endif
+#if RP_LOG_NEED_TEXT
+    int len = 0;
+
+    (void)sink;
+
+    // 时间戳
+    if (log->config_param.use_timestamp)
+    {
+        len += RP_Log_FormatTimestamp((char *)buffer + len, RP_LOG_TX_BUFFER_SIZE - len, RP_Log_GetTimestamp());
+    }
+
+    len += RP_Log_Format((char *)buffer + len, RP_LOG_TX_BUFFER_SIZE - len,
+                         "[%s][%s:%d]: %lu messages dropped", g_level_names[RP_LOG_LEVEL_WARN],
+                         RP_LOG_SELF_FILE, RP_LOG_SELF_LINE, (unsigned long)count);
+
+    // 溢出保护
+    if (len >= RP_LOG_TX_BUFFER_SIZE - 2)
+    {
+        len = RP_LOG_TX_BUFFER_SIZE - 3;
+    }
+
+    buffer[len++] = '\r';
+    buffer[len++] = '\n';
+
+    return (uint16_t)len;
+#endif
+}
+
+/**
+ * @brief  展开原始数据记录从 sink->data_sent 开始的一行（二进制帧模式下为一帧）写入 buffer
+ * @param  log: 日志模块实例指针
+ * @param  sink: 输出
+ * @param  record: 原始数据记录（记录头 + 数据）
+ * @param  length: 记录长度
+ * @param  buffer: 输出缓冲区
+ * @param  size: buffer 可用字节数
+ * @param  fit: 1=放不下整行时缩短本行（buffer 为空时），0=返回 -1 留到下一次
+ * @retval 写入的字节数，-1=放不下；整条展开完后 data_sent 归零，调用者再前进读指针
+ */
+static int RP_Log_FormatData(RP_Log_t *log, RP_LogSink_t *sink, const uint8_t *record, uint16_t length,
+                             uint8_t *buffer, uint16_t size, uint8_t fit)
+{
+    RP_LogDataHdr_t hdr;
+
+    if (length < sizeof(hdr))
+    {
+        sink->data_sent = 0;
+        return 0;
+    }
+    memcpy(&hdr, record, sizeof(hdr));
+
+    const uint8_t *data = record + sizeof(hdr);
+    uint16_t total = (uint16_t)(length - sizeof(hdr));
+    uint16_t offset = sink->data_sent;
+    uint16_t n = total - offset;
+    if (hdr.level > RP_LOG_LEVEL_TRACE || offset > total)
+    {
+        sink->data_sent = 0;
+        return 0;
+    }
+
+    // 每行（二进制帧模式下每帧）的字节数，解码后与文本输出的行相同
+    uint8_t raw = (hdr.kind & RP_LOG_DATA_RAW) != 0;
+    uint16_t per_line = raw ? RP_LOG_HEX_LINE_BYTES * 3 : RP_LOG_HEX_LINE_BYTES;
+
+#if RP_LOG_USE_BINARY
+#if RP_LOG_NEED_TEXT
+    if (!sink->text)
+#endif
+    {
+        // 数据帧负载：等级(1) | 行号(2) | 时间戳(4/8) | 文件名地址(4) | 方式(1) | 偏移(2) | 数据
+        // 与文本输出相同按行分帧，每帧最多 per_line 字节（且不超过 RP_LOG_DEFER_ARG_MAX）
+        uint8_t payload[RP_LOG_FRAME_PAYLOAD_MAX];
+        uint16_t len = 0;
+        uint8_t kind = hdr.kind;
+
+        (void)log;
+        (void)fit;
+        if (size < RP_LOG_TX_UNIT_SIZE)
+        {
+            return -1;
+        }
+        if (per_line > RP_LOG_DEFER_ARG_MAX)
+        {
+            per_line = RP_LOG_DEFER_ARG_MAX;
+        }
+        if (n > per_line)
+        {
+            n = per_line;
+        }
+        if (total > per_line)
+        {
+            kind |= RP_LOG_DATA_SPLIT;
+        }
+        if (offset + n < total)
+        {
+            kind &= (uint8_t)~RP_LOG_DATA_CUT;
+        }
+
+        payload[len++] = hdr.level;
+        RP_LOG_FRAME_LE(hdr.line, 2);
+        RP_LOG_FRAME_LE(hdr.timestamp, sizeof(hdr.timestamp));
+        RP_LOG_FRAME_LE((uintptr_t)hdr.file, 4);
+        payload[len++] = kind;
+        RP_LOG_FRAME_LE(offset, 2);
+        memcpy(&payload[len], data + offset, n);
+        len += n;
+
+        sink->data_sent = (offset + n < total) ? (uint16_t)(offset + n) : 0;
+        return RP_Log_EncodeFrame(&sink->tx_seq, (sizeof(hdr.timestamp) == 8) ? (RP_LOG_FRAME_DATA | RP_LOG_FRAME_TICK64) : RP_LOG_FRAME_DATA,
+                                  payload, len, buffer);
+    }
+#endif
+#if RP_LOG_NEED_TEXT
+    static const char hex[] = "0123456789ABCDEF";
+    char *out = (char *)buffer;
+    int len = 0;
+
+    // 行头至少留 16 字节给数据和结尾
+    if (size < 32)
+    {
+        return -1;
+    }
+    if (log->config_param.use_timestamp)
+    {
+        len += RP_Log_FormatTimestamp(out + len, size - len, hdr.timestamp);
+    }
+    len += RP_Log_Format(out + len, size - len, "[%s][%s:%d]: ", g_level_names[hdr.level], hdr.file, hdr.line);
+    if (total > per_line)
+    {
+        len += RP_Log_Format(out + len, size - len, "%04X: ", offset);
+    }
+    if (len > size - 16)
+    {
+        if (!fit)
+        {
+            return -1;
+        }
+        len = size - 16;
+    }
+
+    // 本行字节数：每行 per_line 字节，末尾留 " ..." 和 "\r\n"
+    uint16_t room = (uint16_t)((size - len - 6) / (raw ? 1 : 3));
+    if (n > per_line)
+    {
+        n = per_line;
+    }
+    if (n > room)
+    {
+        if (!fit)
+        {
+            return -1;
+        }
+        n = (room >= 8) ? (uint16_t)(room & ~7U) : room; // 缩短的行按 8 字节对齐，偏移便于对照
+    }
+
+    for (uint16_t i = 0; i < n; i++)
+    {
+        uint8_t b = data[offset + i];
+        if (raw)
+        {
+            out[len++] = (b >= 0x20 && b < 0x7F) ? (char)b : '.';
+        }
+        else
+        {
+            if (i != 0)
+            {
+                out[len++] = ' ';
+            }
+            out[len++] = hex[b >> 4];
+            out[len++] = hex[b & 0x0F];
+        }
+    }
+
+    offset += n;
+    if (offset >= total && (hdr.kind & RP_LOG_DATA_CUT))
+    {
+        memcpy(out + len, " ...", 4);
+        len += 4;
+    }
+    out[len++] = '\r';
+    out[len++] = '\n';
+
+    sink->data_sent = (offset < total) ? offset : 0;
+    return len;
+#endif
+}
+
+/**
+ * @brief  展开采样记录从第 sink->data_sent 个变量开始的一行（二进制帧模式下为变量表帧或采样帧）写入 buffer
+ * @param  log: 日志模块实例指针
+ * @param  sink: 输出
+ * @param  record: 采样记录（记录头 + 各变量原始值）
+ * @param  length: 记录长度
+ * @param  buffer: 输出缓冲区
+ * @param  size: buffer 可用字节数
+ * @param  fit: 1=放不下时在变量之间换行、第一个变量也放不下时截断（buffer 为空时），0=放不下剩余变量时返回 -1 留到下一次
+ * @retval 写入的字节数，-1=放不下；整条展开完后 data_sent 归零，调用者再前进读指针
+ * @note   变量只追加注册，记录中的前 count 个变量即采样时的变量表
+ */
+static int RP_Log_FormatSample(RP_Log_t *log, RP_LogSink_t *sink, const uint8_t *record, uint16_t length,
+                               uint8_t *buffer, uint16_t size, uint8_t fit)
+{
+#if RP_LOG_USE_TELEMETRY
+    RP_LogSampleHdr_t hdr;
+
+    if (length < sizeof(hdr))
+    {
+        sink->data_sent = 0;
+        return 0;
+    }
+    memcpy(&hdr, record, sizeof(hdr));
+
+    // 复位后找回的记录可能早于本次启动的注册，与当前变量表对不上时丢弃
+    const uint8_t *values = record + sizeof(hdr);
+    uint16_t total = 0;
+    if (hdr.count > log->var_count || sink->data_sent > hdr.count)
+    {
+        sink->data_sent = 0;
+        return 0;
+    }
+    for (uint8_t i = 0; i < hdr.count; i++)
+    {
+        total += g_var_sizes[log->vars[i].type];
+    }
+    if (total != length - sizeof(hdr))
+    {
+        sink->data_sent = 0;
+        return 0;
+    }
+
+#if RP_LOG_USE_BINARY
+#if RP_LOG_NEED_TEXT
+    if (!sink->text)
+#endif
+    {
+        uint8_t payload[RP_LOG_FRAME_PAYLOAD_MAX];
+        uint16_t len = 0;
+
+        (void)fit;
+        if (size < RP_LOG_TX_UNIT_SIZE)
+        {
+            return -1;
+        }
+
+        // 变量表变化或每 RP_LOG_TELEMETRY_SCHEMA_PERIOD 次采样先发变量表帧（上位机中途接入也能解析），data_sent=1 表示已发
+        if (sink->data_sent == 0 && (hdr.count != sink->tel_count || sink->tel_since >= RP_LOG_TELEMETRY_SCHEMA_PERIOD))
+        {
+            // 变量表帧负载：变量数(1) | 各变量 类型(1) + 变量名地址(4)
+            payload[len++] = hdr.count;
+            for (uint8_t i = 0; i < hdr.count; i++)
+            {
+                payload[len++] = log->vars[i].type;
+                RP_LOG_FRAME_LE((uintptr_t)log->vars[i].name, 4);
+            }
+            sink->tel_count = hdr.count;
+            sink->tel_since = 0;
+            sink->data_sent = 1;
+            return RP_Log_EncodeFrame(&sink->tx_seq, RP_LOG_FRAME_SCHEMA, payload, len, buffer);
+        }
+
+        // 采样帧负载：等级(1) | 采样序号(2) | 时间戳(4/8) | 变量数(1) | 各变量原始值
+        payload[len++] = RP_LOG_TELEMETRY_LEVEL;
+        RP_LOG_FRAME_LE(hdr.seq, 2);
+        RP_LOG_FRAME_LE(hdr.timestamp, sizeof(hdr.timestamp));
+        payload[len++] = hdr.count;
+        memcpy(&payload[len], values, total);
+        len += total;
+
+        sink->tel_since++;
+        sink->data_sent = 0;
+        return RP_Log_EncodeFrame(&sink->tx_seq, (sizeof(hdr.timestamp) == 8) ? (RP_LOG_FRAME_SAMPLE | RP_LOG_FRAME_TICK64) : RP_LOG_FRAME_SAMPLE,
+                                  payload, len, buffer);
+    }
+#endif
+#if RP_LOG_NEED_TEXT
+    char *out = (char *)buffer;
+    uint8_t index = (uint8_t)sink->data_sent;
+    uint16_t pos = 0;
+    int len = 0;
+
+    // 行头至少留 16 字节给一个变量和结尾
+    if (size < 32)
+    {
+        return -1;
+    }
+    if (log->config_param.use_timestamp)
+    {
+        len += RP_Log_FormatTimestamp(out + len, size - len, hdr.timestamp);
+    }
+    len += RP_Log_Format(out + len, size - len, "[%s][%s:%d]: @tel %u", g_level_names[RP_LOG_TELEMETRY_LEVEL],
+                         RP_LOG_SELF_FILE, RP_LOG_SELF_LINE, (unsigned int)hdr.seq);
+    if (len > size - 16)
+    {
+        if (!fit)
+        {
+            return -1;
+        }
+        len = size - 16;
+    }
+
+    for (uint8_t i = 0; i < index; i++)
+    {
+        pos += g_var_sizes[log->vars[i].type];
+    }
+
+    // 一行放不下时在变量之间换行，续行的序号相同
+    uint8_t i = index;
+    while (i < hdr.count)
+    {
+        const RP_LogVar_t *var = &log->vars[i];
+        char value[24];
+        int n;
+        uint32_t raw = 0;
+
+        memcpy(&raw, values + pos, g_var_sizes[var->type]); // 原始值为小端
+        switch (var->type)
+        {
+        case RP_LOG_VAR_U8:
+            n = RP_Log_Format(value, sizeof(value), "%u", (unsigned int)(uint8_t)raw);
+            break;
+        case RP_LOG_VAR_I8:
+            n = RP_Log_Format(value, sizeof(value), "%d", (int)(int8_t)raw);
+            break;
+        case RP_LOG_VAR_U16:
+            n = RP_Log_Format(value, sizeof(value), "%u", (unsigned int)(uint16_t)raw);
+            break;
+        case RP_LOG_VAR_I16:
+            n = RP_Log_Format(value, sizeof(value), "%d", (int)(int16_t)raw);
+            break;
+        case RP_LOG_VAR_U32:
+            n = RP_Log_Format(value, sizeof(value), "%lu", (unsigned long)raw);
+            break;
+        case RP_LOG_VAR_I32:
+            n = RP_Log_Format(value, sizeof(value), "%ld", (long)(int32_t)raw);
+            break;
+        default:
+        {
+            float f;
+            memcpy(&f, &raw, sizeof(f));
+            n = RP_Log_Format(value, sizeof(value), "%.3f", (double)f);
+            break;
+        }
+        }
+        if (n < 0 || n > (int)sizeof(value) - 1)
+        {
+            n = (n < 0) ? 0 : (int)sizeof(value) - 1;
+        }
+
+        // " 变量名=值"，变量名过长时截断，保留值
+        char item[64];
+        int name_len = (int)strlen(var->name);
+        if (name_len > (int)sizeof(item) - 3 - n)
+        {
+            name_len = (int)sizeof(item) - 3 - n;
+        }
+        item[0] = ' ';
+        memcpy(item + 1, var->name, name_len);
+        item[1 + name_len] = '=';
+        memcpy(item + 2 + name_len, value, n);
+        n += 2 + name_len;
+
+        // 不是本行的开头时整条放不下就留到下一次，尽量一次采样一行
+        if (len + n + 2 > size)
+        {
+            if (!fit)
+            {
+                return -1;
+            }
+            if (i != index)
+            {
+                break;
+            }
+            n = size - len - 2;
+        }
+        memcpy(out + len, item, n);
+        len += n;
+        pos += g_var_sizes[var->type];
+        i++;
+    }
+    out[len++] = '\r';
+    out[len++] = '\n';
+
+    sink->data_sent = (i < hdr.count) ? i : 0;
+    return len;
+#endif
+#else
+    (void)log;
+    (void)record;
+    (void)length;
+    (void)buffer;
+    (void)size;
+    (void)fit;
+    sink->data_sent = 0;
+    return 0;
+#endif
+}
+
+// 按条目类型展开一段原始数据或采样记录（参数和返回值同 RP_Log_FormatData()）
+static int RP_Log_FormatExpand(RP_Log_t *log, RP_LogSink_t *sink, uint8_t type, const uint8_t *record,
+                               uint16_t length, uint8_t *buffer, uint16_t size, uint8_t fit)
+{
+    if (type == RP_LOG_ENTRY_SAMPLE)
+    {
+        return RP_Log_FormatSample(log, sink, record, length, buffer, size, fit);
+    }
+    return RP_Log_FormatData(log, sink, record, length, buffer, size, fit);
+}
+
+// 是否还有待处理的数据（含已预留未提交、尚未回收的条目，任一输出未报告的丢弃计数）
+static uint8_t RP_Log_IsPending(RP_Log_t *log)
+{
+    RP_LogRingBuffer_t *rb = log->ring_buffer;
+
+    if (RB_ENTRY_POS(rb->head) != RB_ENTRY_POS(rb->tail))
+    {
+        return 1;
+    }
+#if RP_LOG_USE_LANE
+    if (RB_ENTRY_POS(log->lane->head) != RB_ENTRY_POS(log->lane->tail))
+    {
+        return 1;
+    }
+#endif
+#if RP_LOG_USE_STAGE
+    for (uint32_t i = 0; i < log->stage_count; i++)
+    {
+        RP_LogStage_t *stage = log->stages[i];
+        if (stage != NULL && (RB_GetCount(stage->ring) != 0 || stage->dropped != stage->dropped_seen))
+        {
+            return 1;
+        }
+    }
+#endif
+    for (uint8_t id = 0; id < RP_LOG_SINK_MAX; id++)
+    {
+        RP_LogSink_t *sink = log->sinks[id];
+        if (sink != NULL && (rb->active & (1UL << id)) && (sink->dropped_seen != log->dropped || sink->lost != 0))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 输出范围对应的等级位掩码（第 n 位为等级 n）：FATAL_ONLY ~ ALL 依次多一个等级，无效值按 ALL 处理
+static uint8_t RP_Log_RangeMask(RP_LogOutputRange_t range)
+{
+    return ((unsigned)range < RP_LOG_OUTPUT_ALL) ? (uint8_t)((2U << range) - 1U) : 0x3F;
+}
+
+// 等级是否在 output_range 内
+static uint8_t RP_Log_LevelEnabled(RP_Log_t *log, RP_LogLevel_t level)
+{
+    return (RP_Log_RangeMask(log->config_param.output_range) >> level) & 1U;
+}
+
+// 调用位置状态使用的毫秒时间（0 表示尚未输出过，取 1 代替）
+static uint32_t RP_Log_SiteTime(void)
+{
+#if RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT
+    uint32_t ms = (uint32_t)(RP_Log_GetTimestamp() / (RP_LOG_DWT_FREQ_HZ / 1000UL));
+#else
+    uint32_t ms = (uint32_t)RP_Log_GetTimestamp();
+#endif
+    return (ms != 0) ? ms : 1;
+}
+
+// 输出本调用位置尚未报告的被抑制条数（format 含一个 %lu），沿用原日志的等级和位置
+static void RP_Log_SiteReport(RP_Log_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                              const char *format)
+{
+    if (site->suppressed == 0)
+    {
+        return;
+    }
+
+    uint32_t count = RB_AtomicSwap(&site->suppressed, 0);
+    if (count != 0)
+    {
+        RP_Log_Write(log, level, file, line, format, (unsigned long)count);
+    }
+}
+
+#if RP_LOG_USE_DEDUP
+// FNV-1a 摘要
+static uint32_t RP_Log_Hash(uint32_t hash, const void *data, uint16_t length)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    while (length-- != 0)
+    {
+        hash = (hash ^ *p++) * 16777619UL;
+    }
+    return hash;
+}
+
+// 取出一个参数并并入摘要
+#define RP_LOG_HASH_ARG(type_, value_)                \
+    do                                                \
+    {                                                 \
+        type_ v_ = (value_);                          \
+        hash = RP_Log_Hash(hash, &v_, sizeof(v_));    \
+    } while (0)
+
+// 按格式串依次取出可变参数计算摘要（不做任何格式化），字符串按内容计算
+static uint32_t RP_Log_HashArgs(const char *format, va_list args)
+{
+    uint32_t hash = 2166136261UL;
+    RP_LogSpec_t spec;
+    const char *p = format;
+
+    while ((p = strchr(p, '%')) != NULL)
+    {
+        p = RP_Log_ParseSpec(p, &spec);
+
+        if (spec.width_star)
+        {
+            RP_LOG_HASH_ARG(int, va_arg(args, int));
+        }
+        if (spec.prec_star)
+        {
+            RP_LOG_HASH_ARG(int, va_arg(args, int));
+        }
+
+        switch (spec.type)
+        {
+        case RP_LOG_ARG_INT:
+            RP_LOG_HASH_ARG(int, va_arg(args, int));
+            break;
+        case RP_LOG_ARG_LONG:
+            RP_LOG_HASH_ARG(long, va_arg(args, long));
+            break;
+        case RP_LOG_ARG_LLONG:
+            RP_LOG_HASH_ARG(long long, va_arg(args, long long));
+            break;
+        case RP_LOG_ARG_SIZE:
+            RP_LOG_HASH_ARG(size_t, va_arg(args, size_t));
+            break;
+        case RP_LOG_ARG_DOUBLE:
+            RP_LOG_HASH_ARG(double, va_arg(args, double));
+            break;
+        case RP_LOG_ARG_PTR:
+            RP_LOG_HASH_ARG(const void *, va_arg(args, const void *));
+            break;
+        case RP_LOG_ARG_STR:
+        {
+            const char *str = va_arg(args, const char *);
+            uint16_t n = 0;
+            if (str == NULL)
+            {
+                str = "(null)";
+            }
+            while (n < RP_LOG_ENTRY_MAX_SIZE && str[n] != '\0')
+            {
+                n++;
+            }
+            hash = RP_Log_Hash(hash, str, n + 1); // 连同结尾一起计算，分隔相邻字符串
+            break;
+        }
+        case RP_LOG_ARG_NONE:
+        default:
+            break;
+        }
+    }
+
+    return hash;
+}
+
+// 去重检查：与本调用位置上一条相同时只计数并返回 1，否则补报之前的重复次数、记下摘要并返回 0
+// 返回 0 后写入失败时调用者应清零 site->last_ms，下一条不算重复
+static uint8_t RP_Log_SiteRepeat(RP_Log_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                                 uint32_t hash)
+{
+    uint32_t now = RP_Log_SiteTime();
+    if (site->last_ms != 0 && site->hash == hash)
+    {
+        // 与上一条相同：只计数，持续重复时每 RP_LOG_DEDUP_REPORT_MS 输出一次重复次数
+        RB_AtomicAdd(&site->suppressed, 1);
+        RP_LOG_STATS_INC(log->stats.suppressed);
+        if (now - site->last_ms >= RP_LOG_DEDUP_REPORT_MS)
+        {
+            site->last_ms = now;
+            RP_Log_SiteReport(log, site, level, file, line, "last message repeated %lu times");
+        }
+        return 1;
+    }
+
+    // 参数变化：先补上之前的重复次数
+    RP_Log_SiteReport(log, site, level, file, line, "last message repeated %lu times");
+    site->hash = hash;
+    site->last_ms = now;
+    return 0;
+}
+#endif
+
+// 按等级预留空间（分段拷入的写入方使用），返回预留所在的缓冲区，失败返回 NULL
+// 已注册暂存区的任务只写自己的暂存区，暂存区满即失败（计入该任务的丢弃），其余规则见 RP_Log_ReserveRing()
+static RP_LogRingBuffer_t *RP_Log_Reserve(RP_Log_t *log, uint8_t level, uint16_t length, uint32_t *index)
+{
+#if RP_LOG_USE_STAGE
+    RP_LogStage_t *stage = RP_Log_StageSelf(log, level);
+    if (stage != NULL)
+    {
+        return RP_Log_StageReserve(stage, length, index);
+    }
+#endif
+    return RP_Log_ReserveRing(log, level, length, index);
+}
+
+// 在高优先级通道或主缓冲区预留空间（不经暂存区，work() 并入暂存区条目时也使用）
+// RP_LOG_LANE_LEVEL 及以上先在高优先级通道预留，通道满时改用主缓冲区，不因通道满而多丢一条
+// 主缓冲区满时按 DISCARD_OLDEST 丢弃最早的日志后重试一次（RP_Log_Evict()）
+static RP_LogRingBuffer_t *RP_Log_ReserveRing(RP_Log_t *log, uint8_t level, uint16_t length, uint32_t *index)
+{
+#if RP_LOG_USE_LANE
+    if (level <= RP_LOG_LANE_LEVEL && RB_Reserve(log->lane, length, index) == 0)
+    {
+        return log->lane;
+    }
+#else
+    (void)level;
+#endif
+    if (RB_Reserve(log->ring_buffer, length, index) == 0 ||
+        (RP_Log_Evict(log, length) == 0 && RB_Reserve(log->ring_buffer, length, index) == 0))
+    {
+        return log->ring_buffer;
+    }
+    return NULL;
+}
+
+// 按等级写入数据（规则同 RP_Log_Reserve()），返回值同 RB_Push
+static int RP_Log_Push(RP_Log_t *log, const uint8_t *data, uint16_t length, uint8_t type, uint8_t level)
+{
+#if RP_LOG_USE_STAGE
+    RP_LogStage_t *stage = RP_Log_StageSelf(log, level);
+    if (stage != NULL)
+    {
+        uint32_t index;
+        if (length > RP_LOG_ENTRY_MAX_SIZE)
+        {
+            length = RP_LOG_ENTRY_MAX_SIZE;
+        }
+        if (RP_Log_StageReserve(stage, length, &index) == NULL)
+        {
+            return -1;
+        }
+        RB_CopyIn(stage->ring, RB_DATA_POS(index), data, length);
+        return RB_Publish(stage->ring, index, length, type, level);
+    }
+#endif
+#if RP_LOG_USE_LANE
+    if (level <= RP_LOG_LANE_LEVEL)
+    {
+        int ret = RB_Push(log->lane, data, length, type, level);
+        if (ret >= 0)
+        {
+            return ret;
+        }
+    }
+#endif
+    int ret = RB_Push(log->ring_buffer, data, length, type, level);
+    if (ret < 0 && RP_Log_Evict(log, length) == 0)
+    {
+        ret = RB_Push(log->ring_buffer, data, length, type, level);
+    }
+    return ret;
+}
+
+#if RP_LOG_USE_STAGE
+// 当前任务的暂存区，中断中、未注册的任务返回 NULL
+// RP_LOG_USE_LANE 时 RP_LOG_LANE_LEVEL 及以上不经暂存区，直接写高优先级通道，不被本任务的低等级日志挤占
+static RP_LogStage_t *RP_Log_StageSelf(RP_Log_t *log, uint8_t level)
+{
+    uint32_t count = log->stage_count;
+
+#if RP_LOG_USE_LANE
+    if (level <= RP_LOG_LANE_LEVEL)
+    {
+        return NULL;
+    }
+#else
+    (void)level;
+#endif
+    if (count == 0 || RP_LOG_IN_ISR())
+    {
+        return NULL;
+    }
+
+    void *task = RP_LOG_TASK_SELF();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        RP_LogStage_t *stage = log->stages[i];
+        if (stage != NULL && stage->task == task)
+        {
+            return stage;
+        }
+    }
+    return NULL;
+}
+
+// 在暂存区预留空间并记下时间戳，返回暂存区，满时返回 NULL
+// 写者只有所属任务，CAS 总是一次成功；时间戳在提交之前写入，日志线程看到提交后再读取
+static RP_LogRingBuffer_t *RP_Log_StageReserve(RP_LogStage_t *stage, uint16_t length, uint32_t *index)
+{
+    RP_LogRingBuffer_t *rb = stage->ring;
+
+    if (RB_Reserve(rb, length, index) != 0)
+    {
+        return NULL;
+    }
+    stage->stamps[RB_ENTRY_POS(*index) & RB_ENTRY_MASK(rb)] = (uint32_t)RP_Log_GetTimestamp();
+    return rb;
+}
+
+// 报告各暂存区新增的丢弃条数（在 work() 中调用，提示行本身写入主缓冲区）
+static void RP_Log_StageReport(RP_Log_t *log)
+{
+    uint32_t count = log->stage_count;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        RP_LogStage_t *stage = log->stages[i];
+        if (stage == NULL)
+        {
+            continue;
+        }
+
+        uint32_t dropped = stage->dropped;
+        if (dropped != stage->dropped_seen)
+        {
+            RP_Log_Write(log, RP_LOG_LEVEL_WARN, RP_LOG_SELF_FILE, RP_LOG_SELF_LINE, "%lu messages dropped in %s",
+                         (unsigned long)(dropped - stage->dropped_seen), (stage->name != NULL) ? stage->name : "?");
+            stage->dropped_seen = dropped;
+        }
+    }
+}
+
+// 按时间戳把各暂存区已提交的条目并入高优先级通道或主缓冲区（只在日志线程和 panic_flush 中调用）
+// 每次取各暂存区首条中最早的一条，某个暂存区的首条尚未提交时暂不考虑该暂存区；主缓冲区满时剩余条目留到下次
+static void RP_Log_StageMerge(RP_Log_t *log)
+{
+    uint32_t count = log->stage_count;
+
+    for (;;)
+    {
+        RP_LogStage_t *next = NULL;
+        uint32_t stamp = 0;
+        uint16_t length = 0;
+        uint8_t type = 0;
+        uint8_t level = 0;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            RP_LogStage_t *stage = log->stages[i];
+            uint16_t entry_len;
+            uint8_t entry_type;
+            uint8_t entry_level;
+            if (stage == NULL || RB_Front(stage->ring, 0, &entry_len, &entry_type, &entry_level) != 0)
+            {
+                continue;
+            }
+
+            // 时间戳只取低 32 位，按差值比较，跨越回绕也能得到先后
+            uint32_t entry_stamp = stage->stamps[RB_ENTRY_POS(stage->ring->cursor[0]) & RB_ENTRY_MASK(stage->ring)];
+            if (next == NULL || (int32_t)(entry_stamp - stamp) < 0)
+            {
+                next = stage;
+                stamp = entry_stamp;
+                length = entry_len;
+                type = entry_type;
+                level = entry_level;
+            }
+        }
+        if (next == NULL)
+        {
+            break;
+        }
+
+        uint32_t index;
+        RP_LogRingBuffer_t *rb = RP_Log_ReserveRing(log, level, length, &index);
+        if (rb == NULL)
+        {
+            break;
+        }
+
+        uint8_t record[RP_LOG_ENTRY_MAX_SIZE];
+        RB_CopyOut(next->ring, RB_DATA_POS(next->ring->cursor[0]), record, length);
+        RB_CopyIn(rb, RB_DATA_POS(index), record, length);
+        RB_Publish(rb, index, length, type, level);
+        RB_Advance(next->ring, 0, length);
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (log->stages[i] != NULL)
+        {
+            RB_Reclaim(log->stages[i]->ring);
+        }
+    }
+}
+#endif
+
+// 格式化（延迟格式化时为打包参数）并写入环形缓冲区，返回值同 RB_Push
+static int RP_Log_VWrite(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line, const char *format, va_list args)
+{
+#if RP_LOG_USE_DEFERRED
+    // 延迟格式化：只记录参数，格式化交给 work()
+    return RP_Log_WriteDeferred(log, level, file, line, format, args);
+#else
+    // 格式化日志内容
+    uint8_t buffer[RP_LOG_ENTRY_MAX_SIZE];
+    int len = 0;
+
+    // 时间戳
+    if (log->config_param.use_timestamp)
+    {
+        len += RP_Log_FormatTimestamp((char *)buffer + len, RP_LOG_ENTRY_MAX_SIZE - len, RP_Log_GetTimestamp());
+    }
+
+    // 等级和位置
+    len += RP_Log_Format((char *)buffer + len, RP_LOG_ENTRY_MAX_SIZE - len,
+                         "[%s][%s:%d]: ", g_level_names[level], file, line);
+    if (len >= RP_LOG_ENTRY_MAX_SIZE - 2)
+    {
+        len = RP_LOG_ENTRY_MAX_SIZE - 3;
+    }
+
+    // 用户内容
+    len += RP_Log_VFormat((char *)buffer + len, RP_LOG_ENTRY_MAX_SIZE - len, format, args);
+
+    // 溢出保护
+    if (len >= RP_LOG_ENTRY_MAX_SIZE - 2)
+    {
+        len = RP_LOG_ENTRY_MAX_SIZE - 3;
+    }
+
+    // 换行
+    buffer[len++] = '\r';
+    buffer[len++] = '\n';
+
+    // 写入环形缓冲区（RTT 等输出由 work() 从同一份数据读取）
+    return RP_Log_Push(log, buffer, (uint16_t)len, RP_LOG_ENTRY_TEXT, (uint8_t)level);
+#endif
+}
+
+#if RP_LOG_USE_STATS
+// 时间戳计数与毫秒的换算（统计只用到时间差）
+#if RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT
+#define RP_LOG_STATS_MS_TO_TICK(ms_) ((uint64_t)(ms_) * (RP_LOG_DWT_FREQ_HZ / 1000UL))
+#else
+#define RP_LOG_STATS_MS_TO_TICK(ms_) ((uint64_t)(ms_))
+#endif
+
+// 更新缓冲区最高占用（先读读指针再读写指针，占用量不会算成负数）
+static void RP_Log_StatsPeak(RP_Log_t *log)
+{
+    RP_LogRingBuffer_t *rb = log->ring_buffer;
+    uint32_t tail = rb->tail;
+    uint32_t head = rb->head;
+
+    RB_AtomicMax(&log->stats.ring_peak, (uint16_t)(RB_DATA_POS(head) - RB_DATA_POS(tail)));
+    RB_AtomicMax(&log->stats.entry_peak, (uint16_t)(RB_ENTRY_POS(head) - RB_ENTRY_POS(tail)));
+}
+
+// 输出一行统计（经 write() 写入缓冲区，与普通日志按顺序发送）
+static void RP_Log_StatsReport(RP_Log_t *log)
+{
+    RP_LogStats_t s;
+    uint32_t written = 0;
+    uint32_t filtered = 0;
+    uint32_t dropped = 0;
+
+    RP_Log_GetStats(log, &s);
+    for (int i = RP_LOG_LEVEL_FATAL; i <= RP_LOG_LEVEL_TRACE; i++)
+    {
+        written += s.written[i];
+        filtered += s.filtered[i];
+        dropped += s.dropped[i];
+    }
+
+    // 分两行输出，延迟格式化时参数区不超过 RP_LOG_DEFER_ARG_MAX
+    RP_Log_Write(log, RP_LOG_LEVEL_INFO, RP_LOG_SELF_FILE, RP_LOG_SELF_LINE,
+                 "stats: written %lu filtered %lu dropped %lu discarded %lu, peak %lu/%u B %lu/%u",
+                 (unsigned long)written, (unsigned long)filtered, (unsigned long)dropped,
+                 (unsigned long)s.discarded, (unsigned long)s.ring_peak, (unsigned)log->ring_buffer->size,
+                 (unsigned long)s.entry_peak, (unsigned)log->ring_buffer->cnt);
+    RP_Log_Write(log, RP_LOG_LEVEL_INFO, RP_LOG_SELF_FILE, RP_LOG_SELF_LINE,
+                 "stats: tx %lu failed %lu %lu B/s, write avg %lu max %lu cyc",
+                 (unsigned long)s.tx_count, (unsigned long)s.tx_failed, (unsigned long)s.tx_bytes_per_s,
+                 (unsigned long)s.write_cycles_avg, (unsigned long)s.write_cycles_max);
+}
+
+// 并入 write() 周期数，每秒更新发送速率，按 stats_period_ms 输出统计行（只在 work() 中调用）
+static void RP_Log_StatsUpdate(RP_Log_t *log)
+{
+    RP_LogStats_t *s = &log->stats;
+
+#if RP_LOG_STATS_TIMED
+    if (log->stats_calls != 0)
+    {
+        s->write_timed += RB_AtomicSwap(&log->stats_calls, 0);
+        s->write_cycles_sum += RB_AtomicSwap(&log->stats_cycles, 0);
+    }
+#endif
+
+    uint64_t now = RP_Log_GetTimestamp();
+    uint64_t second = RP_LOG_STATS_MS_TO_TICK(1000);
+    if (now - log->stats_rate_tick >= second)
+    {
+        s->tx_bytes_per_s = (uint32_t)((s->tx_bytes - log->stats_rate_bytes) * second / (now - log->stats_rate_tick));
+        log->stats_rate_tick = now;
+        log->stats_rate_bytes = s->tx_bytes;
+    }
+
+    uint32_t period = log->config_param.stats_period_ms;
+    if (period != 0 && now - log->stats_report_tick >= RP_LOG_STATS_MS_TO_TICK(period))
+    {
+        log->stats_report_tick = now;
+        RP_Log_StatsReport(log);
+    }
+}
+#endif
+
+/* Public functions --------------------------------------------------------*/
+
+/**
+ * @brief  写入日志到环形缓冲区
+ * @param  log: 日志模块实例指针
+ * @param  level: 日志等级
+ * @param  file: 源文件名（不含路径，宏中由 RP_LOG_FILE 给出）
+ * @param  line: 行号
+ * @param  format: 格式化字符串
+ * @retval 0=成功, -1=失败
+ */
+static int RP_Log_Write(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line, const char *format, ...)
+{
+    if (log == NULL || (unsigned int)level > RP_LOG_LEVEL_TRACE)
+    {
+        return -1;
+    }
+
+    // 等级过滤
+    if (!RP_Log_LevelEnabled(log, level))
+    {
+        RP_LOG_STATS_INC(log->stats.filtered[level]);
+        return -1;
+    }
+
+    va_list args;
+    va_start(args, format);
+    int ret = RP_Log_Submit(log, level, file, line, format, args);
+    va_end(args);
+
+    return ret;
+}
+
+/**
+ * @brief  写入一段原始数据（RP_LOG_HEX / RP_LOG_RAW），不格式化
+ * @param  log: 日志模块实例指针
+ * @param  level: 日志等级
+ * @param  file: 源文件名
+ * @param  line: 行号
+ * @param  kind: 显示方式（RP_LOG_DATA_HEX / RP_LOG_DATA_RAW）
+ * @param  data: 数据指针
+ * @param  length: 数据字节数（超过 RP_LOG_ENTRY_MAX_SIZE 减去记录头的部分截断）
+ * @retval 0=成功, -1=失败
+ * @note   记录头和数据直接拷入预留的空间，展开在 work() 中进行（二进制帧模式下由上位机展开）
+ */
+static int RP_Log_WriteData(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line, uint8_t kind,
+                            const void *data, uint16_t length)
+{
+    if (log == NULL || (data == NULL && length != 0) || (unsigned int)level > RP_LOG_LEVEL_TRACE)
+    {
+        return -1;
+    }
+
+    if (!RP_Log_LevelEnabled(log, level))
+    {
+        RP_LOG_STATS_INC(log->stats.filtered[level]);
+        return -1;
+    }
+
+    RP_LogDataHdr_t hdr;
+    hdr.file = file;
+    hdr.timestamp = RP_Log_GetTimestamp();
+    hdr.line = (uint16_t)line;
+    hdr.level = (uint8_t)level;
+    hdr.kind = kind & RP_LOG_DATA_RAW;
+    if (length > RP_LOG_DATA_MAX)
+    {
+        length = RP_LOG_DATA_MAX;
+        hdr.kind |= RP_LOG_DATA_CUT;
+    }
+
+    uint16_t total = (uint16_t)(sizeof(hdr) + length);
+    uint32_t index;
+    int ret = -1;
+    RP_LogRingBuffer_t *rb = RP_Log_Reserve(log, hdr.level, total, &index);
+    if (rb != NULL)
+    {
+        RB_CopyIn(rb, RB_DATA_POS(index), (const uint8_t *)&hdr, sizeof(hdr));
+        RB_CopyIn(rb, (uint16_t)(RB_DATA_POS(index) + sizeof(hdr)), (const uint8_t *)data, length);
+        ret = RB_Publish(rb, index, total, RP_LOG_ENTRY_DATA, hdr.level);
+    }
+
+    return RP_Log_Account(log, level, ret);
+}
+
+/**
+ * @brief  写入一条参数已打包的日志（RP_Log.hpp 的宏使用，需 RP_LOG_USE_DEFERRED）
+ * @param  log: 日志模块实例指针
+ * @param  site: 调用位置状态（RP_LOG_USE_DEDUP 时按打包后的参数去重，NULL=不去重）
+ * @param  level: 日志等级
+ * @param  file: 源文件名
+ * @param  line: 行号
+ * @param  format: 格式化字符串（需为常量字符串）
+ * @param  args: 按 format 打包的参数，布局与 write() 延迟格式化时相同
+ * @param  length: 参数字节数（超过 RP_LOG_DEFER_ARG_MAX 的部分截断）
+ * @retval 0=成功或已去重, -1=失败（未启用延迟格式化时总是失败）
+ * @note   格式串已在编译期解析和检查，写入时不再扫描格式串
+ */
+static int RP_Log_WriteArgs(RP_Log_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                            const char *format, const void *args, uint16_t length)
+{
+#if RP_LOG_USE_DEFERRED
+    if (log == NULL || (args == NULL && length != 0) || (unsigned int)level > RP_LOG_LEVEL_TRACE)
+    {
+        return -1;
+    }
+
+    if (!RP_Log_LevelEnabled(log, level))
+    {
+        RP_LOG_STATS_INC(log->stats.filtered[level]);
+        return -1;
+    }
+
+    if (length > RP_LOG_DEFER_ARG_MAX)
+    {
+        length = RP_LOG_DEFER_ARG_MAX;
+    }
+
+#if RP_LOG_USE_DEDUP
+    // 打包后的参数已含 %s 的内容，直接比较其摘要
+    if (site != NULL && RP_Log_SiteRepeat(log, site, level, file, line, RP_Log_Hash(2166136261UL, args, length)))
+    {
+        return 0;
+    }
+#else
+    (void)site;
+#endif
+
+#if RP_LOG_STATS_TIMED
+    uint32_t start = RP_Log_TimedStart();
+#endif
+
+    int ret = RP_Log_PushDeferred(log, level, file, line, format, (const uint8_t *)args, length);
+
+#if RP_LOG_STATS_TIMED
+    RP_Log_TimedEnd(log, start);
+#endif
+
+#if RP_LOG_USE_DEDUP
+    if (ret < 0 && site != NULL)
+    {
+        site->last_ms = 0; // 未能写入，下一条不算重复
+    }
+#endif
+
+    return RP_Log_Account(log, level, ret);
+#else
+    (void)log;
+    (void)site;
+    (void)level;
+    (void)file;
+    (void)line;
+    (void)format;
+    (void)args;
+    (void)length;
+    return -1;
+#endif
+}
+
+/**
+ * @brief  注册一个采样变量（RP_LOG_USE_TELEMETRY）
+ * @param  log: 日志模块实例指针
+ * @param  name: 变量名（需为常量字符串）
+ * @param  addr: 变量地址（生命周期内有效，按类型对齐）
+ * @param  type: 变量类型
+ * @retval 变量序号, -1=失败（已满 RP_LOG_TELEMETRY_VAR_MAX 个或未启用）
+ * @note   只追加不删除，在 RP_Log_Init() 之后、同一任务中调用；注册后从下一次采样开始生效
+ */
+static int RP_Log_AddVar(RP_Log_t *log, const char *name, const volatile void *addr, RP_LogVarType_t type)
+{
+#if RP_LOG_USE_TELEMETRY
+    if (log == NULL || name == NULL || addr == NULL || (unsigned int)type > RP_LOG_VAR_FLOAT)
+    {
+        return -1;
+    }
+
+    uint8_t index = log->var_count;
+    if (index >= RP_LOG_TELEMETRY_VAR_MAX)
+    {
+        return -1;
+    }
+    log->vars[index].name = name;
+    log->vars[index].addr = addr;
+    log->vars[index].type = (uint8_t)type;
+
+    // 变量描述写完后才计入，采样和日志线程看到的变量数总是有效的
+    RB_DMB();
+    log->var_count = (uint8_t)(index + 1);
+    return index;
+#else
+    (void)log;
+    (void)name;
+    (void)addr;
+    (void)type;
+    return -1;
+#endif
+}
+
+/**
+ * @brief  注册当前任务的暂存区（RP_LOG_USE_STAGE，在该任务中调用）
+ * @param  log: 日志模块实例指针
+ * @param  stage: 暂存区（可先设置 name，生命周期内不能释放）
+ * @retval 暂存区序号, -1=失败（已注册、已满 RP_LOG_STAGE_MAX 个、不在任务中或未启用）
+ * @note   只追加不删除；注册后本任务的日志写入暂存区，由 work() 并入主缓冲区
+ */
+static int RP_Log_AddStage(RP_Log_t *log, RP_LogStage_t *stage)
+{
+#if RP_LOG_USE_STAGE
+    if (log == NULL || stage == NULL || RP_LOG_IN_ISR())
+    {
+        return -1;
+    }
+
+    void *task = RP_LOG_TASK_SELF();
+    if (task == NULL)
+    {
+        return -1;
+    }
+    for (uint32_t i = 0; i < log->stage_count; i++)
+    {
+        RP_LogStage_t *other = log->stages[i];
+        if (other == stage || (other != NULL && other->task == task))
+        {
+            return -1;
+        }
+    }
+
+    // 各任务可能同时注册：先占位置，暂存区就绪后再填入，日志线程和查找跳过尚未填入的位置
+    uint32_t slot = log->stage_count;
+    do
+    {
+        if (slot >= RP_LOG_STAGE_MAX)
+        {
+            return -1;
+        }
+    } while (!RB_CAS(&log->stage_count, &slot, slot + 1));
+
+    stage->ring = RB_Layout(stage->mem, sizeof(stage->mem), RP_LOG_STAGE_SIZE, RP_LOG_STAGE_CNT);
+    stage->task = task;
+    stage->dropped = 0;
+    stage->dropped_seen = 0;
+    stage->ring->active = 0;
+    RB_Reset(stage->ring);
+    RB_Attach(stage->ring, 0); // 日志线程使用 0 号读指针
+
+    RB_DMB();
+    log->stages[slot] = stage;
+    return (int)slot;
+#else
+    (void)log;
+    (void)stage;
+    return -1;
+#endif
+}
+
+/**
+ * @brief  设置模块的输出等级（RP_LOG_USE_FILTER，可在任意任务中调用）
+ * @param  log: 日志模块实例指针
+ * @param  module: 模块号（0 ~ RP_LOG_MODULE_MAX-1），RP_LOG_MODULE_ALL 为所有模块
+ * @param  range: 该模块输出的等级范围
+ * @retval 0=成功, -1=失败（模块号无效或未启用）
+ * @note   只影响 RP_LOG_XXX 宏，直接调用 write() 不区分模块；config_param.output_range 仍对所有模块生效
+ */
+static int RP_Log_SetFilter(RP_Log_t *log, uint8_t module, RP_LogOutputRange_t range)
+{
+#if RP_LOG_USE_FILTER
+    if (log == NULL || (module >= RP_LOG_MODULE_MAX && module != RP_LOG_MODULE_ALL))
+    {
+        return -1;
+    }
+
+    // 单字节写入，宏中读到的总是某一次设置的完整值
+    uint8_t filter = (uint8_t)(~RP_Log_RangeMask(range) & 0x3F);
+    for (uint8_t id = 0; id < RP_LOG_MODULE_MAX; id++)
+    {
+        if (module == RP_LOG_MODULE_ALL || id == module)
+        {
+            log->filter[id] = filter;
+        }
+    }
+    return 0;
+#else
+    (void)log;
+    (void)module;
+    (void)range;
+    return -1;
+#endif
+}
+
+#if RP_LOG_USE_FILTER
+// 解析十进制数，返回读过的字符数（0=不是数字）
+static uint16_t RP_Log_ParseUint(const char *s, uint16_t length, uint32_t *value)
+{
+    uint16_t i = 0;
+    *value = 0;
+    while (i < length && s[i] >= '0' && s[i] <= '9' && *value < 1000)
+    {
+        *value = *value * 10 + (uint32_t)(s[i] - '0');
+        i++;
+    }
+    return i;
+}
+#endif
+
+/**
+ * @brief  处理串口过滤命令（RP_LOG_USE_FILTER，在串口接收中调用）
+ * @param  log: 日志模块实例指针
+ * @param  cmd: 收到的一行，格式 "CMD:LOG_FILTER=模块,等级"（模块为模块号或 ALL，等级为 RP_LOG_OUTPUT_XXX 的值 0~5）
+ * @param  length: 长度（可含结尾的 "\r\n"）
+ * @retval 0=已处理, -1=不是过滤命令或参数无效
+ * @note   例如 "CMD:LOG_FILTER=ALL,3" 后 "CMD:LOG_FILTER=2,4"：所有模块输出到 INFO，模块 2 输出到 DEBUG
+ */
+static int RP_Log_FilterCmd(RP_Log_t *log, const char *cmd, uint16_t length)
+{
+#if RP_LOG_USE_FILTER
+    static const char prefix[] = "CMD:LOG_FILTER=";
+    const uint16_t prefix_len = sizeof(prefix) - 1;
+
+    if (log == NULL || cmd == NULL || length <= prefix_len || memcmp(cmd, prefix, prefix_len) != 0)
+    {
+        return -1;
+    }
+    cmd += prefix_len;
+    length -= prefix_len;
+    while (length > 0 && (cmd[length - 1] == '\r' || cmd[length - 1] == '\n'))
+    {
+        length--;
+    }
+
+    uint32_t module;
+    uint16_t n;
+    if (length >= 3 && memcmp(cmd, "ALL", 3) == 0)
+    {
+        module = RP_LOG_MODULE_ALL;
+        n = 3;
+    }
+    else
+    {
+        n = RP_Log_ParseUint(cmd, length, &module);
+        if (n == 0 || module >= RP_LOG_MODULE_ALL)
+        {
+            return -1;
+        }
+    }
+    if (n >= length || cmd[n] != ',')
+    {
+        return -1;
+    }
+    n++;
+
+    uint32_t range;
+    uint16_t m = RP_Log_ParseUint(cmd + n, (uint16_t)(length - n), &range);
+    if (m == 0 || n + m != length || range > RP_LOG_OUTPUT_ALL)
+    {
+        return -1;
+    }
+    return RP_Log_SetFilter(log, (uint8_t)module, (RP_LogOutputRange_t)range);
+#else
+    (void)log;
+    (void)cmd;
+    (void)length;
+    return -1;
+#endif
+}
+
+/**
+ * @brief  采样已注册的变量（在控制周期中调用，每 sample_divider 次采样一次）
+ * @param  log: 日志模块实例指针
+ * @retval None
+ * @note   只按类型拷贝各变量的原始值写入缓冲区，文本和帧在 work() 中生成；缓冲区满时与普通日志一样计入丢弃
+ *         只能在一个任务（或中断）中调用
+ */
+static void RP_Log_Sample(RP_Log_t *log)
+{
+#if RP_LOG_USE_TELEMETRY
+    if (log == NULL || log->config_param.sample_divider == 0)
+    {
+        return;
+    }
+    if (++log->sample_tick < log->config_param.sample_divider)
+    {
+        return;
+    }
+    log->sample_tick = 0;
+
+    uint8_t count = log->var_count;
+    if (count == 0)
+    {
+        return;
+    }
+    RB_DMB();
+
+    if (!RP_Log_LevelEnabled(log, (RP_LogLevel_t)RP_LOG_TELEMETRY_LEVEL))
+    {
+        RP_LOG_STATS_INC(log->stats.filtered[RP_LOG_TELEMETRY_LEVEL]);
+        return;
+    }
+
+    // 序号在丢弃时也递增，上位机据此发现缺失的采样
+    uint8_t record[sizeof(RP_LogSampleHdr_t) + RP_LOG_TELEMETRY_VAR_MAX * 4];
+    RP_LogSampleHdr_t hdr;
+    hdr.timestamp = RP_Log_GetTimestamp();
+    hdr.seq = log->sample_seq++;
+    hdr.count = count;
+    hdr.reserved = 0;
+    memcpy(record, &hdr, sizeof(hdr));
+
+    uint16_t len = sizeof(hdr);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const RP_LogVar_t *var = &log->vars[i];
+        if (g_var_sizes[var->type] == 1)
+        {
+            record[len] = *(const volatile uint8_t *)var->addr;
+        }
+        else if (g_var_sizes[var->type] == 2)
+        {
+            uint16_t v = *(const volatile uint16_t *)var->addr;
+            memcpy(&record[len], &v, sizeof(v));
+        }
+        else
+        {
+            uint32_t v = *(const volatile uint32_t *)var->addr; // 单次读取，float 按位拷贝
+            memcpy(&record[len], &v, sizeof(v));
+        }
+        len += g_var_sizes[var->type];
+    }
+
+    RP_Log_Account(log, (RP_LogLevel_t)RP_LOG_TELEMETRY_LEVEL,
+                   RP_Log_Push(log, record, len, RP_LOG_ENTRY_SAMPLE, RP_LOG_TELEMETRY_LEVEL));
+#else
+    (void)log;
+#endif
+}
+
+/**
+ * @brief  写入日志，参数与本调用位置上一条相同时只计数（RP_LOG_USE_DEDUP）
+ * @param  log: 日志模块实例指针
+ * @param  site: 调用位置状态（宏中的静态变量）
+ * @param  level: 日志等级
+ * @param  file: 源文件名
+ * @param  line: 行号
+ * @param  format: 格式化字符串
+ * @retval 0=成功或已去重, -1=失败
+ */
+static int RP_Log_WriteSite(RP_Log_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                            const char *format, ...)
+{
+    if (log == NULL || site == NULL || (unsigned int)level > RP_LOG_LEVEL_TRACE)
+    {
+        return -1;
+    }
+
+    if (!RP_Log_LevelEnabled(log, level))
+    {
+        RP_LOG_STATS_INC(log->stats.filtered[level]);
+        return -1;
+    }
+
+    int ret = 0;
+    va_list args;
+    va_start(args, format);
+
+#if RP_LOG_USE_DEDUP
+    // 在格式化之前比较参数摘要，多任务同时调用同一位置时计数可能略有偏差
+    va_list probe;
+    va_copy(probe, args);
+    uint32_t hash = RP_Log_HashArgs(format, probe);
+    va_end(probe);
+
+    if (!RP_Log_SiteRepeat(log, site, level, file, line, hash))
+    {
+        ret = RP_Log_Submit(log, level, file, line, format, args);
+        if (ret < 0)
+        {
+            site->last_ms = 0; // 未能写入，下一条不算重复
+        }
+    }
+#else
+    ret = RP_Log_Submit(log, level, file, line, format, args);
+#endif
+
+    va_end(args);
+    return ret;
+}
+
+/**
+ * @brief  限频检查：本调用位置距上次输出不足 period_ms 时返回 0（宏中不再求值参数）
+ * @param  log: 日志模块实例指针
+ * @param  site: 调用位置状态（宏中的静态变量）
+ * @param  period_ms: 最小输出间隔（毫秒）
+ * @param  level: 日志等级
+ * @param  file: 源文件名
+ * @param  line: 行号
+ * @retval 1=可以输出, 0=被抑制或被过滤
+ */
+static int RP_Log_RateLimit(RP_Log_t *log, RP_LogSite_t *site, uint32_t period_ms, RP_LogLevel_t level,
+                            const char *file, int line)
+{
+    if (log == NULL || site == NULL || (unsigned int)level > RP_LOG_LEVEL_TRACE)
+    {
+        return 0;
+    }
+
+    // 被过滤的日志不占用输出间隔
+    if (!RP_Log_LevelEnabled(log, level))
+    {
+        RP_LOG_STATS_INC(log->stats.filtered[level]);
+        return 0;
+    }
+
+#if RP_LOG_HAS_CLOCK
+    uint32_t now = RP_Log_SiteTime();
+    uint32_t last = site->last_ms;
+
+    // 间隔未到，或其他任务、中断同时通过了检查
+    if ((last != 0 && now - last < period_ms) || !RB_CAS(&site->last_ms, &last, now))
+    {
+        RB_AtomicAdd(&site->suppressed, 1);
+        RP_LOG_STATS_INC(log->stats.suppressed);
+        return 0;
+    }
+
+    RP_Log_SiteReport(log, site, level, file, line, "%lu messages suppressed");
+#else
+    (void)period_ms;
+    (void)file;
+    (void)line;
+#endif
+
+    return 1;
+}
+
+/**
+ * @brief  写入并统计一条已通过等级过滤的日志
+ * @param  log: 日志模块实例指针
+ * @param  level: 日志等级
+ * @param  file: 源文件名
+ * @param  line: 行号
+ * @param  format: 格式化字符串
+ * @param  args: 可变参数
+ * @retval 0=成功, -1=失败
+ */
+static int RP_Log_Submit(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line,
+                         const char *format, va_list args)
+{
+#if RP_LOG_STATS_TIMED
+    uint32_t start = RP_Log_TimedStart();
+#endif
+
+    int ret = RP_Log_VWrite(log, level, file, line, format, args);
+
+#if RP_LOG_STATS_TIMED
+    RP_Log_TimedEnd(log, start);
+#endif
+
+    return RP_Log_Account(log, level, ret);
+}
+
+#if RP_LOG_STATS_TIMED
+// write() 计时开始，返回当前 CYCCNT
+static uint32_t RP_Log_TimedStart(void)
+{
+    if (!g_dwt_ready)
+    {
+        RP_Log_DwtEnable();
+    }
+    return RP_LOG_DWT_CYCCNT;
+}
+
+// write() 计时结束：周期数先累加到 32 位暂存，由 work() 并入 64 位累计值
+static void RP_Log_TimedEnd(RP_Log_t *log, uint32_t start)
+{
+    uint32_t cycles = RP_LOG_DWT_CYCCNT - start;
+    RB_AtomicAdd(&log->stats_cycles, cycles);
+    RB_AtomicAdd(&log->stats_calls, 1);
+    RB_AtomicMax(&log->stats.write_cycles_max, cycles);
+}
+#endif
+
+/**
+ * @brief  统计一次写入缓冲区的结果，有输出在等待本条时唤醒日志线程
+ * @param  log: 日志模块实例指针
+ * @param  level: 日志等级
+ * @param  ret: RB_Push() 的返回值
+ * @retval 0=成功, -1=失败
+ */
+static int RP_Log_Account(RP_Log_t *log, RP_LogLevel_t level, int ret)
+{
+#if !RP_LOG_USE_STATS && !RP_LOG_USE_STAGE
+    (void)level;
+#endif
+    if (ret < 0)
+    {
+#if RP_LOG_USE_STAGE
+        // 暂存区满：记在该任务名下，由 work() 单独报告
+        RP_LogStage_t *stage = RP_Log_StageSelf(log, (uint8_t)level);
+        if (stage != NULL)
+        {
+            RB_AtomicAdd(&stage->dropped, 1);
+            RP_LOG_STATS_INC(log->stats.dropped[level]);
+            return -1;
+        }
+#endif
+        RB_AtomicAdd(&log->dropped, 1);
+        RP_LOG_STATS_INC(log->stats.dropped[level]);
+        return -1;
+    }
+
+#if RP_LOG_USE_STATS
+    RP_LOG_STATS_INC(log->stats.written[level]);
+    RP_Log_StatsPeak(log);
+#endif
+
+    // 唤醒日志线程
+    if (ret > 0 && log->notify != NULL)
+    {
+        log->notify(log);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  处理日志输出（需在独立线程中循环调用）
+ * @param  log: 日志模块实例指针
+ * @retval None
+ */
+static void RP_Log_Work(RP_Log_t *log)
+{
+#if RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT
+    RP_Log_DwtUpdate();
+#endif
+
+    if (log == NULL)
+    {
+        return;
+    }
+
+#if RP_LOG_USE_STATS
+    RP_Log_StatsUpdate(log);
+#endif
+
+#if RP_LOG_USE_STAGE
+    // 各任务暂存区按时间戳并入主缓冲区，由各输出与其他日志一起读取；丢弃提示行跟在丢弃前写入的日志之后
+    RP_Log_StageMerge(log);
+    RP_Log_StageReport(log);
+#endif
+
+    // 各输出独立读取，正忙或发送失败的输出不影响其他输出；高优先级通道中的日志先发出
+    for (uint8_t id = 0; id < RP_LOG_SINK_MAX; id++)
+    {
+        RP_LogSink_t *sink = log->sinks[id];
+        if (sink != NULL && (log->ring_buffer->active & (1UL << id)))
+        {
+            // 先登记再读取，DISCARD_OLDEST 不会丢弃正在读的条目；有写入方正在丢弃时下次再读
+            if (RB_Pin(log->ring_buffer, id) == 0)
+            {
+                sink->lost += RB_Catchup(log->ring_buffer, id);
+                RP_Log_SinkWork(log, sink);
+            }
+            RP_Log_SinkRelease(log, sink);
+        }
+    }
+
+    // 所有已启用输出都读过的空间才交还生产者
+    RB_Reclaim(log->ring_buffer);
+#if RP_LOG_USE_LANE
+    RB_Reclaim(log->lane);
+#endif
+}
+
+/**
+ * @brief  获取环形缓冲区中可用的日志数量
+ * @param  log: 日志模块实例指针
+ * @retval 可用日志数量（RP_LOG_USE_LANE 时含高优先级通道，RP_LOG_USE_STAGE 时含尚未并入的暂存区条目）
+ */
+static uint16_t RP_Log_GetCount(RP_Log_t *log)
+{
+    if (log == NULL)
+    {
+        return 0;
+    }
+
+    uint16_t count = RB_GetCount(log->ring_buffer);
+#if RP_LOG_USE_LANE
+    count += RB_GetCount(log->lane);
+#endif
+#if RP_LOG_USE_STAGE
+    for (uint32_t i = 0; i < log->stage_count; i++)
+    {
+        if (log->stages[i] != NULL)
+        {
+            count += RB_GetCount(log->stages[i]->ring);
+        }
+    }
+#endif
+    return count;
+}
+
+/**
+ * @brief  读取运行统计（不加锁的快照，可在任意任务中调用）
+ * @param  log: 日志模块实例指针
+ * @param  stats: 输出
+ * @retval 0=成功, -1=失败（RP_LOG_USE_STATS 为 0 时输出全 0）
+ */
+static int RP_Log_GetStats(RP_Log_t *log, RP_LogStats_t *stats)
+{
+    if (log == NULL || stats == NULL)
+    {
+        return -1;
+    }
+
+#if RP_LOG_USE_STATS
+    memcpy(stats, &log->stats, sizeof(RP_LogStats_t));
+
+    // 加上尚未由 work() 并入的周期数
+    stats->write_timed += log->stats_calls;
+    stats->write_cycles_sum += log->stats_cycles;
+    stats->write_cycles_avg = (stats->write_timed != 0) ? (uint32_t)(stats->write_cycles_sum / stats->write_timed) : 0;
+    return 0;
+#else
+    memset(stats, 0, sizeof(RP_LogStats_t));
+    return -1;
+#endif
+}
+
+/**
+ * @brief  清空环形缓冲区
+ * @param  log: 日志模块实例指针
+ * @retval None
+ */
+static void RP_Log_Flush(RP_Log_t *log)
+{
+    if (log == NULL)
+    {
+        return;
+    }
+    RB_Reset(log->ring_buffer);
+#if RP_LOG_USE_LANE
+    RB_Reset(log->lane);
+#endif
+#if RP_LOG_USE_STAGE
+    for (uint32_t i = 0; i < log->stage_count; i++)
+    {
+        RP_LogStage_t *stage = log->stages[i];
+        if (stage != NULL)
+        {
+            RB_Reset(stage->ring);
+            stage->dropped_seen = stage->dropped;
+        }
+    }
+#endif
+
+    // 清空前的丢弃不再报告（RP_Log_SinkReset() 记下当前丢弃条数）
+    for (uint8_t id = 0; id < RP_LOG_SINK_MAX; id++)
+    {
+        if (log->sinks[id] != NULL)
+        {
+            RP_Log_SinkReset(log, log->sinks[id]);
+        }
+    }
+}
+
+// 清除输出的发送状态（读指针由调用者设置）
+static void RP_Log_SinkReset(RP_Log_t *log, RP_LogSink_t *sink)
+{
+    sink->tx_busy = 0;
+    sink->tx_advance = 0;
+    sink->tx_pending = 0;
+    sink->tx_marker = 0;
+    sink->lost = 0;
+    sink->data_sent = 0;
+#if RP_LOG_USE_LANE
+    sink->lane = 0;
+#endif
+#if RP_LOG_USE_TELEMETRY && RP_LOG_USE_BINARY
+    sink->tel_count = 0;
+#endif
+    sink->dropped_seen = log->dropped;
+#if RP_LOG_USE_COMPRESS
+    if (sink->compress != NULL)
+    {
+        sink->compress->blocks = 0;
+    }
+#endif
+}
+
+// 在 buffer 上划分缓冲区，空间不足时返回 NULL
+// RP_LOG_USE_LANE 时开头 RB_LANE_BYTES 字节为高优先级通道（*lane），其余为主缓冲区；未启用时 *lane 为 NULL
+static RP_LogRingBuffer_t *RP_Log_Layout(void *buffer, uint32_t size, RP_LogRingBuffer_t **lane)
+{
+    *lane = NULL;
+#if RP_LOG_USE_LANE
+    uintptr_t base = ((uintptr_t)buffer + RB_ALIGN - 1) & ~(uintptr_t)(RB_ALIGN - 1);
+    uint32_t skip = (uint32_t)(base - (uintptr_t)buffer) + RB_LANE_BYTES;
+
+    if (buffer == NULL || size <= skip)
+    {
+        return NULL;
+    }
+    *lane = RB_Layout(buffer, skip, RP_LOG_LANE_SIZE, RP_LOG_LANE_CNT);
+    buffer = (uint8_t *)buffer + skip;
+    size -= skip;
+#endif
+    return RB_Layout(buffer, size, RP_LOG_RING_BUFFER_SIZE, RP_LOG_RING_BUFFER_CNT);
+}
+
+#if RP_LOG_USE_NOINIT
+#define RP_LOG_NOINIT_MAGIC 0x524C4F47U // "RLOG"
+
+// 固件标识和格式串、文件名所在只读区的默认来源（见 RP_Log.h 中的 RP_LOG_NOINIT_XXX）
+#ifndef RP_LOG_NOINIT_BUILD_ID
+extern const uint8_t g_rp_log_build_id[]; // GNU build-id 段起始，由链接脚本导出
+#endif
+extern const uint32_t g_pfnVectors[]; // 向量表（启动文件），位于 flash 开头
+extern const uint32_t _sidata[];      // .data 初值的加载地址（链接脚本），位于 .rodata 之后
+
+// FNV-1a 累加一段字节
+static uint32_t RP_Log_NoinitHash(uint32_t hash, const uint8_t *data, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+// 缓冲区布局摘要：尺寸、格式或固件变化后不恢复上次的内容（格式串、文件名地址可能已变）
+// 固件标识取整个镜像的 build-id，只改动其他源文件的增量编译也会改变
+static uint32_t RP_Log_NoinitLayout(RP_LogRingBuffer_t *rb)
+{
+    const uint32_t words[] = {rb->size, rb->cnt, (uint32_t)(uintptr_t)rb->data, RP_LOG_ENTRY_MAX_SIZE,
+                              RP_LOG_USE_DEFERRED};
+    uint32_t hash = RP_Log_NoinitHash(2166136261UL, (const uint8_t *)words, sizeof(words));
+
+#ifdef RP_LOG_NOINIT_BUILD_ID
+    static const char build[] = RP_LOG_NOINIT_BUILD_ID;
+    hash = RP_Log_NoinitHash(hash, (const uint8_t *)build, sizeof(build) - 1);
+#else
+    // ELF 注释：名称长度(4) | 描述长度(4) | 类型(4) | "GNU\0" | build-id
+    uint32_t desc_size;
+    memcpy(&desc_size, &g_rp_log_build_id[4], sizeof(desc_size));
+    if (desc_size > 64)
+    {
+        desc_size = 64;
+    }
+    hash = RP_Log_NoinitHash(hash, g_rp_log_build_id, (uint16_t)(16 + desc_size));
+#endif
+    return hash;
+}
+
+// 记录中的格式串、文件名指针是否指向本固件的只读区
+static int RP_Log_NoinitRom(const char *p)
+{
+    uintptr_t addr = (uintptr_t)p;
+    return addr >= (uintptr_t)(RP_LOG_NOINIT_ROM_START) && addr < (uintptr_t)(RP_LOG_NOINIT_ROM_END);
+}
+
+// 找回的条目中带指针的记录逐条检查，指针不在只读区时返回 -1（从这里截断，不解引用）
+static int RP_Log_NoinitCheck(RP_LogRingBuffer_t *rb, uint16_t data_pos, uint16_t length, uint8_t type)
+{
+#if RP_LOG_USE_DEFERRED
+    if (type == RP_LOG_ENTRY_DEFERRED)
+    {
+        RP_LogDeferredHdr_t hdr;
+        if (length < sizeof(hdr))
+        {
+            return -1;
+        }
+        RB_CopyOut(rb, data_pos, (uint8_t *)&hdr, sizeof(hdr));
+        return (RP_Log_NoinitRom(hdr.file) && RP_Log_NoinitRom(hdr.format)) ? 0 : -1;
+    }
+#endif
+    if (type == RP_LOG_ENTRY_DATA)
+    {
+        RP_LogDataHdr_t hdr;
+        if (length < sizeof(hdr))
+        {
+            return -1;
+        }
+        RB_CopyOut(rb, data_pos, (uint8_t *)&hdr, sizeof(hdr));
+        return RP_Log_NoinitRom(hdr.file) ? 0 : -1;
+    }
+    return 0;
+}
+
+// 检查 rb 中上次留下的内容，找回 sinks[0] 尚未发出的条目并重建读写指针，返回找回的条数（内容无效时清空）
+static uint16_t RP_Log_RecoverRing(RP_Log_t *log, RP_LogRingBuffer_t *rb)
+{
+    uint32_t layout = RP_Log_NoinitLayout(rb);
+    uint32_t start = 0;
+    uint16_t data_pos = 0;
+    uint16_t entry_pos = 0;
+    uint16_t count = 0;
+
+    if (rb->magic == RP_LOG_NOINIT_MAGIC && rb->layout == layout && rb->check == (uint32_t)~(RP_LOG_NOINIT_MAGIC ^ layout))
+    {
+        uint32_t head = rb->head;
+        uint32_t tail = rb->tail;
+        uint16_t entries = (uint16_t)(RB_ENTRY_POS(head) - RB_ENTRY_POS(tail));
+        uint16_t used = (uint16_t)(RB_DATA_POS(head) - RB_DATA_POS(tail));
+
+        if (entries <= rb->cnt && used <= rb->size)
+        {
+            // 串口已发出的日志已在 TF 卡上，从串口的读指针开始（有效时）
+            uint32_t cursor = rb->cursor[0];
+            start = tail;
+            if ((rb->active & 1UL) && (uint16_t)(RB_ENTRY_POS(cursor) - RB_ENTRY_POS(tail)) <= entries &&
+                (uint16_t)(RB_DATA_POS(cursor) - RB_DATA_POS(tail)) <= used)
+            {
+                start = cursor;
+            }
+
+            data_pos = RB_DATA_POS(start);
+            entry_pos = RB_ENTRY_POS(start);
+            while (entry_pos != RB_ENTRY_POS(head))
+            {
+                uint16_t length;
+                uint8_t type;
+                uint8_t level;
+                if (RB_GetEntry(rb, entry_pos, &length, &type, &level) != 0 || length == 0 ||
+                    length > RP_LOG_ENTRY_MAX_SIZE ||
+                    (uint16_t)(data_pos + length - RB_DATA_POS(tail)) > used ||
+                    RP_Log_NoinitCheck(rb, data_pos, length, type) != 0)
+                {
+                    break;
+                }
+                data_pos += length;
+                entry_pos++;
+                count++;
+            }
+
+            // 截断点之后可能还有已提交的条目，清掉其描述，新条目提交前不会被误认为已提交
+            for (uint16_t pos = entry_pos; pos != RB_ENTRY_POS(head); pos++)
+            {
+                rb->entries[pos & RB_ENTRY_MASK(rb)] = 0;
+            }
+        }
+    }
+
+    if (count == 0)
+    {
+        RB_Reset(rb);
+    }
+    else
+    {
+        rb->head = RB_INDEX(data_pos, entry_pos);
+        rb->tail = start;
+        for (uint8_t id = 0; id < RP_LOG_SINK_MAX; id++)
+        {
+            rb->cursor[id] = start;
+            rb->entry_sent[id] = 0;
+        }
+        rb->pinned = 0;
+        rb->evicting = 0;
+    }
+
+    uint32_t active = 0;
+    for (uint8_t id = 0; id < RP_LOG_SINK_MAX; id++)
+    {
+        if (log->sinks[id] != NULL)
+        {
+            active |= 1UL << id;
+        }
+    }
+    rb->active = active;
+    rb->magic = RP_LOG_NOINIT_MAGIC;
+    rb->layout = layout;
+    rb->check = (uint32_t)~(RP_LOG_NOINIT_MAGIC ^ layout);
+    RB_DMB();
+    return count;
+}
+#endif
+
+/**
+ * @brief  复位后找回上次尚未从串口发出的日志（RP_LOG_USE_NOINIT 为 1 时，在 main() 开头、第一条日志之前调用）
+ * @param  log: 日志模块实例指针
+ * @retval 找回的日志条数（内容无效时清空缓冲区并返回 0），-1=失败
+ * @note   从 sinks[0] 的读指针开始逐条检查提交标记、长度和记录中的格式串、文件名指针，截断到第一条无效的条目；
+ *         找回的日志在缓冲区最前面，最先发出，之后写入一行 "N messages recovered from before reset"
+ *         复位时正在发送的日志会再发一次；RP_LOG_USE_NOINIT 为 0 时什么也不做
+ *         RP_LOG_USE_LANE 时高优先级通道同样检查、找回，条数合计
+ */
+static int RP_Log_Recover(RP_Log_t *log)
+{
+    if (log == NULL)
+    {
+        return -1;
+    }
+
+#if RP_LOG_USE_NOINIT
+    // 头部中的尺寸和指针不可信，按内存区重新划分（与 RP_Log_Init() 相同）
+    RP_LogRingBuffer_t *lane;
+    RP_LogRingBuffer_t *rb = RP_Log_Layout(log->arena, log->arena_size, &lane);
+    if (rb == NULL)
+    {
+        return -1;
+    }
+    log->ring_buffer = rb;
+
+    uint16_t count = RP_Log_RecoverRing(log, rb);
+    RP_LogLevel_t level = RP_LOG_LEVEL_WARN;
+#if RP_LOG_USE_LANE
+    // 通道先发：主缓冲区找回了日志时提示行写在通道之外（低一级），排在这些日志之后发出
+#if RP_LOG_LANE_LEVEL < RP_LOG_LVL_TRACE
+    if (count != 0 && level <= RP_LOG_LANE_LEVEL)
+    {
+        level = (RP_LogLevel_t)(RP_LOG_LANE_LEVEL + 1);
+    }
+#endif
+    log->lane = lane;
+    count += RP_Log_RecoverRing(log, lane);
+#else
+    (void)lane;
+#endif
+
+    if (count != 0)
+    {
+        RP_Log_Write(log, level, RP_LOG_SELF_FILE, RP_LOG_SELF_LINE, "%u messages recovered from before reset",
+                     (unsigned)count);
+    }
+    return count;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief  经 RP_Log_PanicTransmit 轮询发出 sinks[0] 尚未发送的全部日志（HardFault、看门狗预警等异常中调用）
+ * @param  log: 日志模块实例指针
+ * @retval None
+ * @note   不使用中断和 DMA，调用前应关中断；日志线程被打断时正在发送的内容再发一次（可能重复，不会丢失）
+ *         读指针随发送前进，RP_LOG_USE_NOINIT 为 1 时复位后只找回未发出的部分；调用后应复位
+ *         RP_LOG_USE_LANE 时先发高优先级通道，发送中途失败时 FATAL/ERROR 已尽量先发出
+ *         RP_LOG_USE_STAGE 时先把各暂存区并入主缓冲区，主缓冲区放不下的部分不再发出
+ */
+static void RP_Log_PanicFlush(RP_Log_t *log)
+{
+    if (log == NULL || log->sinks[0] == NULL)
+    {
+        return;
+    }
+
+    RP_LogSink_t *sink = log->sinks[0];
+    uint8_t mask = RP_Log_RangeMask(sink->output_range);
+
+    // 零拷贝发送的读指针在发送完成后才前进，从读指针重新发送即可；tx_buffer 中的内容已离开缓冲区，先发出
+    sink->tx_busy = 1; // 日志线程、发送完成中断不再启动发送
+    sink->tx_advance = 0;
+    if (sink->tx_pending != 0)
+    {
+        if (RP_Log_PanicTransmit(sink->tx_buffer, sink->tx_pending) != 0)
+        {
+            return;
+        }
+        sink->tx_pending = 0;
+    }
+
+#if RP_LOG_USE_STAGE
+    RP_Log_StageMerge(log);
+#endif
+    // DISCARD_OLDEST 已越过读指针的条目不再读取
+    sink->lost += RB_Catchup(log->ring_buffer, sink->id);
+
+    uint32_t dropped = log->dropped;
+    if (RB_SINK_RING(log, sink)->entry_sent[sink->id] == 0 && (dropped != sink->dropped_seen || sink->lost != 0))
+    {
+        uint16_t length = RP_Log_FormatDropped(log, sink, sink->tx_buffer, dropped - sink->dropped_seen + sink->lost);
+        if (RP_Log_PanicTransmit(sink->tx_buffer, length) != 0)
+        {
+            return;
+        }
+        sink->dropped_seen = dropped;
+        sink->lost = 0;
+    }
+
+    // 高优先级通道先发出；主缓冲区的日志发到一半时先发完主缓冲区，再发通道
+    if (RP_Log_PanicDrain(log, sink, RP_Log_SinkSelect(log, sink, mask), mask) != 0)
+    {
+        return;
+    }
+#if RP_LOG_USE_LANE
+    sink->lane = !sink->lane;
+    RP_Log_PanicDrain(log, sink, RB_SINK_RING(log, sink), mask);
+#endif
+}
+
+// 经 RP_Log_PanicTransmit 发出输出 sink 在 rb 中尚未发送的全部日志，发完返回 0，发送失败返回 -1
+// 一次发出读指针之后所有连续的文本条目，延迟格式化记录逐条格式化，原始数据、采样记录逐行展开；不压缩，上位机按普通行处理
+static int RP_Log_PanicDrain(RP_Log_t *log, RP_LogSink_t *sink, RP_LogRingBuffer_t *rb, uint8_t mask)
+{
+    uint8_t id = sink->id;
+
+    for (;;)
+    {
+        const uint8_t *data;
+        uint16_t length;
+        uint8_t level;
+        uint8_t type;
+
+        if (RB_Skip(rb, id, mask) != 0)
+        {
+            sink->data_sent = 0;
+        }
+        if (RB_Front(rb, id, &length, &type, &level) == 0 && type != RP_LOG_ENTRY_TEXT)
+        {
+            uint8_t record[RP_LOG_ENTRY_MAX_SIZE];
+            uint16_t sent = sink->data_sent;
+            int n = 0;
+            RB_CopyOut(rb, RB_DATA_POS(rb->cursor[id]), record, length);
+            if (type != RP_LOG_ENTRY_DEFERRED)
+            {
+                n = RP_Log_FormatExpand(log, sink, type, record, length, sink->tx_buffer, RP_LOG_TX_BUFFER_SIZE, 1);
+            }
+#if RP_LOG_USE_DEFERRED
+            else
+            {
+                n = RP_Log_FormatRecord(log, sink, record, length, sink->tx_buffer);
+            }
+#endif
+            if (n < 0 || RP_Log_PanicTransmit(sink->tx_buffer, (uint16_t)n) != 0)
+            {
+                sink->data_sent = sent;
+                return -1;
+            }
+            if (sink->data_sent == 0)
+            {
+                RB_Advance(rb, id, length);
+            }
+            continue;
+        }
+        length = RB_Peek(rb, id, &data, rb->size, mask, &level);
+        if (length == 0)
+        {
+            return 0;
+        }
+        if (RP_Log_PanicTransmit(data, length) != 0)
+        {
+            return -1;
+        }
+        RB_Advance(rb, id, length);
+    }
 }
 
-// 判断缓冲区空
-static int RB_IsEmpty(RP_LogRingBuffer_t *rb)
+/**
+ * @brief  发送完成通知（sinks[0]，RP_LOG_USE_TX_CPLT 为 1 时在发送完成中断中调用）
+ * @param  log: 日志模块实例指针
+ * @retval None
+ */
+static void RP_Log_TxCplt(RP_Log_t *log)
 {
-    return rb->count == 0;
+    if (log == NULL)
+    {
+        return;
+    }
+    RP_Log_SinkCplt(log, log->sinks[0]);
 }
 
-// 写入数据
-static int RB_Push(RP_LogRingBuffer_t *rb, const uint8_t *data, uint16_t length)
+/**
+ * @brief  输出发送完成通知（async 为 1 的输出在发送完成回调中调用）
+ * @param  log: 日志模块实例指针
+ * @param  sink: 发送完成的输出
+ * @retval None
+ */
+static void RP_Log_SinkCplt(RP_Log_t *log, RP_LogSink_t *sink)
 {
-    if (RB_IsFull(rb))
+    if (log == NULL || sink == NULL || !sink->tx_busy)
     {
-        return -1;
+        return;
     }
 
-    if (length > RP_LOG_ENTRY_MAX_SIZE)
+    if (sink->tx_advance != 0)
     {
-        length = RP_LOG_ENTRY_MAX_SIZE;
+        RB_Advance(RB_SINK_RING(log, sink), sink->id, sink->tx_advance);
+        sink->tx_advance = 0;
+    }
+    else
+    {
+        sink->tx_pending = 0;
     }
 
-    memcpy(rb->entries[rb->head].data, data, length);
-    rb->entries[rb->head].length = length;
-    rb->head = RB_GetNextIndex(rb->head, RP_LOG_RING_BUFFER_CNT);
-    rb->count++;
+    sink->tx_busy = 0;
 
-    return 0;
+    // 还有数据待发送或待回收时唤醒日志线程
+    if (log->notify != NULL && RP_Log_IsPending(log))
+    {
+        log->notify(log);
+    }
 }
 
-// 读取数据
-static int RB_Pop(RP_LogRingBuffer_t *rb, uint8_t *data, uint16_t *length)
+/**
+ * @brief  注册输出（在启动日志线程前或在日志线程中调用）
+ * @param  log: 日志模块实例指针
+ * @param  sink: 输出（需设置 transmit、output_range、batch_max、async，生命周期内不能释放）
+ * @retval 0=成功, -1=失败（已注册或已满 RP_LOG_SINK_MAX 个）
+ * @note   新输出从缓冲区中尚未回收的最早日志开始读取
+ */
+static int RP_Log_AddSink(RP_Log_t *log, RP_LogSink_t *sink)
 {
-    if (RB_IsEmpty(rb))
+    if (log == NULL || sink == NULL)
     {
         return -1;
     }
 
-    *length = rb->entries[rb->tail].length;
-    memcpy(data, rb->entries[rb->tail].data, *length);
-    rb->tail = RB_GetNextIndex(rb->tail, RP_LOG_RING_BUFFER_CNT);
-    rb->count--;
+    int slot = -1;
+    for (uint8_t id = 0; id < RP_LOG_SINK_MAX; id++)
+    {
+        if (log->sinks[id] == sink)
+        {
+            return -1;
+        }
+        if (log->sinks[id] == NULL && slot < 0)
+        {
+            slot = id;
+        }
+    }
+    if (slot < 0)
+    {
+        return -1;
+    }
 
+    sink->id = (uint8_t)slot;
+    RP_Log_SinkReset(log, sink);
+#if RP_LOG_USE_COMPRESS
+    if (sink->compress != NULL)
+    {
+        sink->compress->blocks = 0; // 下一块重置，接收端从头解压
+    }
+#endif
+    log->sinks[slot] = sink;
+    RB_Attach(log->ring_buffer, (uint8_t)slot);
+#if RP_LOG_USE_LANE
+    RB_Attach(log->lane, (uint8_t)slot);
+#endif
     return 0;
 }
 
-#if RP_LOG_USE_RTT
-// RTT输出
-static void RP_Log_RttOutput(RP_LogLevel_t level, const char *file, int line, const char *format, va_list args)
+/**
+ * @brief  移除输出（在日志线程中调用，async 输出需在发送完成后移除）
+ * @param  log: 日志模块实例指针
+ * @param  sink: 输出
+ * @retval None
+ * @note   移除后该输出不再阻止空间回收，长期发送失败的输出应移除
+ */
+static void RP_Log_RemoveSink(RP_Log_t *log, RP_LogSink_t *sink)
 {
-    static uint8_t rtt_buf[RP_LOG_ENTRY_MAX_SIZE];
-    int rtt_len = 0;
-
-    // 提取文件名
-    const char *filename = file;
-    const char *slash = strrchr(file, '\\');
-    if (slash != NULL)
+    if (log == NULL || sink == NULL)
     {
-        filename = slash + 1;
+        return;
     }
-    else
+
+    for (uint8_t id = 0; id < RP_LOG_SINK_MAX; id++)
     {
-        slash = strrchr(file, '/');
-        if (slash != NULL)
+        if (log->sinks[id] == sink)
         {
-            filename = slash + 1;
+            RB_Detach(log->ring_buffer, id);
+#if RP_LOG_USE_LANE
+            RB_Detach(log->lane, id);
+#endif
+            log->sinks[id] = NULL;
+            sink->tx_busy = 0;
         }
     }
+}
 
-    // 颜色前缀
-    if (g_rp_log.config_param.rtt_use_color)
+/**
+ * @brief  DISCARD_OLDEST：主缓冲区满时从最早的日志开始丢弃，腾出 length 字节（写入方预留失败时调用）
+ * @param  log: 日志模块实例指针
+ * @param  length: 新条目的字节数
+ * @retval 0=已腾出空间（调用者重试一次预留）, -1=策略不是 DISCARD_OLDEST 或腾不出空间
+ * @note   不丢弃输出正在读取、零拷贝发送或已发送一部分的条目；各输出未读就被丢弃的条数在其下一条提示行中报告
+ *         只丢弃主缓冲区，高优先级通道中的日志不会被丢弃
+ */
+static int RP_Log_Evict(RP_Log_t *log, uint16_t length)
+{
+    if (log->config_param.overflow_policy != RP_LOG_OVERFLOW_DISCARD_OLDEST)
     {
-        rtt_len += snprintf((char *)rtt_buf, RP_LOG_ENTRY_MAX_SIZE,
-                            "%s", g_level_colors[level]);
+        return -1;
     }
-
-    // 时间戳
-    if (g_rp_log.config_param.use_timestamp)
+    if (length > RP_LOG_ENTRY_MAX_SIZE)
     {
-#if defined(USE_HAL_DRIVER)
-        rtt_len += snprintf((char *)rtt_buf + rtt_len, RP_LOG_ENTRY_MAX_SIZE - rtt_len,
-                            "[%lu] ", HAL_GetTick());
-#endif
+        length = RP_LOG_ENTRY_MAX_SIZE;
     }
 
-    // 等级和位置
-    rtt_len += snprintf((char *)rtt_buf + rtt_len, RP_LOG_ENTRY_MAX_SIZE - rtt_len,
-                        "[%s][%s:%d]: ", g_level_names[level], filename, line);
-
-    // 颜色重置
-    if (g_rp_log.config_param.rtt_use_color)
+    int discarded = RB_Evict(log->ring_buffer, length);
+    if (discarded < 0)
     {
-        rtt_len += snprintf((char *)rtt_buf + rtt_len, RP_LOG_ENTRY_MAX_SIZE - rtt_len,
-                            "%s", RP_LOG_COLOR_RESET);
+        return -1;
     }
+#if RP_LOG_USE_STATS
+    RB_AtomicAdd(&log->stats.discarded, (uint32_t)discarded);
+#endif
+    return 0;
+}
 
-    // 用户内容
-    rtt_len += vsnprintf((char *)rtt_buf + rtt_len, RP_LOG_ENTRY_MAX_SIZE - rtt_len, format, args);
+// 输出不再使用主缓冲区中读指针处的条目时取消登记，DISCARD_OLDEST 可以丢弃
+// 仍在使用：零拷贝发送中、条目已发出一部分、原始数据或采样记录展开到一半
+// 只在 work() 中调用：发送完成中断中取消登记可能落在 work() 再次登记之后，使其读取的条目失去保护
+static void RP_Log_SinkRelease(RP_Log_t *log, RP_LogSink_t *sink)
+{
+    RP_LogRingBuffer_t *rb = log->ring_buffer;
+    uint8_t id = sink->id;
 
-    // 溢出保护
-    if (rtt_len >= RP_LOG_ENTRY_MAX_SIZE - 2)
+    if (RB_SINK_RING(log, sink) == rb &&
+        ((sink->tx_busy && sink->tx_advance != 0) || rb->entry_sent[id] != 0 || sink->data_sent != 0))
     {
-        rtt_len = RP_LOG_ENTRY_MAX_SIZE - 3;
+        return;
     }
+    RB_Unpin(rb, id);
+}
 
-    rtt_buf[rtt_len++] = '\r';
-    rtt_buf[rtt_len++] = '\n';
+// 选择输出本次读取的缓冲区：高优先级通道中有本输出要发的日志时先读通道
+// 只在两条日志之间切换：当前条目零拷贝发出一部分、原始数据或采样记录展开到一半时继续读当前缓冲区
+static RP_LogRingBuffer_t *RP_Log_SinkSelect(RP_Log_t *log, RP_LogSink_t *sink, uint8_t mask)
+{
+#if RP_LOG_USE_LANE
+    uint8_t id = sink->id;
+    uint16_t length;
+    uint8_t type;
+    uint8_t level;
 
-    SEGGER_RTT_Write(0, rtt_buf, rtt_len);
-}
+    if (RB_SINK_RING(log, sink)->entry_sent[id] == 0 && sink->data_sent == 0)
+    {
+        RB_Skip(log->lane, id, mask);
+        sink->lane = (RB_Front(log->lane, id, &length, &type, &level) == 0);
+    }
+#else
+    (void)sink;
+    (void)mask;
 #endif
-
-/* Public functions --------------------------------------------------------*/
+    return RB_SINK_RING(log, sink);
+}
 
 /**
- * @brief  写入日志到环形缓冲区
+ * @brief  处理一个输出：丢弃提示行、延迟格式化记录、零拷贝发送文本条目
  * @param  log: 日志模块实例指针
- * @param  level: 日志等级
- * @param  file: 源文件名
- * @param  line: 行号
- * @param  format: 格式化字符串
- * @retval 0=成功, -1=失败
+ * @param  sink: 输出
+ * @retval None
  */
-static int RP_Log_Write(RP_Log_t *log, RP_LogLevel_t level, const char *file, int line, const char *format, ...)
+static void RP_Log_SinkWork(RP_Log_t *log, RP_LogSink_t *sink)
 {
-    if (log == NULL)
-    {
-        return -1;
-    }
+    uint8_t id = sink->id;
+    uint8_t mask = RP_Log_RangeMask(sink->output_range);
 
-    // 等级过滤
-    switch (log->config_param.output_range)
+    if (sink->tx_busy)
     {
-    case RP_LOG_OUTPUT_FATAL_ONLY:
-        if (level != RP_LOG_LEVEL_FATAL)
-            return -1;
-        break;
-    case RP_LOG_OUTPUT_FATAL_TO_ERROR:
-        if (level > RP_LOG_LEVEL_ERROR)
-            return -1;
-        break;
-    case RP_LOG_OUTPUT_FATAL_TO_WARN:
-        if (level > RP_LOG_LEVEL_WARN)
-            return -1;
-        break;
-    case RP_LOG_OUTPUT_FATAL_TO_INFO:
-        if (level > RP_LOG_LEVEL_INFO)
-            return -1;
-        break;
-    case RP_LOG_OUTPUT_FATAL_TO_DEBUG:
-        if (level > RP_LOG_LEVEL_DEBUG)
-            return -1;
-        break;
-    case RP_LOG_OUTPUT_ALL:
-    default:
-        break;
+        return;
     }
 
-    // 提取文件名
-    const char *filename = file;
-    const char *slash = strrchr(file, '\\');
-    if (slash != NULL)
+    RP_LogRingBuffer_t *rb = RP_Log_SinkSelect(log, sink, mask);
+
+    // tx_buffer 中有上次发送失败的数据时先原样重试，保持顺序
+    uint8_t retry = (sink->tx_pending != 0);
+
+    // 有日志因缓冲区满被丢弃：在本输出的下一次发送前插入提示行
+    // 两条提示行之间至少发送一次缓冲区数据，避免持续溢出时只发提示行；不插在被拆开的一条日志中间
+    uint32_t dropped = log->dropped;
+    if (!retry && !sink->tx_marker && rb->entry_sent[id] == 0 && sink->data_sent == 0 &&
+        (dropped != sink->dropped_seen || sink->lost != 0))
     {
-        filename = slash + 1;
+        uint32_t count = dropped - sink->dropped_seen + sink->lost;
+        sink->dropped_seen = dropped;
+        sink->lost = 0;
+        sink->tx_pending = RP_Log_FormatDropped(log, sink, sink->tx_buffer, count);
+        sink->level = RP_LOG_LEVEL_WARN;
+        sink->tx_marker = 1;
     }
-    else
+
+    // 延迟格式化记录、原始数据、采样记录在此处按本输出的格式处理（连续多条合并到 tx_buffer）
+    // 延迟格式化记录处理后立即前进读指针；原始数据、采样记录逐行展开，整条展开完后才前进
+    if (!retry)
     {
-        slash = strrchr(file, '/');
-        if (slash != NULL)
+        uint16_t cap = RP_LOG_TX_BUFFER_SIZE;
+#if RP_LOG_USE_COMPRESS
+        if (sink->compress != NULL)
         {
-            filename = slash + 1;
+            cap = RP_LOG_COMPRESS_BLOCK_SIZE; // 合并后的内容压缩为一块
+        }
+#endif
+        uint16_t max = sink->batch_max;
+        if (max == 0 || max > cap)
+        {
+            max = cap;
         }
-    }
-
-    // 格式化日志内容
-    uint8_t buffer[RP_LOG_ENTRY_MAX_SIZE];
-    int len = 0;
 
-    // 时间戳
-    if (log->config_param.use_timestamp)
-    {
-#if defined(USE_HAL_DRIVER)
-        len += snprintf((char *)buffer + len, RP_LOG_ENTRY_MAX_SIZE - len,
-                        "[%lu] ", HAL_GetTick());
+#if RP_LOG_USE_DEFERRED
+        uint16_t unit = RP_LOG_TX_UNIT_SIZE;
+#if RP_LOG_USE_BINARY && RP_LOG_NEED_TEXT
+        if (sink->text)
+        {
+            unit = RP_LOG_ENTRY_MAX_SIZE;
+        }
+#endif
 #endif
-    }
 
-    // 等级和位置
-    len += snprintf((char *)buffer + len, RP_LOG_ENTRY_MAX_SIZE - len,
-                    "[%s][%s:%d]: ", g_level_names[level], filename, line);
+        for (;;)
+        {
+            uint16_t length;
+            uint8_t type;
+            uint8_t level;
 
-    // 用户内容
-    va_list args;
-    va_start(args, format);
-    len += vsnprintf((char *)buffer + len, RP_LOG_ENTRY_MAX_SIZE - len, format, args);
-    va_end(args);
+            // 等级范围改变后跳过的可能是展开了一半的原始数据或采样记录
+            if (RB_Skip(rb, id, mask) != 0)
+            {
+                sink->data_sent = 0;
+            }
+            if (RB_Front(rb, id, &length, &type, &level) != 0 || type == RP_LOG_ENTRY_TEXT)
+            {
+                break;
+            }
+            if (sink->tx_pending != 0 && (sink->batch_max == 0 || sink->tx_pending >= max))
+            {
+                break;
+            }
 
-    // 溢出保护
-    if (len >= RP_LOG_ENTRY_MAX_SIZE - 2)
-    {
-        len = RP_LOG_ENTRY_MAX_SIZE - 3;
+            uint8_t record[RP_LOG_ENTRY_MAX_SIZE];
+            int n;
+            if (type != RP_LOG_ENTRY_DEFERRED)
+            {
+                RB_CopyOut(rb, RB_DATA_POS(rb->cursor[id]), record, length);
+                uint8_t first = (sink->tx_pending == 0);
+                n = RP_Log_FormatExpand(log, sink, type, record, length, sink->tx_buffer + sink->tx_pending,
+                                        first ? cap : (uint16_t)(max - sink->tx_pending), first);
+                if (n < 0)
+                {
+                    break;
+                }
+                if (sink->data_sent == 0)
+                {
+                    RB_Advance(rb, id, length);
+                }
+            }
+            else
+            {
+#if RP_LOG_USE_DEFERRED
+                if (sink->tx_pending != 0 && sink->tx_pending + unit > max)
+                {
+                    break;
+                }
+                RB_CopyOut(rb, RB_DATA_POS(rb->cursor[id]), record, length);
+                RB_Advance(rb, id, length);
+                n = RP_Log_FormatRecord(log, sink, record, length, sink->tx_buffer + sink->tx_pending);
+#else
+                break;
+#endif
+            }
+            if (sink->tx_pending == 0)
+            {
+                sink->level = level;
+            }
+            sink->tx_pending += (uint16_t)n;
+            sink->tx_marker = 0;
+        }
     }
 
-    // 换行
-    buffer[len++] = '\r';
-    buffer[len++] = '\n';
-
-    // 写入环形缓冲区
-    if (RB_Push(&log->ring_buffer, buffer, (uint16_t)len) != 0)
+    if (sink->tx_pending != 0)
     {
-        return -1;
+#if RP_LOG_USE_COMPRESS
+        // 重试时 tx_buffer 中已是压缩帧
+        if (!retry && sink->compress != NULL)
+        {
+            sink->tx_pending = RP_Log_Compress(log, sink, sink->tx_buffer, sink->tx_pending);
+        }
+#endif
+        RP_Log_StartTransmit(log, sink, sink->tx_buffer, sink->tx_pending, 0);
+        return;
     }
 
-#if RP_LOG_USE_RTT
-    // RTT输出
-    va_start(args, format);
-    RP_Log_RttOutput(level, file, line, format, args);
-    va_end(args);
+    // 直接从环形缓冲区发送（零拷贝），发送完成后才前进读指针
+    // 相邻日志合并为一次发送，只有数据跨越缓冲区末尾或遇到被过滤的日志时才需要下一次
+    const uint8_t *data;
+    uint8_t level = RP_LOG_LEVEL_INFO;
+    uint16_t max = sink->batch_max;
+#if RP_LOG_USE_COMPRESS
+    if (sink->compress != NULL && max > RP_LOG_COMPRESS_BLOCK_SIZE)
+    {
+        max = RP_LOG_COMPRESS_BLOCK_SIZE;
+    }
 #endif
-
-    return 0;
+    // DISCARD_OLDEST 时按整条合并到 tx_buffer 的大小，不把条目拆开（拆开的条目发完前仍不能丢弃）
+    uint8_t copy = (log->config_param.overflow_policy == RP_LOG_OVERFLOW_DISCARD_OLDEST && rb == log->ring_buffer);
+    if (copy && max > RP_LOG_TX_BUFFER_SIZE)
+    {
+        max = RP_LOG_TX_BUFFER_SIZE;
+    }
+    RB_Skip(rb, id, mask);
+    uint16_t length = RB_Peek(rb, id, &data, max, mask, &level);
+    if (length != 0)
+    {
+        sink->level = level;
+        sink->tx_marker = 0;
+#if RP_LOG_USE_COMPRESS
+        if (sink->compress != NULL)
+        {
+            // 压缩：数据拷入窗口后立即前进读指针，发送 tx_buffer 中的压缩帧；超长的条目分到下一块
+            if (length > RP_LOG_COMPRESS_BLOCK_SIZE)
+            {
+                length = RP_LOG_COMPRESS_BLOCK_SIZE;
+            }
+            sink->tx_pending = RP_Log_Compress(log, sink, data, length);
+            RB_Advance(rb, id, length);
+            RP_Log_StartTransmit(log, sink, sink->tx_buffer, sink->tx_pending, 0);
+            return;
+        }
+#endif
+        if (copy)
+        {
+            // DISCARD_OLDEST：拷入 tx_buffer 后立即前进读指针，发送期间不占住主缓冲区，写入方可以丢弃旧日志
+            if (length > RP_LOG_TX_BUFFER_SIZE)
+            {
+                length = RP_LOG_TX_BUFFER_SIZE;
+            }
+            memcpy(sink->tx_buffer, data, length);
+            sink->tx_pending = length;
+            RB_Advance(rb, id, length);
+            RP_Log_StartTransmit(log, sink, sink->tx_buffer, sink->tx_pending, 0);
+            return;
+        }
+        RP_Log_StartTransmit(log, sink, data, length, length);
+    }
 }
 
 /**
- * @brief  处理日志输出（需在独立线程中循环调用）
+ * @brief  启动一次发送
  * @param  log: 日志模块实例指针
+ * @param  sink: 输出
+ * @param  data: 待发送数据指针
+ * @param  length: 数据长度
+ * @param  advance: 发送完成后读指针前进的字节数（0=发送的是 tx_buffer）
  * @retval None
  */
-static void RP_Log_Work(RP_Log_t *log)
+static void RP_Log_StartTransmit(RP_Log_t *log, RP_LogSink_t *sink, const uint8_t *data, uint16_t length,
+                                 uint16_t advance)
 {
-    if (log == NULL)
+    // 发送完成中断可能在 transmit 返回前触发，先置忙
+    sink->tx_advance = advance;
+    sink->tx_busy = 1;
+
+    if (sink->transmit == NULL || sink->transmit(sink, data, length) != 0)
     {
+        // 发送失败，数据仍留在缓冲区中，下次按原顺序重试
+        sink->tx_busy = 0;
+#if RP_LOG_USE_STATS
+        log->stats.tx_failed++;
+#endif
         return;
     }
 
-    // 取出日志并发送
-    uint8_t buffer[RP_LOG_ENTRY_MAX_SIZE];
-    uint16_t length;
+#if RP_LOG_USE_STATS
+    log->stats.tx_count++;
+    log->stats.tx_bytes += length;
+#endif
 
-    if (RB_Pop(&log->ring_buffer, buffer, &length) == 0)
+    if (!sink->async)
     {
-        if (RP_Log_Transmit(buffer, length) != 0)
-        {
-            // 发送失败，重新放回缓冲区
-            RB_Push(&log->ring_buffer, buffer, length);
-        }
+        // 同步发送：返回即视为发送完成
+        RP_Log_SinkCplt(log, sink);
     }
 }
 
-/**
- * @brief  获取环形缓冲区中可用的日志数量
- * @param  log: 日志模块实例指针
- * @retval 可用日志数量
- */
-static uint16_t RP_Log_GetCount(RP_Log_t *log)
+// 默认串口输出：转发给用户实现的 RP_Log_Transmit
+static int RP_Log_UartTransmit(RP_LogSink_t *sink, const uint8_t *data, uint16_t length)
 {
-    if (log == NULL)
-    {
-        return 0;
-    }
-    return log->ring_buffer.count;
+    (void)sink;
+    return RP_Log_Transmit(data, length);
 }
 
-/**
- * @brief  清空环形缓冲区
- * @param  log: 日志模块实例指针
- * @retval None
- */
-static void RP_Log_Flush(RP_Log_t *log)
+/* Public variables --------------------------------------------------------*/
+
+#if RP_LOG_USE_COMPRESS
+static RP_LogCompress_t g_rp_log_uart_lz; // 串口输出的压缩状态
+#endif
+
+// 默认串口输出（经 RP_Log_Transmit 发送）
+RP_LogSink_t g_rp_log_uart = {
+    .transmit = RP_Log_UartTransmit,
+    .output_range = RP_LOG_OUTPUT_ALL,
+    .batch_max = 512,
+    .async = RP_LOG_USE_TX_CPLT,
+    .text = 0,
+#if RP_LOG_USE_COMPRESS
+    .compress = &g_rp_log_uart_lz,
+#endif
+    .id = 0};
+
+#if RP_LOG_USE_RTT
+// RTT 输出（写入 RTT 缓冲区即完成；每次一行，以便给头部加颜色；二进制帧模式下仍输出文本）
+RP_LogSink_t g_rp_log_rtt = {
+    .transmit = RP_Log_RttTransmit,
+    .output_range = RP_LOG_OUTPUT_ALL,
+    .batch_max = 0,
+    .async = 0,
+    .text = 1,
+    .id = 1};
+#endif
+
+// 默认配置参数（g_rp_log 和 RP_Log_Init() 的 cfg 为 NULL 时）
+#define RP_LOG_CONFIG_DEFAULT                              \
+    {                                                      \
+        .output_range = RP_LOG_OUTPUT_ALL,                 \
+        .use_timestamp = 1,                                \
+        .rtt_use_color = 1,                                \
+        .overflow_policy = RP_LOG_OVERFLOW_DISCARD_NEWEST, \
+        .stats_period_ms = 0,                              \
+        .sample_divider = 1}
+
+static const RP_LogConfigParam_t g_rp_log_config_default = RP_LOG_CONFIG_DEFAULT;
+
+// g_rp_log 的环形缓冲区，布局与 RP_Log_Layout() 在同样大小的内存上划分的结果相同
+typedef struct
 {
-    if (log == NULL)
-    {
-        return;
-    }
-    memset(&log->ring_buffer, 0, sizeof(RP_LogRingBuffer_t));
-}
+#if RP_LOG_USE_LANE
+    RP_LogRingBuffer_t lane;
+    uint32_t lane_entries[RP_LOG_LANE_CNT];
+    uint8_t lane_data[RP_LOG_LANE_SIZE];
+#endif
+    RP_LogRingBuffer_t ring __attribute__((aligned(RB_ALIGN)));
+    uint32_t entries[RP_LOG_RING_BUFFER_CNT];
+    uint8_t data[RP_LOG_RING_BUFFER_SIZE];
+} RP_LogArena_t;
 
-/* Public variables --------------------------------------------------------*/
+#if RP_LOG_USE_LANE
+// 主缓冲区的位置须与 RP_Log_Layout() 一致（RB_LANE_BYTES 之后）
+typedef char RP_LogArenaLaneCheck_t[(offsetof(RP_LogArena_t, ring) == RB_LANE_BYTES) ? 1 : -1];
+#endif
+
+#if RP_LOG_USE_RTT
+#define RP_LOG_ARENA_ACTIVE 0x03 // g_rp_log 默认已启用的输出：串口、RTT
+#else
+#define RP_LOG_ARENA_ACTIVE 0x01 // g_rp_log 默认已启用的输出：串口
+#endif
+
+#if RP_LOG_USE_NOINIT
+// 启动代码不清零，复位后由 recover() 检查并找回；上电时为随机值，recover() 之前不能写日志
+static RP_LogArena_t g_rp_log_arena __attribute__((section(RP_LOG_NOINIT_SECTION), aligned(RB_ALIGN)));
+#else
+static RP_LogArena_t g_rp_log_arena __attribute__((aligned(RB_ALIGN))) = {
+#if RP_LOG_USE_LANE
+    .lane = {
+        .data = g_rp_log_arena.lane_data,
+        .entries = g_rp_log_arena.lane_entries,
+        .size = RP_LOG_LANE_SIZE,
+        .cnt = RP_LOG_LANE_CNT,
+        .active = RP_LOG_ARENA_ACTIVE},
+#endif
+    .ring = {
+        .data = g_rp_log_arena.data,
+        .entries = g_rp_log_arena.entries,
+        .size = RP_LOG_RING_BUFFER_SIZE,
+        .cnt = RP_LOG_RING_BUFFER_CNT,
+        .active = RP_LOG_ARENA_ACTIVE},
+};
+#endif
 
 // 日志全局实例（函数指针初始化）
 RP_Log_t g_rp_log = {
-    .config_param = {
-        .output_range = RP_LOG_OUTPUT_ALL,
-        .use_timestamp = 1,
-        .rtt_use_color = 1},
-    .ring_buffer = {0},
+    .config_param = RP_LOG_CONFIG_DEFAULT,
+    .ring_buffer = &g_rp_log_arena.ring,
+#if RP_LOG_USE_LANE
+    .lane = &g_rp_log_arena.lane,
+#endif
+    .arena = &g_rp_log_arena,
+    .arena_size = sizeof(g_rp_log_arena),
+#if RP_LOG_USE_RTT
+    .sinks = {&g_rp_log_uart, &g_rp_log_rtt},
+#else
+    .sinks = {&g_rp_log_uart},
+#endif
 
     .write = RP_Log_Write,
+    .write_site = RP_Log_WriteSite,
+    .write_data = RP_Log_WriteData,
+    .write_args = RP_Log_WriteArgs,
+    .rate_limit = RP_Log_RateLimit,
     .work = RP_Log_Work,
     .get_count = RP_Log_GetCount,
+    .get_stats = RP_Log_GetStats,
     .flush = RP_Log_Flush,
+    .tx_cplt = RP_Log_TxCplt,
+    .add_sink = RP_Log_AddSink,
+    .remove_sink = RP_Log_RemoveSink,
+    .sink_cplt = RP_Log_SinkCplt,
+    .recover = RP_Log_Recover,
+    .panic_flush = RP_Log_PanicFlush,
+    .add_var = RP_Log_AddVar,
+    .sample = RP_Log_Sample,
+    .add_stage = RP_Log_AddStage,
+    .set_filter = RP_Log_SetFilter,
+    .filter_cmd = RP_Log_FilterCmd,
+    .notify = NULL,
 };
 
+/* Exported functions ------------------------------------------------------*/
+
+/**
+ * @brief  在用户提供的内存上初始化日志实例（不在内部分配内存）
+ * @param  log: 日志模块实例指针（g_rp_log 或用户定义的全局 RP_Log_t）
+ * @param  buffer: 环形缓冲区所用内存（如 CCM、DTCM 或其他 SRAM 区），生命周期内不能释放
+ * @param  size: buffer 字节数，数据区取放得下的最大 2 的幂（不超过 32768），条目数按默认缓冲区的比例分配
+ *               （RP_LOG_USE_LANE 时先从开头划出固定大小的高优先级通道）
+ * @param  cfg: 配置参数（NULL=默认配置）
+ * @retval 0=成功, -1=失败（size 放不下一条 RP_LOG_ENTRY_MAX_SIZE 的日志）
+ * @note   在其他任务写日志、启动日志线程之前调用；已注册的输出（g_rp_log 的串口输出）保留，
+ *         新实例用 add_sink() 注册自己的输出；RP_LOG_USE_NOINIT 为 1 时之后调用 recover()
+ */
+int RP_Log_Init(RP_Log_t *log, void *buffer, uint32_t size, const RP_LogConfigParam_t *cfg)
+{
+    if (log == NULL)
+    {
+        return -1;
+    }
+
+    RP_LogRingBuffer_t *lane;
+    RP_LogRingBuffer_t *rb = RP_Log_Layout(buffer, size, &lane);
+    if (rb == NULL)
+    {
+        return -1;
+    }
+
+    RP_LogSink_t *sinks[RP_LOG_SINK_MAX];
+    void (*notify)(RP_Log_t *log) = log->notify;
+    memcpy(sinks, log->sinks, sizeof(sinks));
+    memset(log, 0, sizeof(RP_Log_t));
+
+    log->config_param = (cfg != NULL) ? *cfg : g_rp_log_config_default;
+    log->ring_buffer = rb;
+#if RP_LOG_USE_LANE
+    log->lane = lane;
+#else
+    (void)lane;
+#endif
+    log->arena = buffer;
+    log->arena_size = size;
+    log->write = RP_Log_Write;
+    log->write_site = RP_Log_WriteSite;
+    log->write_data = RP_Log_WriteData;
+    log->write_args = RP_Log_WriteArgs;
+    log->rate_limit = RP_Log_RateLimit;
+    log->work = RP_Log_Work;
+    log->get_count = RP_Log_GetCount;
+    log->get_stats = RP_Log_GetStats;
+    log->flush = RP_Log_Flush;
+    log->tx_cplt = RP_Log_TxCplt;
+    log->add_sink = RP_Log_AddSink;
+    log->remove_sink = RP_Log_RemoveSink;
+    log->sink_cplt = RP_Log_SinkCplt;
+    log->recover = RP_Log_Recover;
+    log->panic_flush = RP_Log_PanicFlush;
+    log->add_var = RP_Log_AddVar;
+    log->sample = RP_Log_Sample;
+    log->add_stage = RP_Log_AddStage;
+    log->set_filter = RP_Log_SetFilter;
+    log->filter_cmd = RP_Log_FilterCmd;
+    log->notify = notify;
+
+    uint32_t active = 0;
+    for (uint8_t id = 0; id < RP_LOG_SINK_MAX; id++)
+    {
+        if (sinks[id] != NULL)
+        {
+            sinks[id]->id = id;
+            log->sinks[id] = sinks[id];
+            active |= 1UL << id;
+        }
+    }
+
+#if RP_LOG_USE_NOINIT
+    // 读写指针和已启用输出由 recover() 检查、重建
+    (void)active;
+#else
+    rb->active = active;
+#if RP_LOG_USE_LANE
+    lane->active = active;
+#endif
+    RP_Log_Flush(log);
+#endif
+    return 0;
+}
+
 /* Weak functions ----------------------------------------------------------*/
 
 /**
@@ -378,6 +5228,7 @@ RP_Log_t g_rp_log = {
 
 __attribute__((weak)) int RP_Log_Transmit(const uint8_t *data, uint16_t length)
 {
+    //  DMA 发送需设置 RP_LOG_USE_TX_CPLT 为 1，并在 HAL_UART_TxCpltCallback 中调用 g_rp_log.tx_cplt(&g_rp_log)
     //  if (HAL_UART_Transmit_DMA(&huart1, data, length) == HAL_OK)
     //  {
     //      return 0;
@@ -385,3 +5236,23 @@ __attribute__((weak)) int RP_Log_Transmit(const uint8_t *data, uint16_t length)
 
     return -1;
 }
+
+/**
+ * @brief  串口轮询发送接口（panic_flush 使用，可在异常中调用，返回时数据已发完）
+ * @param  data: 待发送数据指针
+ * @param  length: 数据长度
+ * @retval 0=成功, -1=失败（默认实现不发送，RP_LOG_USE_NOINIT 为 1 时日志留到复位后发出）
+ */
+
+__attribute__((weak)) int RP_Log_PanicTransmit(const uint8_t *data, uint16_t length)
+{
+    //  HAL_UART_AbortTransmit(&huart1);
+    //  if (HAL_UART_Transmit(&huart1, (uint8_t *)data, length, HAL_MAX_DELAY) == HAL_OK)
+    //  {
+    //      return 0;
+    //  }
+
+    (void)data;
+    (void)length;
+    return -1;
+}
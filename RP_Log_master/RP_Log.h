@@ -20,7 +20,9 @@
   * (#) 串口输出接口实现（用户需实现以下函数）
   *     在RP_Log.c中实现 RP_Log_Transmit 函数，参考示例如下：
   *
-  *     HAL库DMA示例:
+  *     HAL库DMA示例（以下三处缺一不可）:
+  *     #define RP_LOG_USE_TX_CPLT 1 // 本文件配置区或编译选项 -DRP_LOG_USE_TX_CPLT=1
+  *
   *     int RP_Log_Transmit(const uint8_t *data, uint16_t length)
   *     {
   *         if (HAL_UART_Transmit_DMA(&huart1, data, length) == HAL_OK) {
@@ -29,6 +31,23 @@
   *         return -1;
   *     }
   *
+  *     void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+  *     {
+  *         if (huart == &huart1) {
+  *             g_rp_log.tx_cplt(&g_rp_log);
+  *         }
+  *     }
+  *
+  *     data 直接指向环形缓冲区内存（零拷贝），该段缓冲区在 tx_cplt() 之后才会被释放。
+  *     RP_LOG_USE_TX_CPLT 为 0 时 RP_Log_Transmit 返回即释放，DMA 还在读取的内存会被新日志覆盖；
+  *     HAL 启用了 UART 和 DMA 模块而未设置 RP_LOG_USE_TX_CPLT 时，编译 RP_Log.c 会给出警告
+  *
+  *     HAL库阻塞示例（RP_LOG_USE_TX_CPLT 为 0，函数返回即视为发送完成）:
+  *     int RP_Log_Transmit(const uint8_t *data, uint16_t length)
+  *     {
+  *         return (HAL_UART_Transmit(&huart1, (uint8_t *)data, length, 100) == HAL_OK) ? 0 : -1;
+  *     }
+  *
   * (#) 日志输出接口（在任意文件中包含此头文件即可使用）
   *     直接使用 RP_LOG_XXX 宏输出日志，示例如下：
   *     RP_LOG_INFO("System started");
@@ -40,8 +59,140 @@
   *         osDelay(1);
   *     }
   *
+  *     事件驱动（可选）：设置 notify 回调，有新日志或发送完成后仍有数据时调用，
+  *     日志线程在 work() 之后阻塞等待，空闲时不再每毫秒唤醒一次：
+  *     void log_notify(RP_Log_t *log) { osThreadFlagsSet(log_thread_id, 0x01); }
+  *     g_rp_log.notify = log_notify;
+  *     while(1) {
+  *         g_rp_log.work(&g_rp_log);
+  *         osThreadFlagsWait(0x01, osFlagsWaitAny, 100);
+  *     }
+  *     notify 可能在中断中调用，需使用可在中断中调用的 RTOS 接口
+  *
   * (#) RTT输出配置（在 RP_Log.c 中设置 RP_LOG_USE_RTT 为 1 启用）
-  *     需要在项目中集成 SEGGER_RTT 库
+  *     需要在项目中集成 SEGGER_RTT 库，RTT 作为 g_rp_log_rtt 输出由 work() 写入
+  *
+  * (#) 多路输出（CAN、USB CDC、RAM 等，最多 RP_LOG_SINK_MAX 个）
+  *     int usb_transmit(RP_LogSink_t *sink, const uint8_t *data, uint16_t length)
+  *     {
+  *         return (CDC_Transmit_FS((uint8_t *)data, length) == USBD_OK) ? 0 : -1;
+  *     }
+  *     RP_LogSink_t usb_sink = {.transmit = usb_transmit, .output_range = RP_LOG_OUTPUT_ALL,
+  *                              .batch_max = 256, .async = 1};
+  *     g_rp_log.add_sink(&g_rp_log, &usb_sink);          // 在启动日志线程前调用
+  *     g_rp_log.sink_cplt(&g_rp_log, &usb_sink);         // async 为 1 时在发送完成回调中调用
+  *     各输出有独立的读指针和 output_range，日志只在环形缓冲区中存一份，
+  *     最慢的输出读完后才回收空间；长期发送失败的输出应 remove_sink()
+  *
+  * (#) 延迟格式化（设置 RP_LOG_USE_DEFERRED 为 1 启用）
+  *     write() 只记录格式串指针、文件/行号、时间戳和原始参数，
+  *     snprintf/vsnprintf 移到日志线程的 work() 中执行
+  *     注意: 格式串必须是字符串常量；%s 参数在写入时按值拷贝（最长 RP_LOG_DEFER_STR_MAX）
+  *
+  * (#) C++ 前端（C++17，用 RP_Log.hpp 代替本头文件，宏的用法不变）
+  *     格式串在编译期解析，参数个数或类型与说明符不符时编译报错；
+  *     延迟格式化时参数按编译期确定的偏移直接打包，经 write_args() 写入，不扫描格式串
+  *
+  * (#) 微秒时间戳（设置 RP_LOG_TIMESTAMP_SOURCE 为 RP_LOG_TS_DWT 启用）
+  *     写日志时只读取 DWT->CYCCNT（扩展到 64 位），换算成微秒在格式化时进行
+  *     需 Cortex-M3 及以上；work() 调用间隔需小于半个回绕周期（168MHz 时约 12.7s）
+  *
+  * (#) 内置格式化（设置 RP_LOG_USE_LITE_FORMAT 为 1 启用）
+  *     不链接 newlib 的 printf，支持 %d %i %u %x %X %o %c %s %p %f 及标志、宽度、精度
+  *     %e %g 按 %f 输出；%f 精度最多 9 位，舍入与 printf 相同；绝对值不小于 2^64（约 1.8e19）时
+  *     改按 %e 格式输出（如 1.844674e+19），末位可能与 printf 相差 1；RP_LOG_LITE_FLOAT 为 0 时 %f 输出 "?"
+  *
+  * (#) 二进制帧（设置 RP_LOG_USE_BINARY 为 1 启用，需 RP_LOG_USE_DEFERRED）
+  *     每条日志封装为带序号和 CRC 的二进制帧，文件名、格式串只传地址，由上位机结合 ELF 还原
+  *     还原工具见 RP_Log_tools/rp_log_decode.c
+  *     帧内换行等字节经过转义并以 "\r\n" 结尾，TF_Log 模块仍按行写入 SD 卡
+  *
+  * (#) 流式压缩（设置 RP_LOG_USE_COMPRESS 为 1 启用）
+  *     串口每次发送的内容压缩为一个压缩帧（帧格式同二进制帧），窗口跨帧保留，
+  *     重复的前缀、文件名、电机名只发送引用；文本和二进制帧都可压缩
+  *     .LOG 文件用 rp_log_decode 解压还原；其他输出设置 sink.compress 指向各自的 RP_LogCompress_t
+  *
+  * (#) 运行时指定缓冲区（可选，不调用时 g_rp_log 使用 RP_LOG_RING_BUFFER_SIZE 的静态缓冲区）
+  *     static uint8_t log_mem[16384] __attribute__((section(".dtcmram")));
+  *     RP_Log_Init(&g_rp_log, log_mem, sizeof(log_mem), NULL); // 在写第一条日志前调用
+  *     多个实例：每个实例一块内存、各自的输出和日志线程（或在同一线程中依次调用 work()）
+  *     RP_Log_t g_gimbal_log;
+  *     RP_Log_Init(&g_gimbal_log, gimbal_mem, sizeof(gimbal_mem), &gimbal_cfg);
+  *     g_gimbal_log.add_sink(&g_gimbal_log, &gimbal_sink);
+  *     在云台文件中包含本头文件前 #define RP_LOG_INSTANCE (&g_gimbal_log)，RP_LOG_XXX 宏即写入该实例
+  *
+  * (#) 高优先级通道（设置 RP_LOG_USE_LANE 为 1 启用）
+  *     FATAL/ERROR/WARN 写入单独的 RP_LOG_LANE_SIZE 字节缓冲区，TRACE 刷屏占满主缓冲区时也能写入；
+  *     work() 在两条日志之间优先发出通道中的日志，通道满时改写主缓冲区；两路之间按时间戳恢复先后顺序
+  *
+  * (#) 任务暂存区（设置 RP_LOG_USE_STAGE 为 1 启用）
+  *     static RP_LogStage_t chassis_stage = {.name = "chassis"};
+  *     void Chassis_Task(void *arg)
+  *     {
+  *         g_rp_log.add_stage(&g_rp_log, &chassis_stage); // 在本任务中调用一次
+  *         ...
+  *     }
+  *     注册的任务写入自己的暂存区，不与其他任务争用主缓冲区；work() 按时间戳并入主缓冲区，
+  *     暂存区满时丢弃的条数以 "N messages dropped in chassis" 报告；中断和未注册的任务仍直接写主缓冲区
+  *
+  * (#) 按模块过滤（设置 RP_LOG_USE_FILTER 为 1 启用）
+  *     在云台文件中包含本头文件前 #define RP_LOG_MODULE 3（各文件默认为模块 0）
+  *     g_rp_log.set_filter(&g_rp_log, RP_LOG_MODULE_ALL, RP_LOG_OUTPUT_FATAL_TO_INFO);
+  *     g_rp_log.set_filter(&g_rp_log, 3, RP_LOG_OUTPUT_FATAL_TO_DEBUG);         // 只有云台输出 DEBUG
+  *     也可在调试器中修改 g_rp_log.filter[]，或在串口接收中调用 filter_cmd() 处理 "CMD:LOG_FILTER=3,4"
+  *     被过滤的日志在宏中只读一次 filter[] 比较，不调用 write()；output_range 仍对所有模块生效
+  *
+  * (#) 复位后找回日志（设置 RP_LOG_USE_NOINIT 为 1 启用，链接脚本需有 NOLOAD 的 .noinit 段）
+  *     int main(void)
+  *     {
+  *         g_rp_log.recover(&g_rp_log); // 在第一条日志之前调用
+  *         ...
+  *     }
+  *     环形缓冲区不被启动代码清零，看门狗、HardFault 复位后上次尚未从串口发出的日志最先发出，
+  *     之后插入一行 "N messages recovered from before reset"；上电或固件（build-id）变化时清空，
+  *     记录中的格式串、文件名指针不在只读区时从该条截断
+  *
+  * (#) 异常中同步发出（panic_flush）
+  *     void HardFault_Handler(void)
+  *     {
+  *         g_rp_log.panic_flush(&g_rp_log); // 经 RP_Log_PanicTransmit 轮询发送缓冲区中的全部日志
+  *         NVIC_SystemReset();
+  *     }
+  *     RP_Log_PanicTransmit 需用户实现（如 HAL_UART_AbortTransmit 后 HAL_UART_Transmit），不使用中断和 DMA
+  *
+  * (#) 原始数据（CAN 帧、裁判系统数据等，不经过格式化）
+  *     RP_LOG_HEX(RP_LOG_LEVEL_TRACE, rx_data, 8);        // 十六进制："[TRACE][can.c:42]: 01 02 03 04 05 06 07 08"
+  *     RP_LOG_RAW(RP_LOG_LEVEL_DEBUG, rx_buf, rx_len);    // 可打印字符原样输出，其他字节显示为 '.'
+  *     写入时只拷贝数据，展开在 work() 中进行（二进制帧模式下由上位机展开），
+  *     超过 RP_LOG_HEX_LINE_BYTES 的数据分多行输出、行首带偏移；单条最多约 RP_LOG_ENTRY_MAX_SIZE 字节，超出部分截断
+  *
+  * (#) 变量采样（设置 RP_LOG_USE_TELEMETRY 为 1 启用，PID 设定值/反馈等高频波形）
+  *     RP_LOG_VAR(pid_set, RP_LOG_VAR_FLOAT);             // 初始化时注册一次（最多 RP_LOG_TELEMETRY_VAR_MAX 个）
+  *     RP_LOG_VAR(pid_fb, RP_LOG_VAR_FLOAT);
+  *     g_rp_log.config_param.sample_divider = 2;          // 每调用 2 次 sample() 采样一次
+  *     g_rp_log.sample(&g_rp_log);                        // 在控制周期（如 1kHz 任务）中调用
+  *     采样只按类型拷贝各变量的原始值，文本行 "@tel 序号 pid_set=1.000 pid_fb=0.998" 在 work() 中生成，
+  *     二进制帧模式下发出采样帧和变量表帧，rp_log_histogram -t 导出为 CSV 波形
+  *
+  * (#) 运行统计（RP_LOG_USE_STATS，默认启用）
+  *     RP_LogStats_t stats;
+  *     g_rp_log.get_stats(&g_rp_log, &stats);
+  *     各等级写入/过滤/丢弃条数、缓冲区最高占用、发送次数/失败次数/字节数/速率，
+  *     RP_LOG_STATS_CYCLES 为 1 时还有 write() 最长/平均周期数
+  *     config_param.stats_period_ms 不为 0 时 work() 按该间隔输出一行 INFO 统计
+  *
+  * (#) 限频与去重（同一条日志每个控制周期都触发时，避免占满缓冲区）
+  *     RP_LOG_ERROR_EVERY_MS(1000, "Motor Offline:%s", name); // 本调用位置每秒最多一条
+  *     被抑制时只做一次时间比较，参数不求值；下一条输出前插入 "N messages suppressed"
+  *     RP_LOG_USE_DEDUP 为 1 时，普通日志宏在参数与本调用位置上一条相同时只计数，
+  *     参数变化或每 RP_LOG_DEDUP_REPORT_MS 输出一行 "last message repeated N times"
+  *     去重在格式化之前按格式串比较参数（%s 比较内容），RP_LOG_XXX 宏的值为 write_site() 的返回值
+  *     （需 GNU 语句表达式，GCC、Clang、ARMCLANG 均支持）
+  *
+  * (#) 缓冲区满（config_param.overflow_policy）
+  *     丢弃的条数会累计，work() 在下一次发送前插入一行 "N messages dropped"
+  *     DISCARD_OLDEST: write() 丢弃最早的待发日志腾出空间后写入新日志，不丢弃正在发送的日志
+  *     DISCARD_OLDEST 时日志先拷入发送缓冲区再发送，DMA 发送期间不占住环形缓冲区
   *
   * ==============================================================================
                        ##### Working Principle #####
@@ -49,7 +200,8 @@
   * - 调用 g_rp_log.write() 时，日志内容被写入环形缓冲区（不阻塞）
   * - 在独立日志线程中循环调用 g_rp_log.work() 从环形缓冲区取出日志并发送
   * - 这种设计避免了串口正忙导致的日志丢失问题
-  * - 支持RTT输出（需要使能 RP_LOG_USE_RTT）
+  * - write() 无锁（CAS 预留 + 提交），可在中断和多个任务中同时调用，不关中断
+  * - 支持RTT输出（需要使能 RP_LOG_USE_RTT）和用户注册的其他输出，各输出独立读取同一个环形缓冲区
   *
   * ==============================================================================
                        ##### Output Format #####
@@ -97,64 +249,582 @@ extern "C"
         RP_LOG_OUTPUT_ALL             // 输出所有级别
     } RP_LogOutputRange_t;
 
+// 日志等级数值（用于预处理器判断，与 RP_LogLevel_t 一致）
+#define RP_LOG_LVL_FATAL 0
+#define RP_LOG_LVL_ERROR 1
+#define RP_LOG_LVL_WARN 2
+#define RP_LOG_LVL_INFO 3
+#define RP_LOG_LVL_DEBUG 4
+#define RP_LOG_LVL_TRACE 5
+
+#define RP_LOG_MODULE_ALL 0xFF // set_filter() 的模块参数：所有模块
+
+// 时间戳来源（RP_LOG_TIMESTAMP_SOURCE）
+#define RP_LOG_TS_HAL_TICK 0 // HAL_GetTick()，1ms 分辨率，输出 "[毫秒]"
+#define RP_LOG_TS_DWT 1      // DWT CYCCNT 内核周期计数，输出 "[秒.微秒]"
+
 /*Config param start----------------------------------------------------------*/
+#ifndef RP_LOG_COMPILE_LEVEL
+#define RP_LOG_COMPILE_LEVEL RP_LOG_LVL_TRACE // 编译期保留的最低等级，低于此等级的宏连同参数、字符串一起编译为空
+#endif
+#ifndef RP_LOG_ENTRY_MAX_SIZE
 #define RP_LOG_ENTRY_MAX_SIZE 256 // 单条日志最大长度
-#define RP_LOG_RING_BUFFER_CNT 16 // 环形缓冲区可存储的日志条目数量
+#endif
+#ifndef RP_LOG_RING_BUFFER_SIZE
+#define RP_LOG_RING_BUFFER_SIZE 4096 // g_rp_log 默认环形缓冲区字节数（2的幂，不超过32768），RP_Log_Init() 可在运行时另设
+#endif
+#ifndef RP_LOG_RING_BUFFER_CNT
+#define RP_LOG_RING_BUFFER_CNT 128 // 默认环形缓冲区条目数（2的幂，不超过16384），RP_Log_Init() 按同样比例分配
+#endif
+#ifndef RP_LOG_HEX_LINE_BYTES
+#define RP_LOG_HEX_LINE_BYTES 16 // RP_LOG_HEX 每行输出的字节数（RP_LOG_RAW 每行为其 3 倍，行宽相同）
+#endif
+#ifndef RP_LOG_USE_TX_CPLT
+#define RP_LOG_USE_TX_CPLT 0 // 异步发送（1=发送完成后由 tx_cplt() 释放缓冲区，DMA发送时必须启用）
+#define RP_LOG_TX_CPLT_DEFAULT // 未设置 RP_LOG_USE_TX_CPLT（RP_Log.c 在 HAL 启用 UART DMA 时警告）
+#endif
+#ifndef RP_LOG_USE_DEFERRED
+#define RP_LOG_USE_DEFERRED 0 // 延迟格式化（1=启用，格式化在 work() 中进行）
+#endif
+#ifndef RP_LOG_DEFER_ARG_MAX
+#define RP_LOG_DEFER_ARG_MAX 64 // 延迟格式化单条日志参数区最大字节数
+#endif
+#ifndef RP_LOG_DEFER_STR_MAX
+#define RP_LOG_DEFER_STR_MAX 32 // 延迟格式化 %s 参数最大拷贝长度
+#endif
+#ifndef RP_LOG_TIMESTAMP_SOURCE
+#define RP_LOG_TIMESTAMP_SOURCE RP_LOG_TS_HAL_TICK // 时间戳来源（RP_LOG_TS_HAL_TICK / RP_LOG_TS_DWT）
+#endif
+#ifndef RP_LOG_DWT_FREQ_HZ
+#define RP_LOG_DWT_FREQ_HZ SystemCoreClock // DWT CYCCNT 计数频率（内核时钟，Hz）
+#endif
+#ifndef RP_LOG_USE_LITE_FORMAT
+#define RP_LOG_USE_LITE_FORMAT 0 // 内置格式化（1=不使用 printf 系列函数，0=使用 vsnprintf）
+#endif
+#ifndef RP_LOG_LITE_FLOAT
+#define RP_LOG_LITE_FLOAT 1 // 内置格式化的 %f 支持（1=定点输出，精度最多9位，不小于2^64时按%e输出；0=输出 "?"，不链接浮点代码）
+#endif
+#ifndef RP_LOG_USE_BINARY
+#define RP_LOG_USE_BINARY 0 // 二进制帧输出（1=启用，需同时启用 RP_LOG_USE_DEFERRED）
+#endif
+#ifndef RP_LOG_USE_STATS
+#define RP_LOG_USE_STATS 1 // 运行统计（1=启用，get_stats() 读取；每次写日志多几次原子加）
+#endif
+#ifndef RP_LOG_STATS_CYCLES
+#define RP_LOG_STATS_CYCLES (RP_LOG_TIMESTAMP_SOURCE == RP_LOG_TS_DWT) // 统计 write() 周期数（读取 DWT CYCCNT，需 Cortex-M3 及以上）
+#endif
+#ifndef RP_LOG_USE_DEDUP
+#define RP_LOG_USE_DEDUP 0 // 普通日志宏按调用位置去重（1=参数与上一条相同时只计数，输出 "last message repeated N times"）
+#endif
+#ifndef RP_LOG_DEDUP_REPORT_MS
+#define RP_LOG_DEDUP_REPORT_MS 1000 // 持续重复时输出重复次数的间隔
+#endif
+#ifndef RP_LOG_USE_COMPRESS
+#define RP_LOG_USE_COMPRESS 0 // 串口输出流式压缩（1=每次发送压缩为一个压缩帧，上位机 rp_log_decode 解压）
+#endif
+#ifndef RP_LOG_COMPRESS_WINDOW_BITS
+#define RP_LOG_COMPRESS_WINDOW_BITS 9 // 压缩窗口 2^n 字节（8~12，越大压缩率越高，匹配长度上限越小）
+#endif
+#ifndef RP_LOG_COMPRESS_HASH_BITS
+#define RP_LOG_COMPRESS_HASH_BITS 8 // 匹配查找哈希表 2^n 项（每项 2 字节）
+#endif
+#ifndef RP_LOG_COMPRESS_RESET_BLOCKS
+#define RP_LOG_COMPRESS_RESET_BLOCKS 32 // 每隔多少块不引用历史数据，丢帧后解码器最多跳过这么多块
+#endif
+#ifndef RP_LOG_USE_TELEMETRY
+#define RP_LOG_USE_TELEMETRY 0 // 变量采样（1=启用，add_var() 注册变量，sample() 在控制周期中采样）
+#endif
+#ifndef RP_LOG_TELEMETRY_VAR_MAX
+#define RP_LOG_TELEMETRY_VAR_MAX 16 // 最多注册的变量个数（每次采样最多 RP_LOG_TELEMETRY_VAR_MAX * 4 字节）
+#endif
+#ifndef RP_LOG_TELEMETRY_LEVEL
+#define RP_LOG_TELEMETRY_LEVEL RP_LOG_LVL_DEBUG // 采样记录的等级（按 output_range 过滤）
+#endif
+#ifndef RP_LOG_TELEMETRY_SCHEMA_PERIOD
+#define RP_LOG_TELEMETRY_SCHEMA_PERIOD 256 // 二进制帧模式下每隔多少次采样重发一次变量表帧
+#endif
+#ifndef RP_LOG_USE_LANE
+#define RP_LOG_USE_LANE 0 // 高优先级通道（1=RP_LOG_LANE_LEVEL 及以上的日志写入单独的缓冲区，work() 先发出）
+#endif
+#ifndef RP_LOG_LANE_SIZE
+#define RP_LOG_LANE_SIZE 1024 // 高优先级通道字节数（2的幂，不小于 RP_LOG_ENTRY_MAX_SIZE），从 arena 开头划出
+#endif
+#ifndef RP_LOG_LANE_CNT
+#define RP_LOG_LANE_CNT 32 // 高优先级通道条目数（2的幂）
+#endif
+#ifndef RP_LOG_LANE_LEVEL
+#define RP_LOG_LANE_LEVEL RP_LOG_LVL_WARN // 写入高优先级通道的最低等级（FATAL ~ 该等级）
+#endif
+#ifndef RP_LOG_USE_STAGE
+#define RP_LOG_USE_STAGE 0 // 任务暂存区（1=add_stage() 注册的任务写入各自的缓冲区，work() 按时间戳并入主缓冲区）
+#endif
+#ifndef RP_LOG_STAGE_MAX
+#define RP_LOG_STAGE_MAX 4 // 最多注册的暂存区个数
+#endif
+#ifndef RP_LOG_STAGE_SIZE
+#define RP_LOG_STAGE_SIZE 512 // 每个暂存区的数据字节数（2的幂，不小于 RP_LOG_ENTRY_MAX_SIZE），位于 RP_LogStage_t 中
+#endif
+#ifndef RP_LOG_STAGE_CNT
+#define RP_LOG_STAGE_CNT 16 // 每个暂存区的条目数（2的幂）
+#endif
+#ifndef RP_LOG_USE_FILTER
+#define RP_LOG_USE_FILTER 0 // 按模块过滤（1=RP_LOG_XXX 宏先查本模块的等级掩码，被过滤时不调用 write()，参数不求值）
+#endif
+#ifndef RP_LOG_MODULE_MAX
+#define RP_LOG_MODULE_MAX 16 // 模块数（RP_LOG_MODULE 取 0 ~ RP_LOG_MODULE_MAX-1，不超过 255）
+#endif
+#ifndef RP_LOG_USE_NOINIT
+#define RP_LOG_USE_NOINIT 0 // 环形缓冲区放在不清零的 RAM 段（1=复位后由 recover() 找回尚未发出的日志）
+#endif
+#ifndef RP_LOG_NOINIT_SECTION
+#define RP_LOG_NOINIT_SECTION ".noinit" // 不清零的段名（链接脚本中需为 NOLOAD）
+#endif
+// RP_LOG_NOINIT_BUILD_ID：固件标识，不同固件留下的内容不恢复。默认取 GNU build-id（链接时加 -Wl,--build-id，
+// 链接脚本导出 g_rp_log_build_id，见 README）；也可由构建系统给出每次链接都不同的字符串，如 -DRP_LOG_NOINIT_BUILD_ID=\"...\"
+#ifndef RP_LOG_NOINIT_ROM_START
+#define RP_LOG_NOINIT_ROM_START g_pfnVectors // 格式串、文件名所在只读区的起始（默认向量表，即 flash 开头）
+#endif
+#ifndef RP_LOG_NOINIT_ROM_END
+#define RP_LOG_NOINIT_ROM_END _sidata // 只读区的结束（默认 .data 初值的加载地址，在 .rodata 之后）
+#endif
+#ifndef RP_LOG_TX_BUFFER_SIZE
+#if RP_LOG_USE_COMPRESS
+#define RP_LOG_TX_BUFFER_SIZE 1280 // 发送缓冲区大小（压缩时存放压缩帧，每块最多压缩 RP_LOG_COMPRESS_BLOCK_SIZE 字节，默认 561，不小于 batch_max）
+#elif RP_LOG_USE_DEFERRED
+#define RP_LOG_TX_BUFFER_SIZE (RP_LOG_ENTRY_MAX_SIZE * 2) // 发送缓冲区大小（延迟格式化时不小于 RP_LOG_ENTRY_MAX_SIZE）
+#else
+#define RP_LOG_TX_BUFFER_SIZE 128 // 发送缓冲区大小（非延迟格式化时存放丢弃提示行和原始数据展开的一行；DISCARD_OLDEST 时每次发送不超过此大小，建议不小于 batch_max）
+#endif
+#endif
+#ifndef RP_LOG_SINK_MAX
+#define RP_LOG_SINK_MAX 4 // 最多同时注册的输出数（含默认串口输出，每个输出有一份 RP_LOG_TX_BUFFER_SIZE 的发送缓冲区）
+#endif
+#if RP_LOG_USE_COMPRESS
+// 每块最多压缩的字节数：全部为字面量且全部转义时，压缩帧 17 + n * 9 / 4 字节仍放得进 tx_buffer
+#define RP_LOG_COMPRESS_BLOCK_SIZE ((RP_LOG_TX_BUFFER_SIZE - 17) * 4 / 9)
+#endif
+
+    // 二进制帧格式（RP_LOG_USE_BINARY）
+    // 帧：SYNC | 类型 | 序号(2) | 负载 | CRC16(2) | "\r\n"，多字节字段均为小端
+    // SYNC 之后到 CRC 为止，0x00 '\n' '\r' ESC SYNC 转义为 ESC, 字节^0x20；CRC16-CCITT（初值 0xFFFF）覆盖类型到负载
+#define RP_LOG_FRAME_SYNC 0xA5    // 帧起始
+#define RP_LOG_FRAME_ESC 0x7D     // 转义符
+#define RP_LOG_FRAME_ESC_XOR 0x20 // 转义异或值
+#define RP_LOG_FRAME_RECORD 0x01  // 日志记录：等级(1) | 行号(2) | 时间戳(4/8) | 文件名地址(4) | 格式串地址(4) | 打包参数
+#define RP_LOG_FRAME_DROPPED 0x02 // 丢弃提示：丢弃条数(4)
+#define RP_LOG_FRAME_LZ 0x03      // 压缩块（RP_LOG_USE_COMPRESS）：标志(1) | LZ 数据，解压后为未压缩时的输出字节流
+#define RP_LOG_FRAME_DATA 0x04    // 原始数据：等级(1) | 行号(2) | 时间戳(4/8) | 文件名地址(4) | 方式(1) | 偏移(2) | 数据
+#define RP_LOG_FRAME_SAMPLE 0x05  // 变量采样：等级(1) | 采样序号(2) | 时间戳(4/8) | 变量数(1) | 各变量原始值
+#define RP_LOG_FRAME_SCHEMA 0x06  // 变量表：变量数(1) | 各变量 类型(1) + 变量名地址(4)
+#define RP_LOG_FRAME_TICK64 0x80  // 类型标志：时间戳为 8 字节（DWT）
+#define RP_LOG_LZ_RESET 0x80      // 压缩块标志：不引用之前的块（低 4 位为窗口位数）
+
+    // 原始数据的显示方式（RP_LOG_HEX / RP_LOG_RAW），二进制帧中还带有以下标志
+#define RP_LOG_DATA_HEX 0x00   // 十六进制，字节之间以空格分隔
+#define RP_LOG_DATA_RAW 0x01   // 可打印字符原样输出，其他字节显示为 '.'
+#define RP_LOG_DATA_SPLIT 0x40 // 标志：整条数据分多行（多帧）输出，行首带偏移
+#define RP_LOG_DATA_CUT 0x80   // 标志：数据超过单条上限被截断，最后一行末尾显示 " ..."
+
+    // 缓冲区满时的处理策略（与 TF_Log 模块的 RINGBUF_POLICY 命令对应）
+    typedef enum
+    {
+        RP_LOG_OVERFLOW_DISCARD_NEWEST = 0, // 丢弃新日志，保留缓冲区中的旧日志
+        RP_LOG_OVERFLOW_DISCARD_OLDEST      // 丢弃最早的日志，为新日志腾出空间
+    } RP_LogOverflowPolicy_t;
 
     // 配置参数结构体
     typedef struct
     {
-        RP_LogOutputRange_t output_range; // 日志输出范围
-        uint8_t use_timestamp;            // 是否使用时间戳（1=启用，0=禁用）
-        uint8_t rtt_use_color;            // RTT是否使用颜色（1=启用，0=禁用）
+        RP_LogOutputRange_t output_range;       // 日志输出范围
+        uint8_t use_timestamp;                  // 是否使用时间戳（1=启用，0=禁用）
+        uint8_t rtt_use_color;                  // RTT是否使用颜色（1=启用，0=禁用）
+        RP_LogOverflowPolicy_t overflow_policy; // 缓冲区满时的处理策略
+        uint32_t stats_period_ms;               // 周期输出统计行的间隔（0=不输出，需 RP_LOG_USE_STATS 和时间戳来源）
+        uint16_t sample_divider;                // 变量采样分频：sample() 每调用 n 次采样一次（0=不采样，RP_LOG_USE_TELEMETRY）
     } RP_LogConfigParam_t;
 
     /*Config param end------------------------------------------------------------*/
 
-    // 环形缓冲区条目
+    // 环形缓冲区条目类型
+    typedef enum
+    {
+        RP_LOG_ENTRY_TEXT = 0, // 已格式化的文本，可直接发送
+        RP_LOG_ENTRY_DEFERRED, // 延迟格式化记录，需在 work() 中格式化
+        RP_LOG_ENTRY_DATA,     // 原始数据（RP_LOG_HEX / RP_LOG_RAW），在 work() 中展开
+        RP_LOG_ENTRY_SAMPLE    // 变量采样（RP_LOG_USE_TELEMETRY），在 work() 中展开
+    } RP_LogEntryType_t;
+
+    // 采样变量类型（值按小端原样发送，RP_LOG_USE_TELEMETRY）
+    typedef enum
+    {
+        RP_LOG_VAR_U8 = 0, // uint8_t
+        RP_LOG_VAR_I8,     // int8_t
+        RP_LOG_VAR_U16,    // uint16_t
+        RP_LOG_VAR_I16,    // int16_t
+        RP_LOG_VAR_U32,    // uint32_t
+        RP_LOG_VAR_I32,    // int32_t
+        RP_LOG_VAR_FLOAT   // float
+    } RP_LogVarType_t;
+
+    // 已注册的采样变量
     typedef struct
     {
-        uint8_t data[RP_LOG_ENTRY_MAX_SIZE]; // 日志数据
-        uint16_t length;                     // 数据长度
-    } RP_LogEntry_t;
+        const char *name;           // 变量名（需为常量字符串，二进制帧只发送地址）
+        const volatile void *addr;  // 变量地址（按类型对齐）
+        uint8_t type;               // RP_LogVarType_t
+    } RP_LogVar_t;
 
-    // 环形缓冲区结构体
+    // 环形缓冲区结构体（变长字节环，读写指针自由递增，取模得到实际位置）
+    // 条目描述（长度前缀）与数据分开存放，使各条日志在 data 中首尾相接
+    // 多生产者无锁：写日志时先 CAS 预留空间，拷贝完成后再提交条目描述
+    // 多消费者：每个输出一个读指针，tail 为最慢的已启用输出的读指针，之前的空间才可复用
+    // 数据和条目描述紧跟在头部之后（RP_Log_Init() 在用户内存上划分），尺寸在运行时确定
     typedef struct
     {
-        RP_LogEntry_t entries[RP_LOG_RING_BUFFER_CNT]; // 日志条目数组
-        volatile uint16_t head;                        // 写指针
-        volatile uint16_t tail;                        // 读指针
-        volatile uint16_t count;                       // 当前日志数量
+        uint8_t *data;                                     // 日志数据（size 字节）
+        volatile uint32_t *entries;                        // 条目描述（cnt 项）：提交标记 | 等级 | 类型 | 长度
+        uint16_t size;                                     // 数据字节数（2的幂，不超过32768）
+        uint16_t cnt;                                      // 条目数（2的幂，不超过16384）
+        volatile uint32_t head;                            // 写指针：条目写指针(高16位) | 数据写指针(低16位)
+        volatile uint32_t tail;                            // 回收指针：条目(高16位) | 数据(低16位)，由 work() 回收和 DISCARD_OLDEST 的写入方推进（CAS）
+        volatile uint32_t cursor[RP_LOG_SINK_MAX];         // 各输出的读指针（格式同 tail）
+        uint16_t entry_sent[RP_LOG_SINK_MAX];              // 各输出在当前条目已发送的字节数
+        volatile uint32_t active;                          // 已启用输出的位掩码（参与回收和唤醒判断）
+        volatile uint32_t pinned;                          // 正在读取读指针处条目的输出的位掩码（DISCARD_OLDEST 不越过其读指针）
+        volatile uint32_t evicting;                        // 非 0 表示有写入方正在丢弃最早的条目
+#if RP_LOG_USE_NOINIT
+        uint32_t magic;                                    // 复位后检查内容是否有效：固定值
+        uint32_t layout;                                   // 缓冲区尺寸和固件编译时间的摘要
+        uint32_t check;                                    // ~(magic ^ layout)
+#endif
     } RP_LogRingBuffer_t;
 
+    // 任务暂存区（RP_LOG_USE_STAGE）：注册任务独占的环形缓冲区，写日志时不与其他任务争用同一个写指针
+    // work() 按写入时的时间戳把各暂存区的条目并入主缓冲区；暂存区满时丢弃的条数记在本任务名下
+    typedef struct
+    {
+        const char *name;                                  // 任务名（丢弃提示行中使用，可为 NULL）
+        void *task;                                        // 所属任务（add_stage() 在调用的任务中记录）
+        RP_LogRingBuffer_t *ring;                          // 暂存区（位于 mem 中，add_stage() 划分）
+        volatile uint32_t dropped;                         // 因暂存区满丢弃的日志累计条数
+        uint32_t dropped_seen;                             // 已报告的丢弃条数
+        uint32_t stamps[RP_LOG_STAGE_CNT];                 // 各条目预留时的时间戳（低 32 位），并入时比较先后
+        uint64_t mem[(sizeof(RP_LogRingBuffer_t) + RP_LOG_STAGE_CNT * sizeof(uint32_t) + RP_LOG_STAGE_SIZE + 7) / 8]; // 头部 | 条目描述 | 数据
+    } RP_LogStage_t;
+
+#if RP_LOG_USE_COMPRESS
+    // 流式压缩状态（LZSS），每个压缩输出一份；窗口跨块保留，短日志行也能引用前几行的内容
+    typedef struct
+    {
+        uint8_t window[(1 << RP_LOG_COMPRESS_WINDOW_BITS) + RP_LOG_COMPRESS_BLOCK_SIZE]; // 历史数据 | 当前块
+        uint16_t hash[1 << RP_LOG_COMPRESS_HASH_BITS];                                    // 三字节哈希对应的最近位置 + 1（0=空）
+        uint16_t history;                                                                 // window 中历史数据长度
+        uint16_t blocks;                                                                  // 距上次重置的块数（0=下一块重置）
+        uint16_t seq;                                                                     // 压缩帧序号
+    } RP_LogCompress_t;
+#endif
+
+    // 日志输出（sink）：在共享环形缓冲区上有独立的读指针和等级范围，日志只存一份
+    // 慢速输出不阻塞快速输出，缓冲区空间在最慢的已启用输出读完后回收
+    typedef struct RP_LogSink_struct_t
+    {
+        // 用户设置
+        int (*transmit)(struct RP_LogSink_struct_t *sink, const uint8_t *data, uint16_t length); // 发送（0=成功，-1=失败，数据保留下次重试）
+        void *user;                               // 用户数据（transmit 中使用）
+        RP_LogOutputRange_t output_range;         // 本输出的等级范围（在 config_param.output_range 之内再过滤）
+        uint16_t batch_max;                       // 单次发送最大字节数，合并多条日志（0=每次只发一条）
+        uint8_t async;                            // 异步发送（1=发送完成后调用 sink_cplt() 释放，DMA 发送时必须设置）
+        uint8_t text;                             // 二进制帧模式下仍输出文本行（RP_LOG_USE_BINARY，如 RTT）
+#if RP_LOG_USE_COMPRESS
+        RP_LogCompress_t *compress;               // 压缩状态（NULL=不压缩，g_rp_log_uart 默认压缩）
+#endif
+
+        // 内部状态（由日志模块维护）
+        uint8_t id;                               // 读指针序号（add_sink() 分配）
+        volatile uint8_t tx_busy;                 // 正在发送
+        uint8_t tx_marker;                        // 上一次发送的只有丢弃提示行
+        uint8_t level;                            // 本次发送的第一条日志的等级（transmit 中可读取）
+        uint16_t tx_advance;                      // 发送完成后读指针前进的字节数（0=发送的是 tx_buffer）
+        uint16_t tx_pending;                      // tx_buffer 中待发送的长度
+        uint32_t dropped_seen;                    // 已报告的丢弃条数（与 RP_Log_t.dropped 比较）
+        uint32_t lost;                            // DISCARD_OLDEST 丢掉的本输出未读日志条数
+        uint16_t data_sent;                       // 当前原始数据条目已展开的字节数、采样条目已展开的变量数（整条展开后读指针才前进）
+#if RP_LOG_USE_LANE
+        uint8_t lane;                             // 当前读取的是高优先级通道（只在两条日志之间切换）
+#endif
+#if RP_LOG_USE_TELEMETRY && RP_LOG_USE_BINARY
+        uint8_t tel_count;                        // 上次变量表帧描述的变量数（0=尚未发送）
+        uint16_t tel_since;                       // 上次变量表帧之后的采样帧数
+#endif
+#if RP_LOG_USE_BINARY
+        uint16_t tx_seq;                          // 二进制帧序号
+#endif
+        uint8_t tx_buffer[RP_LOG_TX_BUFFER_SIZE]; // 丢弃提示行、延迟格式化后的日志行
+    } RP_LogSink_t;
+
+    // 运行统计（RP_LOG_USE_STATS），get_stats() 返回不加锁的快照，各计数之间可能相差几条
+    typedef struct
+    {
+        uint32_t written[6];       // 各等级写入缓冲区的条数
+        uint32_t filtered[6];      // 各等级被 output_range 过滤的条数
+        uint32_t dropped[6];       // 各等级因缓冲区满未能写入的条数
+        uint32_t discarded;        // DISCARD_OLDEST 为新日志腾出空间丢掉的旧日志条数
+        uint32_t suppressed;       // 被限频、去重抑制的条数
+        uint32_t ring_peak;        // 环形缓冲区最高占用字节数
+        uint32_t entry_peak;       // 环形缓冲区最多条目数
+        uint32_t tx_count;         // 各输出 transmit 成功次数
+        uint32_t tx_failed;        // 各输出 transmit 失败次数（数据留在缓冲区中按原顺序重试）
+        uint64_t tx_bytes;         // 已交给各输出 transmit 的字节数
+        uint32_t tx_bytes_per_s;   // 最近一秒的发送速率（需时间戳来源）
+        uint64_t compress_in;      // 压缩前的字节数（RP_LOG_USE_COMPRESS）
+        uint64_t compress_out;     // 压缩帧字节数，compress_in / compress_out 为压缩率
+        uint32_t write_cycles_max; // write() 最长周期数（RP_LOG_STATS_CYCLES）
+        uint32_t write_cycles_avg; // write() 平均周期数（get_stats() 时计算）
+        uint64_t write_cycles_sum; // write() 累计周期数
+        uint64_t write_timed;      // 参与计时的 write() 次数
+    } RP_LogStats_t;
+
+    // 调用位置状态（限频、去重宏中的静态变量，每个调用位置一份）
+    typedef struct
+    {
+        volatile uint32_t last_ms;    // 上次输出的时间（毫秒，0=尚未输出）
+        volatile uint32_t suppressed; // 尚未报告的被抑制条数
+        uint32_t hash;                // 上次输出的参数摘要（去重）
+    } RP_LogSite_t;
+
     // 日志模块主结构体（函数指针API）
     typedef struct RP_Log_struct_t
     {
-        RP_LogConfigParam_t config_param; // 可配置参数
-        RP_LogRingBuffer_t ring_buffer;   // 环形缓冲区
+        RP_LogConfigParam_t config_param;         // 可配置参数
+        RP_LogRingBuffer_t *ring_buffer;          // 环形缓冲区（位于 arena 开头，RP_LOG_USE_LANE 时在高优先级通道之后）
+#if RP_LOG_USE_LANE
+        RP_LogRingBuffer_t *lane;                 // 高优先级通道（RP_LOG_LANE_LEVEL 及以上的日志，满时写入 ring_buffer）
+#endif
+        void *arena;                              // 环形缓冲区所用内存（RP_LOG_USE_NOINIT 时 g_rp_log 的位于 RP_LOG_NOINIT_SECTION 段）
+        uint32_t arena_size;                      // arena 字节数
+        RP_LogSink_t *sinks[RP_LOG_SINK_MAX];     // 已注册的输出（sinks[0] 默认为串口 g_rp_log_uart）
+        volatile uint32_t dropped;                // 因缓冲区满丢弃的日志累计条数（各输出分别报告）
+#if RP_LOG_USE_STATS
+        RP_LogStats_t stats;                      // 运行统计（用 get_stats() 读取）
+        volatile uint32_t stats_cycles;           // 尚未并入 stats 的 write() 周期数（由 work() 并入）
+        volatile uint32_t stats_calls;            // 尚未并入 stats 的 write() 次数
+        uint64_t stats_rate_tick;                 // 上次计算发送速率的时间戳
+        uint64_t stats_rate_bytes;                // 上次计算发送速率时的 tx_bytes
+        uint64_t stats_report_tick;               // 上次输出统计行的时间戳
+#endif
+#if RP_LOG_USE_TELEMETRY
+        RP_LogVar_t vars[RP_LOG_TELEMETRY_VAR_MAX]; // 已注册的采样变量（只追加）
+        volatile uint8_t var_count;               // 已注册的变量数
+        uint16_t sample_tick;                     // 距上次采样的 sample() 调用次数
+        uint16_t sample_seq;                      // 采样序号（上位机据此发现丢失的采样）
+#endif
+#if RP_LOG_USE_STAGE
+        RP_LogStage_t *volatile stages[RP_LOG_STAGE_MAX]; // 已注册的任务暂存区（只追加）
+        volatile uint32_t stage_count;            // 已占用的暂存区位置数
+#endif
+#if RP_LOG_USE_FILTER
+        volatile uint8_t filter[RP_LOG_MODULE_MAX]; // 各模块被过滤的等级（第 n 位为 1 时丢弃等级 n，0=全部输出），可在调试器中修改
+#endif
 
         int (*write)(struct RP_Log_struct_t *log, RP_LogLevel_t level, const char *file, int line, const char *format, ...); // 写日志
+        int (*write_site)(struct RP_Log_struct_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                          const char *format, ...);                                                                  // 写日志（按调用位置去重）
+        int (*write_data)(struct RP_Log_struct_t *log, RP_LogLevel_t level, const char *file, int line, uint8_t kind,
+                          const void *data, uint16_t length);                                                        // 写原始数据（不格式化）
+        int (*write_args)(struct RP_Log_struct_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                          const char *format, const void *args, uint16_t length);                                    // 写已打包参数的日志（RP_Log.hpp）
+        int (*rate_limit)(struct RP_Log_struct_t *log, RP_LogSite_t *site, uint32_t period_ms, RP_LogLevel_t level,
+                          const char *file, int line);                                                               // 限频检查（1=可以输出）
         void (*work)(struct RP_Log_struct_t *log);                                                                           // 处理输出
         uint16_t (*get_count)(struct RP_Log_struct_t *log);                                                                  // 获取数量
+        int (*get_stats)(struct RP_Log_struct_t *log, RP_LogStats_t *stats);                                                // 读取运行统计
         void (*flush)(struct RP_Log_struct_t *log);                                                                          // 清空缓冲区
+        void (*tx_cplt)(struct RP_Log_struct_t *log);                                                                        // 发送完成通知（sinks[0]）
+        int (*add_sink)(struct RP_Log_struct_t *log, RP_LogSink_t *sink);                                                    // 注册输出
+        void (*remove_sink)(struct RP_Log_struct_t *log, RP_LogSink_t *sink);                                                // 移除输出
+        void (*sink_cplt)(struct RP_Log_struct_t *log, RP_LogSink_t *sink);                                                  // 输出发送完成通知
+        int (*recover)(struct RP_Log_struct_t *log);                                                                         // 复位后找回日志（main() 开头调用）
+        void (*panic_flush)(struct RP_Log_struct_t *log);                                                                    // 同步发出全部日志（异常中调用）
+        int (*add_var)(struct RP_Log_struct_t *log, const char *name, const volatile void *addr, RP_LogVarType_t type);      // 注册采样变量
+        void (*sample)(struct RP_Log_struct_t *log);                                                                         // 采样已注册的变量（控制周期中调用）
+        int (*add_stage)(struct RP_Log_struct_t *log, RP_LogStage_t *stage);                                                 // 注册任务暂存区（在该任务中调用）
+        int (*set_filter)(struct RP_Log_struct_t *log, uint8_t module, RP_LogOutputRange_t range);                          // 设置模块的输出等级
+        int (*filter_cmd)(struct RP_Log_struct_t *log, const char *cmd, uint16_t length);                                   // 处理 "CMD:LOG_FILTER=模块,等级" 命令
+        void (*notify)(struct RP_Log_struct_t *log);                                                                         // 唤醒日志线程（用户设置，可为NULL）
     } RP_Log_t;
 
     /* Exported variables --------------------------------------------------------*/
     extern RP_Log_t g_rp_log;
+    extern RP_LogSink_t g_rp_log_uart; // 默认串口输出（经 RP_Log_Transmit 发送）
+    extern RP_LogSink_t g_rp_log_rtt;  // RTT 输出（RP_LOG_USE_RTT 为 1 时注册为 sinks[1]）
 
     /* Exported functions --------------------------------------------------------*/
 
+    // 在用户提供的内存上初始化日志实例（可选，不调用时 g_rp_log 使用默认的静态缓冲区）
+    int RP_Log_Init(RP_Log_t *log, void *buffer, uint32_t size, const RP_LogConfigParam_t *cfg);
+
     // 串口发送接口（用户需实现此函数）
     int RP_Log_Transmit(const uint8_t *data, uint16_t length);
 
+    // 串口轮询发送接口（panic_flush 使用，返回时数据已发完；未实现时 panic_flush 不发送）
+    int RP_Log_PanicTransmit(const uint8_t *data, uint16_t length);
+
     /* User macros --------------------------------------------------------------*/
 
-#define RP_LOG_FATAL(format, ...) g_rp_log.write(&g_rp_log, RP_LOG_LEVEL_FATAL, __FILE__, __LINE__, format, ##__VA_ARGS__)
-#define RP_LOG_ERROR(format, ...) g_rp_log.write(&g_rp_log, RP_LOG_LEVEL_ERROR, __FILE__, __LINE__, format, ##__VA_ARGS__)
-#define RP_LOG_WARN(format, ...) g_rp_log.write(&g_rp_log, RP_LOG_LEVEL_WARN, __FILE__, __LINE__, format, ##__VA_ARGS__)
-#define RP_LOG_INFO(format, ...) g_rp_log.write(&g_rp_log, RP_LOG_LEVEL_INFO, __FILE__, __LINE__, format, ##__VA_ARGS__)
-#define RP_LOG_DEBUG(format, ...) g_rp_log.write(&g_rp_log, RP_LOG_LEVEL_DEBUG, __FILE__, __LINE__, format, ##__VA_ARGS__)
-#define RP_LOG_TRACE(format, ...) g_rp_log.write(&g_rp_log, RP_LOG_LEVEL_TRACE, __FILE__, __LINE__, format, ##__VA_ARGS__)
+    // 源文件名（不含路径），尽量在编译期确定，写日志时不再扫描路径
+#if defined(RP_LOG_FILE)
+    // 由构建系统按文件指定，例如 -DRP_LOG_FILE=\"gimbal.c\"
+#elif defined(__FILE_NAME__) // GCC 12+、Clang 9+、ARMCLANG（AC6）
+#define RP_LOG_FILE __FILE_NAME__
+#elif defined(__CC_ARM) // ARMCC V5：__MODULE__ 为不含路径的文件名
+#define RP_LOG_FILE __MODULE__
+#elif defined(__GNUC__) // 旧版 GCC：常量字符串上的 __builtin_strrchr 在编译期折叠
+    // 先去掉最后一个 '\\' 之前的部分（Windows 路径），其中再有 '/' 时取其后
+#define RP_LOG_FILE_BSLASH (__builtin_strrchr("\\" __FILE__, '\\') + 1)
+#define RP_LOG_FILE                                                                              \
+    (__builtin_strrchr(RP_LOG_FILE_BSLASH, '/') ? __builtin_strrchr(RP_LOG_FILE_BSLASH, '/') + 1 \
+                                                : RP_LOG_FILE_BSLASH)
+#else
+    // 其他编译器：运行时单次扫描
+    static __inline const char *RP_Log_Basename(const char *path)
+    {
+        const char *name = path;
+        for (; *path != '\0'; path++)
+        {
+            if (*path == '/' || *path == '\\')
+            {
+                name = path + 1;
+            }
+        }
+        return name;
+    }
+#define RP_LOG_FILE RP_Log_Basename(__FILE__)
+#endif
+
+    // 宏写入的日志实例（默认 g_rp_log），可按文件指定，例如在包含本头文件前
+    // #define RP_LOG_INSTANCE (&g_gimbal_log)
+#ifndef RP_LOG_INSTANCE
+#define RP_LOG_INSTANCE (&g_rp_log)
+#endif
+
+    // 宏所属的模块（默认 0），可按文件指定，例如在包含本头文件前
+    // #define RP_LOG_MODULE 3，或由构建系统按目录指定 -DRP_LOG_MODULE=3
+#ifndef RP_LOG_MODULE
+#define RP_LOG_MODULE 0
+#endif
+
+    // 本模块是否过滤该等级：一次读取和比较，被过滤时宏不调用 write()，参数不求值、不格式化
+#if RP_LOG_USE_FILTER
+#define RP_LOG_FILTERED(level_) ((RP_LOG_INSTANCE->filter[RP_LOG_MODULE] >> (level_)) & 1U)
+#else
+#define RP_LOG_FILTERED(level_) 0
+#endif
+
+    // 写一条日志（RP_LOG_USE_DEDUP 为 1 时经过本调用位置的去重检查），值同 write()
+    // 去重需要每个调用位置一份静态状态，用 GNU 语句表达式保持宏仍是 int 表达式
+#if RP_LOG_USE_DEDUP
+#define RP_LOG_WRITE(level_, format, ...)                                                                             \
+    ({                                                                                                                \
+        static RP_LogSite_t rp_log_site_;                                                                             \
+        RP_LOG_FILTERED(level_) ? -1                                                                                  \
+                                : RP_LOG_INSTANCE->write_site(RP_LOG_INSTANCE, &rp_log_site_, (level_), RP_LOG_FILE, \
+                                                              __LINE__, format, ##__VA_ARGS__);                       \
+    })
+#else
+#define RP_LOG_WRITE(level_, format, ...)                                                                     \
+    (RP_LOG_FILTERED(level_) ? -1                                                                             \
+                             : RP_LOG_INSTANCE->write(RP_LOG_INSTANCE, (level_), RP_LOG_FILE, __LINE__, format, \
+                                                      ##__VA_ARGS__))
+#endif
+
+    // 限频写日志：本调用位置每 ms_ 毫秒最多输出一条，被抑制时参数不求值、不格式化
+    // 下一条输出前插入一行 "N messages suppressed"（需时间戳来源，没有时不限频）
+    // RP_LOG_WRITE_EVERY_MS 和 RP_LOG_WRITE_DATA 是语句（do/while），不能取返回值
+#define RP_LOG_WRITE_EVERY_MS(level_, ms_, format, ...)                                                          \
+    do                                                                                                           \
+    {                                                                                                            \
+        static RP_LogSite_t rp_log_site_;                                                                        \
+        if (!RP_LOG_FILTERED(level_) &&                                                                          \
+            RP_LOG_INSTANCE->rate_limit(RP_LOG_INSTANCE, &rp_log_site_, (ms_), (level_), RP_LOG_FILE, __LINE__)) \
+        {                                                                                                        \
+            RP_LOG_INSTANCE->write(RP_LOG_INSTANCE, (level_), RP_LOG_FILE, __LINE__, format, ##__VA_ARGS__);     \
+        }                                                                                                        \
+    } while (0)
+
+    // 写一条原始数据（kind 为 RP_LOG_DATA_HEX / RP_LOG_DATA_RAW），低于 RP_LOG_COMPILE_LEVEL 的等级编译为空
+#define RP_LOG_WRITE_DATA(level_, kind_, data_, length_)                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if ((int)(level_) <= RP_LOG_COMPILE_LEVEL && !RP_LOG_FILTERED(level_))                                         \
+        {                                                                                                              \
+            RP_LOG_INSTANCE->write_data(RP_LOG_INSTANCE, (level_), RP_LOG_FILE, __LINE__, (kind_), (data_), (length_)); \
+        }                                                                                                              \
+    } while (0)
+
+    // 十六进制 / 可打印字符输出一段数据，写入时只拷贝数据，展开在 work() 中进行
+#define RP_LOG_HEX(level_, data_, length_) RP_LOG_WRITE_DATA(level_, RP_LOG_DATA_HEX, data_, length_)
+#define RP_LOG_RAW(level_, data_, length_) RP_LOG_WRITE_DATA(level_, RP_LOG_DATA_RAW, data_, length_)
+
+    // 注册一个采样变量，变量名取自表达式，例如 RP_LOG_VAR(chassis.pid.set, RP_LOG_VAR_FLOAT)
+#define RP_LOG_VAR(var_, type_) RP_LOG_INSTANCE->add_var(RP_LOG_INSTANCE, #var_, &(var_), (type_))
+
+    // 低于 RP_LOG_COMPILE_LEVEL 的宏展开为 RP_LOG_STRIPPED()，参数不求值，字符串不进 flash
+    // 运行时仍由 config_param.output_range 和本模块的 filter[] 过滤已编译的等级
+
+    // 被编译期去掉的日志宏的值：与 write() 相同为 int，单独成句时也没有 "statement with no effect" 警告
+    static __inline int RP_Log_Stripped(void)
+    {
+        return 0;
+    }
+#define RP_LOG_STRIPPED() RP_Log_Stripped()
+
+#if RP_LOG_COMPILE_LEVEL >= RP_LOG_LVL_FATAL
+#define RP_LOG_FATAL(format, ...) RP_LOG_WRITE(RP_LOG_LEVEL_FATAL, format, ##__VA_ARGS__)
+#define RP_LOG_FATAL_EVERY_MS(ms, format, ...) RP_LOG_WRITE_EVERY_MS(RP_LOG_LEVEL_FATAL, ms, format, ##__VA_ARGS__)
+#else
+#define RP_LOG_FATAL(format, ...) RP_LOG_STRIPPED()
+#define RP_LOG_FATAL_EVERY_MS(ms, format, ...) RP_LOG_STRIPPED()
+#endif
+
+#if RP_LOG_COMPILE_LEVEL >= RP_LOG_LVL_ERROR
+#define RP_LOG_ERROR(format, ...) RP_LOG_WRITE(RP_LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#define RP_LOG_ERROR_EVERY_MS(ms, format, ...) RP_LOG_WRITE_EVERY_MS(RP_LOG_LEVEL_ERROR, ms, format, ##__VA_ARGS__)
+#else
+#define RP_LOG_ERROR(format, ...) RP_LOG_STRIPPED()
+#define RP_LOG_ERROR_EVERY_MS(ms, format, ...) RP_LOG_STRIPPED()
+#endif
+
+#if RP_LOG_COMPILE_LEVEL >= RP_LOG_LVL_WARN
+#define RP_LOG_WARN(format, ...) RP_LOG_WRITE(RP_LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#define RP_LOG_WARN_EVERY_MS(ms, format, ...) RP_LOG_WRITE_EVERY_MS(RP_LOG_LEVEL_WARN, ms, format, ##__VA_ARGS__)
+#else
+#define RP_LOG_WARN(format, ...) RP_LOG_STRIPPED()
+#define RP_LOG_WARN_EVERY_MS(ms, format, ...) RP_LOG_STRIPPED()
+#endif
+
+#if RP_LOG_COMPILE_LEVEL >= RP_LOG_LVL_INFO
+#define RP_LOG_INFO(format, ...) RP_LOG_WRITE(RP_LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define RP_LOG_INFO_EVERY_MS(ms, format, ...) RP_LOG_WRITE_EVERY_MS(RP_LOG_LEVEL_INFO, ms, format, ##__VA_ARGS__)
+#else
+#define RP_LOG_INFO(format, ...) RP_LOG_STRIPPED()
+#define RP_LOG_INFO_EVERY_MS(ms, format, ...) RP_LOG_STRIPPED()
+#endif
+
+#if RP_LOG_COMPILE_LEVEL >= RP_LOG_LVL_DEBUG
+#define RP_LOG_DEBUG(format, ...) RP_LOG_WRITE(RP_LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define RP_LOG_DEBUG_EVERY_MS(ms, format, ...) RP_LOG_WRITE_EVERY_MS(RP_LOG_LEVEL_DEBUG, ms, format, ##__VA_ARGS__)
+#else
+#define RP_LOG_DEBUG(format, ...) RP_LOG_STRIPPED()
+#define RP_LOG_DEBUG_EVERY_MS(ms, format, ...) RP_LOG_STRIPPED()
+#endif
+
+#if RP_LOG_COMPILE_LEVEL >= RP_LOG_LVL_TRACE
+#define RP_LOG_TRACE(format, ...) RP_LOG_WRITE(RP_LOG_LEVEL_TRACE, format, ##__VA_ARGS__)
+#define RP_LOG_TRACE_EVERY_MS(ms, format, ...) RP_LOG_WRITE_EVERY_MS(RP_LOG_LEVEL_TRACE, ms, format, ##__VA_ARGS__)
+#else
+#define RP_LOG_TRACE(format, ...) RP_LOG_STRIPPED()
+#define RP_LOG_TRACE_EVERY_MS(ms, format, ...) RP_LOG_STRIPPED()
+#endif
 
 #ifdef __cplusplus
 }
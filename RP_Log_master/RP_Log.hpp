@@ -0,0 +1,552 @@
+/**
+  ******************************************************************************
+  * File Name          : RP_Log.hpp
+  * Description        : Ring Buffer Log System C++17 front end
+  ******************************************************************************
+  * @attention
+  * Copyright (c) 2026 SZU RobotPilots LYQ .
+  ******************************************************************************
+  *
+  * ==============================================================================
+                       ##### How To Use #####
+  * ==============================================================================
+  *
+  * (#) C++ 文件用本头文件代替 RP_Log.h，RP_LOG_XXX 宏的用法不变（需 C++17）
+  *     #include "RP_Log.hpp"
+  *     RP_LOG_INFO("Motor %s speed:%d", name, speed);
+  *
+  * (#) 格式串在编译期解析，参数个数或类型与说明符不符时编译报错，例如：
+  *     RP_LOG_INFO("speed:%d", 1.5f);       // 浮点数传给 %d
+  *     RP_LOG_INFO("id:%s", id);            // 整数传给 %s
+  *     RP_LOG_INFO("%u %u", a);             // 参数个数不符
+  *     RP_LOG_INFO("tick:%d", (int64_t)t);  // 比 int 宽的整数，应使用 %lld
+  *     整数说明符接受不超过对应类型宽度的整数、bool 和非限定作用域枚举，%c 同 %d，* 宽度/精度同 %d
+  *     浮点说明符接受浮点数，%s 接受 char 指针、char 数组或 nullptr，%p 接受对象指针或 nullptr
+  *     不支持 %n 和未知的转换字符；格式串必须是字符串常量
+  *
+  * (#) 写入方式
+  *     RP_LOG_USE_DEFERRED 为 1 时各参数在参数区中的位置编译期确定，写入时按说明符转换后直接拷入，
+  *     不扫描格式串，再经 write_args() 写入；布局与 write() 的延迟格式化记录相同，
+  *     work() 格式化和上位机解码二进制帧时 C 与 C++ 文件写入的日志没有区别
+  *     未启用延迟格式化时参数按说明符转换为准确的类型后调用 write()（RP_LOG_USE_DEDUP 时为 write_site()）
+  *     RP_LOG_XXX 宏在 C++ 中总是表达式，返回值同 write()
+  *
+  ******************************************************************************
+  */
+
+#ifndef __RP_LOG_HPP
+#define __RP_LOG_HPP
+
+/* Includes ------------------------------------------------------------------*/
+#include "RP_Log.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus < 201703L && !(defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#error "RP_Log.hpp requires C++17"
+#endif
+
+namespace rp_log
+{
+namespace detail
+{
+
+/* Format parsing ------------------------------------------------------------*/
+
+// 参数类型，划分与 RP_Log.c 中的 RP_LogArgType_t 相同
+enum class Arg : uint8_t
+{
+    None,   // 不取参数
+    Int,    // int 及更短的整型、%c、* 宽度/精度
+    Long,   // l
+    LLong,  // ll、j
+    Size,   // z、t
+    Double, // f F e E g G a A（L 忽略）
+    Str,    // s
+    Ptr,    // p
+};
+
+// 格式串解析错误
+enum class Error : uint8_t
+{
+    None,     // 无错误
+    Unknown,  // 未知转换字符
+    Count,    // %n（不支持）
+    Trailing, // 以不完整的说明符结尾
+};
+
+// 解析结果：按取参数的顺序排列（* 宽度、* 精度各占一个 Int，位于所属参数之前）
+template <std::size_t N>
+struct Spec
+{
+    Arg args[N];
+    std::size_t count;
+    Error error;
+};
+
+// 字符串长度（编译期）
+constexpr std::size_t Length(const char *str)
+{
+    std::size_t n = 0;
+    while (str[n] != '\0')
+    {
+        n++;
+    }
+    return n;
+}
+
+// 解析格式串，规则同 RP_Log_ParseSpec()；N 不小于格式串长度加 1，参数个数不会超过 N
+template <std::size_t N>
+constexpr Spec<N> Parse(const char *p)
+{
+    Spec<N> spec{};
+
+    for (; *p != '\0'; p++)
+    {
+        if (*p != '%')
+        {
+            continue;
+        }
+        p++;
+
+        // 标志
+        while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+        {
+            p++;
+        }
+
+        // 宽度
+        if (*p == '*')
+        {
+            spec.args[spec.count++] = Arg::Int;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9')
+        {
+            p++;
+        }
+
+        // 精度
+        if (*p == '.')
+        {
+            p++;
+            if (*p == '*')
+            {
+                spec.args[spec.count++] = Arg::Int;
+                p++;
+            }
+            while (*p >= '0' && *p <= '9')
+            {
+                p++;
+            }
+        }
+
+        // 长度修饰
+        uint8_t lng = 0;
+        bool size = false;
+        while (*p == 'h' || *p == 'l' || *p == 'j' || *p == 'z' || *p == 't' || *p == 'L')
+        {
+            if (*p == 'l')
+            {
+                lng++;
+            }
+            else if (*p == 'j')
+            {
+                lng = 2;
+            }
+            else if (*p == 'z' || *p == 't')
+            {
+                size = true;
+            }
+            p++;
+        }
+
+        // 转换字符
+        switch (*p)
+        {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            spec.args[spec.count++] = size ? Arg::Size : (lng >= 2 ? Arg::LLong : (lng == 1 ? Arg::Long : Arg::Int));
+            break;
+        case 'c':
+            spec.args[spec.count++] = Arg::Int;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            spec.args[spec.count++] = Arg::Double;
+            break;
+        case 's':
+            spec.args[spec.count++] = Arg::Str;
+            break;
+        case 'p':
+            spec.args[spec.count++] = Arg::Ptr;
+            break;
+        case '%':
+            break;
+        case 'n':
+            spec.error = Error::Count;
+            return spec;
+        case '\0':
+            spec.error = Error::Trailing;
+            return spec;
+        default:
+            spec.error = Error::Unknown;
+            return spec;
+        }
+    }
+
+    return spec;
+}
+
+// 格式串（由宏中的局部类型 F::Get() 给出）及其解析结果，每个调用位置一份，只在编译期使用
+template <class F>
+struct Format
+{
+    static constexpr const char *str = F::Get();
+    static constexpr std::size_t size = Length(str) + 1;
+    static constexpr Spec<size> spec = Parse<size>(str);
+};
+
+// 第 I 个参数对应的类型，超出说明符个数时为 None
+template <class F, std::size_t I>
+constexpr Arg Kind()
+{
+    return (I < Format<F>::spec.count) ? Format<F>::spec.args[I] : Arg::None;
+}
+
+/* Type checking -------------------------------------------------------------*/
+
+// 整数的底层类型（非限定作用域枚举取其底层类型，用于判断符号）
+template <class T, bool = std::is_enum<T>::value>
+struct Integer
+{
+    using type = T;
+};
+
+template <class T>
+struct Integer<T, true>
+{
+    using type = std::underlying_type_t<T>;
+};
+
+// 可传给整数说明符的类型：整型（含 bool、char）和非限定作用域枚举
+template <class T>
+constexpr bool IsInteger = std::is_integral<T>::value || (std::is_enum<T>::value && std::is_convertible<T, int>::value);
+
+// 按 T 的符号选择 S（有符号）或 U（无符号）
+template <class T, class S, class U>
+using Signed = std::conditional_t<std::is_signed<typename Integer<T>::type>::value, S, U>;
+
+// 参数类型 T（已退化）能否传给 K 类说明符
+template <Arg K, class T>
+constexpr bool Accepts()
+{
+    if constexpr (K == Arg::Int)
+    {
+        return IsInteger<T> && sizeof(T) <= sizeof(int);
+    }
+    else if constexpr (K == Arg::Long)
+    {
+        return IsInteger<T> && sizeof(T) <= sizeof(long);
+    }
+    else if constexpr (K == Arg::LLong)
+    {
+        return IsInteger<T> && sizeof(T) <= sizeof(long long);
+    }
+    else if constexpr (K == Arg::Size)
+    {
+        return IsInteger<T> && sizeof(T) <= sizeof(std::size_t);
+    }
+    else if constexpr (K == Arg::Double)
+    {
+        return std::is_floating_point<T>::value;
+    }
+    else if constexpr (K == Arg::Str)
+    {
+        return std::is_same<T, char *>::value || std::is_same<T, const char *>::value || std::is_null_pointer<T>::value;
+    }
+    else if constexpr (K == Arg::Ptr)
+    {
+        return (std::is_pointer<T>::value && !std::is_function<std::remove_pointer_t<T>>::value) ||
+               std::is_null_pointer<T>::value;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+// 单个参数检查，编译错误信息中的 Check<说明符类型, 参数类型, 参数序号> 指出不符的参数（序号从 0 开始）
+template <Arg K, class T, std::size_t I>
+struct Check
+{
+    static_assert(Accepts<K, T>(), "RP_Log: argument type does not match format specifier");
+    static constexpr bool value = Accepts<K, T>();
+};
+
+/* Argument packing ----------------------------------------------------------*/
+
+// 按说明符转换参数，得到 C 侧 va_arg() 读取的类型（整数保留符号）
+template <Arg K, class T>
+inline auto Convert(const T &value)
+{
+    using U = std::decay_t<T>;
+
+    if constexpr (K == Arg::Int)
+    {
+        return static_cast<Signed<U, int, unsigned int>>(value);
+    }
+    else if constexpr (K == Arg::Long)
+    {
+        return static_cast<Signed<U, long, unsigned long>>(value);
+    }
+    else if constexpr (K == Arg::LLong)
+    {
+        return static_cast<Signed<U, long long, unsigned long long>>(value);
+    }
+    else if constexpr (K == Arg::Size)
+    {
+        return static_cast<std::size_t>(value);
+    }
+    else if constexpr (K == Arg::Double)
+    {
+        return static_cast<double>(value);
+    }
+    else if constexpr (K == Arg::Str)
+    {
+        if constexpr (std::is_null_pointer<U>::value)
+        {
+            return static_cast<const char *>("(null)");
+        }
+        else
+        {
+            return static_cast<const char *>(value);
+        }
+    }
+    else
+    {
+        if constexpr (std::is_null_pointer<U>::value)
+        {
+            return static_cast<const void *>(nullptr);
+        }
+        else
+        {
+            return const_cast<const void *>(static_cast<const volatile void *>(value));
+        }
+    }
+}
+
+// K 类参数在参数区中占用的字节数（%s 只计长度字节）
+template <Arg K>
+constexpr std::size_t Bytes()
+{
+    if constexpr (K == Arg::Int)
+    {
+        return sizeof(int);
+    }
+    else if constexpr (K == Arg::Long)
+    {
+        return sizeof(long);
+    }
+    else if constexpr (K == Arg::LLong)
+    {
+        return sizeof(long long);
+    }
+    else if constexpr (K == Arg::Size)
+    {
+        return sizeof(std::size_t);
+    }
+    else if constexpr (K == Arg::Double)
+    {
+        return sizeof(double);
+    }
+    else if constexpr (K == Arg::Str)
+    {
+        return 1;
+    }
+    else if constexpr (K == Arg::Ptr)
+    {
+        return sizeof(const void *);
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+// 参数区写入位置，规则同 RP_Log_PackArgs()：依次不对齐拷入，放不下时停止
+// 没有 %s 时每次写入的偏移在编译期确定，内联后只剩几次存储
+struct Packer
+{
+    uint8_t *buf;
+    uint16_t len;
+    bool full;
+
+    template <class V>
+    void Put(V value)
+    {
+        if (full || len + sizeof(V) > RP_LOG_DEFER_ARG_MAX)
+        {
+            full = true;
+            return;
+        }
+        std::memcpy(buf + len, &value, sizeof(V));
+        len += sizeof(V);
+    }
+
+    // 字符串可能位于调用者栈上，按值拷贝：长度(1) | 内容（最多 RP_LOG_DEFER_STR_MAX 字节）
+    void PutStr(const char *str)
+    {
+        uint8_t n = 0;
+        if (str == nullptr)
+        {
+            str = "(null)";
+        }
+        while (n < RP_LOG_DEFER_STR_MAX && str[n] != '\0')
+        {
+            n++;
+        }
+        if (full || len + 1 + n > RP_LOG_DEFER_ARG_MAX)
+        {
+            full = true;
+            return;
+        }
+        buf[len++] = n;
+        std::memcpy(buf + len, str, n);
+        len += n;
+    }
+};
+
+template <Arg K, class T>
+inline void Pack(Packer &packer, const T &value)
+{
+    if constexpr (K == Arg::Str)
+    {
+        packer.PutStr(Convert<K>(value));
+    }
+    else
+    {
+        packer.Put(Convert<K>(value));
+    }
+}
+
+/* Write ---------------------------------------------------------------------*/
+
+template <class F, std::size_t... I, class... A>
+inline int WriteImpl(RP_Log_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                     std::index_sequence<I...>, const A &...args)
+{
+    constexpr auto &spec = Format<F>::spec;
+    static_assert(spec.error != Error::Unknown, "RP_Log: unknown conversion in format string");
+    static_assert(spec.error != Error::Count, "RP_Log: %n is not supported");
+    static_assert(spec.error != Error::Trailing, "RP_Log: incomplete conversion at end of format string");
+    static_assert(spec.error != Error::None || spec.count == sizeof...(A),
+                  "RP_Log: number of arguments does not match format string");
+
+    constexpr bool parsed = (spec.error == Error::None && spec.count == sizeof...(A));
+    if constexpr (parsed && (Check<Kind<F, I>(), std::decay_t<A>, I>::value && ...))
+    {
+#if RP_LOG_USE_DEFERRED
+        static_assert((Bytes<Kind<F, I>()>() + ... + 0) <= RP_LOG_DEFER_ARG_MAX,
+                      "RP_Log: arguments exceed RP_LOG_DEFER_ARG_MAX");
+
+        uint8_t buf[RP_LOG_DEFER_ARG_MAX];
+        Packer packer = {buf, 0, false};
+        (Pack<Kind<F, I>()>(packer, args), ...);
+        // 没有参数时不传参数区（未写入的 buf 传给 const 指针参数会触发 -Wmaybe-uninitialized）
+        return log->write_args(log, site, level, file, line, Format<F>::str, sizeof...(A) == 0 ? nullptr : buf,
+                               packer.len);
+#else
+        if (site != nullptr)
+        {
+            return log->write_site(log, site, level, file, line, Format<F>::str, Convert<Kind<F, I>()>(args)...);
+        }
+        return log->write(log, level, file, line, Format<F>::str, Convert<Kind<F, I>()>(args)...);
+#endif
+    }
+    else
+    {
+        return -1;
+    }
+}
+
+/**
+ * @brief  检查参数并写入一条日志（由 RP_LOG_WRITE 宏调用）
+ * @param  log: 日志模块实例指针
+ * @param  site: 调用位置状态（RP_LOG_USE_DEDUP 时为宏中的静态变量，否则为 nullptr）
+ * @param  level: 日志等级
+ * @param  file: 源文件名
+ * @param  line: 行号
+ * @param  args: 参数
+ * @retval 0=成功, -1=失败
+ * @note   F::Get() 返回格式串常量，解析和类型检查都在编译期完成
+ */
+template <class F, class... A>
+inline int Write(RP_Log_t *log, RP_LogSite_t *site, RP_LogLevel_t level, const char *file, int line,
+                 const A &...args)
+{
+    return WriteImpl<F>(log, site, level, file, line, std::index_sequence_for<A...>{}, args...);
+}
+
+} // namespace detail
+} // namespace rp_log
+
+/* User macros --------------------------------------------------------------*/
+
+// 格式串放进局部类型的 constexpr 函数，作为模板参数交给编译期解析（格式串必须是字符串常量）
+#define RP_LOG_CXX_CALL(site_, level_, format, ...)                                                                  \
+    struct RpLogFormat                                                                                               \
+    {                                                                                                                \
+        static constexpr const char *Get()                                                                           \
+        {                                                                                                            \
+            return format;                                                                                           \
+        }                                                                                                            \
+    };                                                                                                               \
+    return ::rp_log::detail::Write<RpLogFormat>(RP_LOG_INSTANCE, (site_), (level_), RP_LOG_FILE, __LINE__,           \
+                                                ##__VA_ARGS__)
+
+// 替换 RP_Log.h 中的写日志宏，RP_LOG_XXX 及 RP_LOG_XXX_EVERY_MS 随之改为经过编译期检查
+#undef RP_LOG_WRITE
+#undef RP_LOG_WRITE_EVERY_MS
+
+#if RP_LOG_USE_DEDUP
+#define RP_LOG_WRITE(level_, format, ...)                                 \
+    (RP_LOG_FILTERED(level_) ? -1 : [&]() -> int {                        \
+        static RP_LogSite_t rp_log_site_;                                 \
+        RP_LOG_CXX_CALL(&rp_log_site_, level_, format, ##__VA_ARGS__);    \
+    }())
+#else
+#define RP_LOG_WRITE(level_, format, ...)                                 \
+    (RP_LOG_FILTERED(level_) ? -1 : [&]() -> int {                        \
+        RP_LOG_CXX_CALL(nullptr, level_, format, ##__VA_ARGS__);          \
+    }())
+#endif
+
+#define RP_LOG_WRITE_EVERY_MS(level_, ms_, format, ...)                                                          \
+    do                                                                                                           \
+    {                                                                                                            \
+        static RP_LogSite_t rp_log_site_;                                                                        \
+        if (!RP_LOG_FILTERED(level_) &&                                                                          \
+            RP_LOG_INSTANCE->rate_limit(RP_LOG_INSTANCE, &rp_log_site_, (ms_), (level_), RP_LOG_FILE, __LINE__)) \
+        {                                                                                                        \
+            [&]() -> int {                                                                                       \
+                RP_LOG_CXX_CALL(nullptr, level_, format, ##__VA_ARGS__);                                         \
+            }();                                                                                                 \
+        }                                                                                                        \
+    } while (0)
+
+#endif /* __RP_LOG_HPP */
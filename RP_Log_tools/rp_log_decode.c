@@ -0,0 +1,506 @@
+/**
+ ******************************************************************************
+ * File Name          : rp_log_decode.c
+ * Description        : RP_Log binary frame decoder (PC tool)
+ ******************************************************************************
+ * @attention
+ * Copyright (c) 2026 SZU RobotPilots.
+ *
+ * 将 TF 卡上的 .LOG 文件中的二进制帧（RP_LOG_USE_BINARY）还原为文本日志
+ * 格式串和文件名按地址从主控固件的 ELF 中查找
+ * 文本行（模块文件头、未开启二进制帧的日志）原样输出
+ * 压缩帧（RP_LOG_USE_COMPRESS）先整体解压，再按上面的规则处理
+ * 采样帧（RP_LOG_USE_TELEMETRY）按此前最近的变量表帧还原为 "@tel" 行，变量表帧本身不输出
+ *
+ * 编译：gcc -O2 -pthread rp_log_decode.c rp_log_host.c -o rp_log_decode
+ * 用法：rp_log_decode -e app.elf [-f dwt_hz] [-j 线程数] [-o 输出文件] xxx.LOG ...
+ *
+ ******************************************************************************
+ */
+
+#define _FILE_OFFSET_BITS 64
+#include "rp_log_host.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+/* Private define ------------------------------------------------------------*/
+
+#define DECODE_SEGMENT_SIZE (8u << 20) // 每个线程单次处理的字节数
+#define DECODE_THREAD_MAX 64           // 最大线程数
+#define DECODE_SCHEMA_LOOKBACK (256u << 10) // 分段开头向前查找变量表帧的范围（单片机端每 256 次采样重发一次）
+
+/* Private types -------------------------------------------------------------*/
+
+// 解码统计
+typedef struct
+{
+    uint64_t lines;      // 总行数
+    uint64_t frames;     // 有效帧数
+    uint64_t dropped;    // 单片机端丢弃的日志条数（DROPPED 帧累计）
+    uint64_t bad_frames; // CRC 或长度错误的帧
+    uint64_t lost;       // 按序号推算丢失的帧数
+    uint64_t unresolved; // 格式串地址在 ELF 中找不到的记录
+    RP_LogHostInflate_t inflate; // 压缩帧解压统计
+} Decode_Stats_t;
+
+// 一个分段的解码任务（各线程独立，按顺序合并输出）
+typedef struct
+{
+    const uint8_t *file_begin; // 文件（或解压后的内容）起始
+    const uint8_t *begin;    // 分段起始（行首）
+    const uint8_t *end;      // 分段结束（行首或文件末尾）
+    RP_LogHostBuf_t out;     // 输出
+    Decode_Stats_t stats;    // 统计
+    int has_seq;             // 本段是否有有效帧
+    uint16_t first_seq;      // 本段第一帧序号
+    uint16_t next_seq;       // 本段最后一帧序号 + 1
+    size_t first_frame_pos;  // 第一帧在 out 中的位置（段间序号检查在此插入提示）
+    const uint8_t *first_prefix;  // 第一帧所在行的模块前缀
+    size_t first_prefix_len; // 前缀长度
+    int error;               // 内存不足
+    RP_LogHostSchema_t schema; // 当前变量表（采样帧还原用）
+} Decode_Segment_t;
+
+// 解码参数
+typedef struct
+{
+    const RP_LogHostElf_t *elf; // 固件 ELF（可为 NULL）
+    uint32_t dwt_hz;            // DWT 计数频率
+} Decode_Config_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+static Decode_Config_t g_config;
+
+/* Private functions ---------------------------------------------------------*/
+
+// 输出一行：模块前缀 + 内容 + "\r\n"
+static void Decode_EmitLine(Decode_Segment_t *seg, const uint8_t *prefix, size_t prefix_len, const char *text,
+                            size_t text_len)
+{
+    if (RP_LogHost_BufReserve(&seg->out, prefix_len + text_len + 2) != 0)
+    {
+        seg->error = 1;
+        return;
+    }
+    memcpy(seg->out.data + seg->out.len, prefix, prefix_len);
+    seg->out.len += prefix_len;
+    memcpy(seg->out.data + seg->out.len, text, text_len);
+    seg->out.len += text_len;
+    seg->out.data[seg->out.len++] = '\r';
+    seg->out.data[seg->out.len++] = '\n';
+}
+
+// 生成序号不连续的提示内容，返回长度（0=连续）
+static int Decode_SeqGap(char *buf, size_t size, uint16_t expected, uint16_t seq, uint64_t *lost)
+{
+    uint16_t gap = (uint16_t)(seq - expected);
+    if (gap == 0)
+    {
+        return 0;
+    }
+    if (gap < 0x8000)
+    {
+        *lost += gap;
+        return snprintf(buf, size, "[RP_Log_decode] %u frames lost (seq %u..%u)", (unsigned)gap,
+                        (unsigned)expected, (unsigned)(uint16_t)(seq - 1));
+    }
+    // 序号回退：主控复位或帧乱序，无法推算丢失数量
+    return snprintf(buf, size, "[RP_Log_decode] sequence restarted (%u -> %u)", (unsigned)expected, (unsigned)seq);
+}
+
+// 解码一行中 [p, end) 范围内的一帧
+static void Decode_Frame(Decode_Segment_t *seg, const uint8_t *prefix, size_t prefix_len, const uint8_t *p,
+                         const uint8_t *end)
+{
+    uint8_t scratch[RP_LOG_HOST_FRAME_MAX];
+    char text[RP_LOG_HOST_LINE_MAX];
+    RP_LogHostFrame_t frame;
+    int n;
+
+    if (RP_LogHost_FrameDecode(p, (size_t)(end - p), scratch, &frame) != RP_LOG_HOST_FRAME_OK)
+    {
+        seg->stats.bad_frames++;
+        n = snprintf(text, sizeof(text), "[RP_Log_decode] corrupt frame (%u bytes)", (unsigned)(end - p));
+        Decode_EmitLine(seg, prefix, prefix_len, text, (size_t)n);
+        return;
+    }
+
+    seg->stats.frames++;
+    if (!seg->has_seq)
+    {
+        seg->has_seq = 1;
+        seg->first_seq = frame.seq;
+        seg->first_frame_pos = seg->out.len;
+        seg->first_prefix = prefix;
+        seg->first_prefix_len = prefix_len;
+    }
+    else if ((n = Decode_SeqGap(text, sizeof(text), seg->next_seq, frame.seq, &seg->stats.lost)) > 0)
+    {
+        Decode_EmitLine(seg, prefix, prefix_len, text, (size_t)n);
+    }
+    seg->next_seq = (uint16_t)(frame.seq + 1);
+
+    if (frame.type == RP_LOG_HOST_FRAME_SCHEMA)
+    {
+        RP_LogHost_SchemaLoad(&seg->schema, g_config.elf, &frame);
+        return;
+    }
+    if (frame.type == RP_LOG_HOST_FRAME_SAMPLE)
+    {
+        n = RP_LogHost_FormatSample(text, sizeof(text), &seg->schema, &frame, g_config.dwt_hz);
+        Decode_EmitLine(seg, prefix, prefix_len, text, (size_t)n);
+        return;
+    }
+
+    if (frame.type == RP_LOG_HOST_FRAME_DROPPED)
+    {
+        seg->stats.dropped += frame.dropped;
+    }
+    else if (frame.type == RP_LOG_HOST_FRAME_RECORD &&
+             (g_config.elf == NULL || RP_LogHost_ElfString(g_config.elf, frame.format_addr) == NULL))
+    {
+        seg->stats.unresolved++;
+    }
+
+    n = RP_LogHost_FormatFrame(text, sizeof(text), g_config.elf, &frame, g_config.dwt_hz);
+    Decode_EmitLine(seg, prefix, prefix_len, text, (size_t)n);
+}
+
+// 在分段之前的一段范围内查找最近的变量表帧，使分段开头的采样帧也能还原
+static void Decode_SchemaBefore(Decode_Segment_t *seg)
+{
+    uint8_t scratch[RP_LOG_HOST_FRAME_MAX];
+    RP_LogHostFrame_t frame;
+    const uint8_t *p = seg->file_begin;
+
+    if ((size_t)(seg->begin - seg->file_begin) > DECODE_SCHEMA_LOOKBACK)
+    {
+        p = seg->begin - DECODE_SCHEMA_LOOKBACK;
+        const uint8_t *nl = (const uint8_t *)memchr(p, '\n', (size_t)(seg->begin - p));
+        p = nl ? nl + 1 : seg->begin;
+    }
+
+    while (p < seg->begin)
+    {
+        const uint8_t *nl = (const uint8_t *)memchr(p, '\n', (size_t)(seg->begin - p));
+        const uint8_t *eol = nl ? nl : seg->begin;
+        const uint8_t *sync = (const uint8_t *)memchr(p, RP_LOG_HOST_FRAME_SYNC, (size_t)(eol - p));
+        if (eol > p && eol[-1] == '\r')
+        {
+            eol--;
+        }
+        while (sync != NULL && sync < eol)
+        {
+            const uint8_t *next = (const uint8_t *)memchr(sync + 1, RP_LOG_HOST_FRAME_SYNC, (size_t)(eol - sync - 1));
+            if (RP_LogHost_FrameDecode(sync, (size_t)((next ? next : eol) - sync), scratch, &frame) == RP_LOG_HOST_FRAME_OK &&
+                frame.type == RP_LOG_HOST_FRAME_SCHEMA)
+            {
+                RP_LogHost_SchemaLoad(&seg->schema, g_config.elf, &frame);
+            }
+            sync = next;
+        }
+        p = nl ? nl + 1 : seg->begin;
+    }
+}
+
+// 解码一个分段（线程入口）
+// 帧内不会出现 '\n' 和 SYNC，所以按行切分后每个 SYNC 都是一帧的开头，损坏的帧只影响所在的行
+static void *Decode_SegmentThread(void *arg)
+{
+    Decode_Segment_t *seg = (Decode_Segment_t *)arg;
+    const uint8_t *p = seg->begin;
+
+    Decode_SchemaBefore(seg);
+
+    while (p < seg->end && !seg->error)
+    {
+        const uint8_t *nl = (const uint8_t *)memchr(p, '\n', (size_t)(seg->end - p));
+        const uint8_t *next = nl ? nl + 1 : seg->end;
+        const uint8_t *eol = nl ? nl : seg->end;
+        if (eol > p && eol[-1] == '\r')
+        {
+            eol--;
+        }
+        seg->stats.lines++;
+
+        const uint8_t *sync = (const uint8_t *)memchr(p, RP_LOG_HOST_FRAME_SYNC, (size_t)(eol - p));
+        if (sync == NULL)
+        {
+            // 文本行原样输出
+            if (RP_LogHost_BufAppend(&seg->out, p, (size_t)(next - p)) != 0)
+            {
+                seg->error = 1;
+            }
+            p = next;
+            continue;
+        }
+
+        // SYNC 之前是 TF_Log 模块加的时间前缀，还原后的每一行都保留
+        const uint8_t *prefix = p;
+        size_t prefix_len = (size_t)(sync - p);
+
+        // 文本中恰好含有 0xA5（如 UTF-8 汉字）时不是帧，按文本输出
+        if (prefix_len > 0 && prefix[prefix_len - 1] != ']' && prefix[prefix_len - 1] != '\n')
+        {
+            if (RP_LogHost_BufAppend(&seg->out, p, (size_t)(next - p)) != 0)
+            {
+                seg->error = 1;
+            }
+            p = next;
+            continue;
+        }
+
+        while (sync != NULL)
+        {
+            const uint8_t *after = sync + 1;
+            const uint8_t *frame_end = (const uint8_t *)memchr(after, RP_LOG_HOST_FRAME_SYNC, (size_t)(eol - after));
+            Decode_Frame(seg, prefix, prefix_len, sync, frame_end ? frame_end : eol);
+            sync = frame_end;
+        }
+        p = next;
+    }
+
+    return NULL;
+}
+
+// 解码一个文件并按顺序写出
+static int Decode_File(const char *path, FILE *out, int threads, Decode_Stats_t *total)
+{
+    RP_LogHostMap_t map;
+    Decode_Segment_t seg[DECODE_THREAD_MAX];
+    pthread_t tid[DECODE_THREAD_MAX];
+    int started[DECODE_THREAD_MAX];
+    int has_seq = 0;
+    uint16_t next_seq = 0;
+
+    if (RP_LogHost_MapFile(&map, path) != 0)
+    {
+        fprintf(stderr, "rp_log_decode: cannot open %s\n", path);
+        return -1;
+    }
+
+    // 压缩的文件先解压（压缩块之间有依赖，不能按段并行），解压结果与未压缩时的文件相同
+    RP_LogHostBuf_t inflated;
+    int lz = RP_LogHost_Inflate(map.data, map.size, &inflated, &total->inflate);
+    if (lz < 0)
+    {
+        fprintf(stderr, "rp_log_decode: out of memory\n");
+        RP_LogHost_UnmapFile(&map);
+        return -1;
+    }
+
+    const uint8_t *file_begin = lz ? (const uint8_t *)inflated.data : map.data;
+    const uint8_t *file_end = file_begin + (lz ? inflated.len : map.size);
+    const uint8_t *pos = file_begin;
+    int ret = 0;
+
+    while (pos < file_end && ret == 0)
+    {
+        // 切分：每段结束在换行之后
+        int count = 0;
+        while (count < threads && pos < file_end)
+        {
+            const uint8_t *end = (size_t)(file_end - pos) > DECODE_SEGMENT_SIZE ? pos + DECODE_SEGMENT_SIZE : file_end;
+            if (end < file_end)
+            {
+                const uint8_t *nl = (const uint8_t *)memchr(end, '\n', (size_t)(file_end - end));
+                end = nl ? nl + 1 : file_end;
+            }
+            memset(&seg[count], 0, sizeof(seg[count]));
+            seg[count].file_begin = file_begin;
+            seg[count].begin = pos;
+            seg[count].end = end;
+            pos = end;
+            count++;
+        }
+
+        for (int i = 1; i < count; i++)
+        {
+            started[i] = (pthread_create(&tid[i], NULL, Decode_SegmentThread, &seg[i]) == 0);
+            if (!started[i])
+            {
+                Decode_SegmentThread(&seg[i]);
+            }
+        }
+        Decode_SegmentThread(&seg[0]);
+
+        for (int i = 0; i < count; i++)
+        {
+            Decode_Segment_t *s = &seg[i];
+            if (i > 0 && started[i])
+            {
+                pthread_join(tid[i], NULL);
+            }
+            if (s->error)
+            {
+                fprintf(stderr, "rp_log_decode: out of memory\n");
+                ret = -1;
+            }
+
+            // 段间的序号检查
+            size_t split = s->has_seq ? s->first_frame_pos : s->out.len;
+            fwrite(s->out.data, 1, split, out);
+            if (s->has_seq)
+            {
+                char text[128];
+                int n = has_seq ? Decode_SeqGap(text, sizeof(text), next_seq, s->first_seq, &s->stats.lost) : 0;
+                if (n > 0)
+                {
+                    fwrite(s->first_prefix, 1, s->first_prefix_len, out);
+                    fwrite(text, 1, (size_t)n, out);
+                    fwrite("\r\n", 1, 2, out);
+                }
+                has_seq = 1;
+                next_seq = s->next_seq;
+            }
+            fwrite(s->out.data + split, 1, s->out.len - split, out);
+
+            total->lines += s->stats.lines;
+            total->frames += s->stats.frames;
+            total->dropped += s->stats.dropped;
+            total->bad_frames += s->stats.bad_frames;
+            total->lost += s->stats.lost;
+            total->unresolved += s->stats.unresolved;
+            RP_LogHost_BufFree(&s->out);
+        }
+    }
+
+    if (lz)
+    {
+        RP_LogHost_BufFree(&inflated);
+    }
+    RP_LogHost_UnmapFile(&map);
+    return ret;
+}
+
+static void Decode_Usage(void)
+{
+    fprintf(stderr,
+            "usage: rp_log_decode -e app.elf [-f dwt_hz] [-j threads] [-o output] file.LOG ...\n"
+            "  -e  firmware ELF of the main controller (format strings and file names)\n"
+            "  -f  DWT clock in Hz when RP_LOG_TIMESTAMP_SOURCE is RP_LOG_TS_DWT\n"
+            "  -j  decode threads (default: CPU count)\n"
+            "  -o  output file (default: stdout)\n");
+}
+
+int main(int argc, char **argv)
+{
+    RP_LogHostElf_t elf;
+    const char *elf_path = NULL;
+    const char *out_path = NULL;
+    int threads = 0;
+    int first = argc;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (argv[i][0] != '-' || argv[i][1] == '\0')
+        {
+            first = i;
+            break;
+        }
+        if (i + 1 >= argc)
+        {
+            Decode_Usage();
+            return 2;
+        }
+        switch (argv[i][1])
+        {
+        case 'e':
+            elf_path = argv[++i];
+            break;
+        case 'f':
+            g_config.dwt_hz = (uint32_t)strtoul(argv[++i], NULL, 0);
+            break;
+        case 'j':
+            threads = atoi(argv[++i]);
+            break;
+        case 'o':
+            out_path = argv[++i];
+            break;
+        default:
+            Decode_Usage();
+            return 2;
+        }
+    }
+    if (first >= argc)
+    {
+        Decode_Usage();
+        return 2;
+    }
+
+    if (threads <= 0)
+    {
+#ifdef _SC_NPROCESSORS_ONLN
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        if (threads <= 0)
+        {
+            threads = 4;
+        }
+    }
+    if (threads > DECODE_THREAD_MAX)
+    {
+        threads = DECODE_THREAD_MAX;
+    }
+
+    if (elf_path != NULL)
+    {
+        if (RP_LogHost_ElfOpen(&elf, elf_path) != 0)
+        {
+            fprintf(stderr, "rp_log_decode: cannot load ELF %s\n", elf_path);
+            return 1;
+        }
+        g_config.elf = &elf;
+    }
+
+    FILE *out = stdout;
+    if (out_path != NULL && (out = fopen(out_path, "wb")) == NULL)
+    {
+        fprintf(stderr, "rp_log_decode: cannot create %s\n", out_path);
+        return 1;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+
+    Decode_Stats_t total = {0};
+    int ret = 0;
+    for (int i = first; i < argc; i++)
+    {
+        if (Decode_File(argv[i], out, threads, &total) != 0)
+        {
+            ret = 1;
+        }
+    }
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    else
+    {
+        fflush(out);
+    }
+    if (g_config.elf != NULL)
+    {
+        RP_LogHost_ElfClose(&elf);
+    }
+
+    fprintf(stderr,
+            "rp_log_decode: %llu lines, %llu frames, %llu bad frames, %llu lost frames, "
+            "%llu dropped on target, %llu unresolved\n",
+            (unsigned long long)total.lines, (unsigned long long)total.frames, (unsigned long long)total.bad_frames,
+            (unsigned long long)total.lost, (unsigned long long)total.dropped, (unsigned long long)total.unresolved);
+    if (total.inflate.blocks != 0 || total.inflate.bad_blocks != 0)
+    {
+        fprintf(stderr, "rp_log_decode: %llu compressed blocks (%llu -> %llu bytes), %llu skipped, %llu bad\n",
+                (unsigned long long)total.inflate.blocks, (unsigned long long)total.inflate.in_bytes,
+                (unsigned long long)total.inflate.out_bytes, (unsigned long long)total.inflate.skipped,
+                (unsigned long long)total.inflate.bad_blocks);
+    }
+    return ret;
+}
@@ -0,0 +1,544 @@
+/**
+ ******************************************************************************
+ * File Name          : rp_log_histogram.c
+ * Description        : RP_Log level histogram / waveform generator (PC tool)
+ ******************************************************************************
+ * @attention
+ * Copyright (c) 2026 SZU RobotPilots.
+ *
+ * 统计各等级日志数量随时间的变化，一次顺序扫描同时生成多种分辨率的分桶
+ * 每种分辨率只保留当前一个桶，内存占用与日志大小无关
+ *
+ * 时间轴：每次主控上电后的第一行按 TF_Log 模块时间对齐，之后使用主控时间戳（毫秒或微秒）
+ *         没有主控时间戳的行使用模块时间（秒）
+ * 变量采样（RP_LOG_USE_TELEMETRY）不计入等级统计，-t 时按同一时间轴导出为长表 CSV（每个变量值一行）
+ *
+ * 编译：gcc -O2 rp_log_histogram.c rp_log_host.c -o rp_log_histogram
+ * 用法：rp_log_histogram [-w 最小桶宽_us] [-k 倍数] [-n 分辨率数] [-e app.elf] [-f dwt_hz]
+ *                        [-svg 波形.svg] [-t 采样.csv] -o 输出前缀 xxx.LOG ...
+ *
+ ******************************************************************************
+ */
+
+#define _FILE_OFFSET_BITS 64
+#include "rp_log_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+
+#define HIST_LEVEL_MAX 16        // 最多分辨率数
+#define HIST_SVG_BARS 1200       // 波形图最多柱数
+#define HIST_SVG_WIDTH 1200      // 波形图宽度
+#define HIST_SVG_HEIGHT 300      // 波形图高度
+#define HIST_US_PER_DAY 86400000000LL
+
+/* Private types -------------------------------------------------------------*/
+
+// 一种分辨率的当前桶
+typedef struct
+{
+    int64_t width;      // 桶宽（微秒）
+    int64_t start;      // 当前桶起始时间
+    uint32_t counts[6]; // 当前桶各等级条数
+    uint8_t active;     // 当前桶有数据
+    uint64_t rows;      // 已输出桶数
+    FILE *fp;           // 输出文件
+    char path[512];     // 输出文件路径
+} Hist_Level_t;
+
+// 时间轴状态
+typedef struct
+{
+    int has_day0;        // 已确定第 0 天
+    int64_t day0;        // 第一行的日期（天序号），输出时间从这天零点起算
+    int has_anchor;      // 本次上电已对齐
+    int64_t anchor;      // 主控时间戳到输出时间的偏移
+    uint64_t last_tick;  // 上一行的主控时间戳（变小说明主控复位）
+    int64_t last_time;   // 上一行的输出时间
+    uint64_t segments;   // 上电次数（时间戳回退次数 + 1）
+} Hist_Clock_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+static Hist_Level_t g_levels[HIST_LEVEL_MAX];
+static int g_level_count;
+static Hist_Clock_t g_clock;
+static uint64_t g_level_total[6];
+static uint64_t g_skipped; // 没有时间的日志行
+static FILE *g_tel_fp;      // 变量采样输出（-t）
+static uint64_t g_tel_rows; // 已输出的变量值
+static uint64_t g_samples;  // 变量采样行（不计入等级统计）
+static RP_LogHostSchema_t g_schema; // 当前变量表（二进制帧）
+static RP_LogHostSample_t g_sample;
+
+// 与 RP_Log.c 中 RTT 颜色一致：FATAL 紫、ERROR 红、WARN 黄、INFO 绿、DEBUG 青、TRACE 灰
+static const char *const g_svg_colors[6] = {"#c000c0", "#e02020", "#e0b000", "#20a020", "#20b0c0", "#a0a0a0"};
+
+/* Private functions ---------------------------------------------------------*/
+
+// 公历日期转天序号（年份缺省按 2000 年）
+static int64_t Hist_DaysFromDate(uint32_t date)
+{
+    int64_t y = date / 10000, m = (date / 100) % 100, d = date % 100;
+    if (y == 0)
+    {
+        y = 2000;
+    }
+    if (m < 1 || m > 12)
+    {
+        m = 1;
+    }
+    y -= (m <= 2);
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe;
+}
+
+// 向下取整除法（时间可能为负）
+static int64_t Hist_FloorDiv(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// 桶宽转为文件名中的标签，如 1ms、10s
+static void Hist_Label(char *buf, size_t size, int64_t width)
+{
+    if (width % 1000000 == 0)
+        snprintf(buf, size, "%llds", (long long)(width / 1000000));
+    else if (width % 1000 == 0)
+        snprintf(buf, size, "%lldms", (long long)(width / 1000));
+    else
+        snprintf(buf, size, "%lldus", (long long)width);
+}
+
+// 输出一种分辨率的当前桶
+static void Hist_Flush(Hist_Level_t *lv)
+{
+    if (!lv->active)
+    {
+        return;
+    }
+    fprintf(lv->fp, "%lld,%u,%u,%u,%u,%u,%u\n", (long long)lv->start, lv->counts[0], lv->counts[1], lv->counts[2],
+            lv->counts[3], lv->counts[4], lv->counts[5]);
+    lv->rows++;
+    lv->active = 0;
+}
+
+// 计入一条日志
+static void Hist_Add(int64_t time, int level)
+{
+    for (int i = 0; i < g_level_count; i++)
+    {
+        Hist_Level_t *lv = &g_levels[i];
+        int64_t start = Hist_FloorDiv(time, lv->width) * lv->width;
+        if (lv->active && start != lv->start)
+        {
+            Hist_Flush(lv);
+        }
+        if (!lv->active)
+        {
+            lv->active = 1;
+            lv->start = start;
+            memset(lv->counts, 0, sizeof(lv->counts));
+        }
+        lv->counts[level]++;
+    }
+    g_level_total[level]++;
+}
+
+// 输出一次采样的各变量值（-t）
+static void Hist_Sample(int64_t time, const RP_LogHostSample_t *sample)
+{
+    for (uint16_t i = 0; i < sample->count; i++)
+    {
+        fprintf(g_tel_fp, "%lld,%u,%.*s,%.9g\n", (long long)time, (unsigned)sample->seq, (int)sample->name_lens[i],
+                sample->names[i], sample->values[i]);
+        g_tel_rows++;
+    }
+}
+
+// 计算一行的输出时间（微秒，从第一天零点起），没有时间时返回 -1
+static int Hist_Time(const RP_LogHostLine_t *info, int64_t *time)
+{
+    int64_t clock = 0;
+
+    if (info->has_clock)
+    {
+        int64_t day = Hist_DaysFromDate(info->date);
+        if (!g_clock.has_day0)
+        {
+            g_clock.has_day0 = 1;
+            g_clock.day0 = day;
+        }
+        clock = (day - g_clock.day0) * HIST_US_PER_DAY + (int64_t)info->sec_of_day * 1000000;
+    }
+
+    if (info->has_tick)
+    {
+        // 主控时间戳回退（复位）后重新对齐
+        if (g_clock.has_anchor && info->tick_us < g_clock.last_tick)
+        {
+            g_clock.has_anchor = 0;
+        }
+        if (!g_clock.has_anchor)
+        {
+            g_clock.has_anchor = 1;
+            g_clock.anchor = info->has_clock ? clock - (int64_t)info->tick_us
+                                             : (g_clock.segments ? g_clock.last_time - (int64_t)info->tick_us : 0);
+            g_clock.segments++;
+        }
+        g_clock.last_tick = info->tick_us;
+        *time = g_clock.anchor + (int64_t)info->tick_us;
+    }
+    else if (info->has_clock)
+    {
+        *time = clock;
+    }
+    else
+    {
+        return -1;
+    }
+    g_clock.last_time = *time;
+    return 0;
+}
+
+// 扫描一个日志文件
+static int Hist_File(const char *path, const RP_LogHostElf_t *elf, uint32_t dwt_hz)
+{
+    RP_LogHostMap_t map;
+
+    if (RP_LogHost_MapFile(&map, path) != 0)
+    {
+        fprintf(stderr, "rp_log_histogram: cannot open %s\n", path);
+        return -1;
+    }
+    g_clock.has_anchor = 0; // 每个文件对应一次模块上电，重新对齐
+
+    // 压缩的文件先解压
+    RP_LogHostBuf_t inflated;
+    RP_LogHostInflate_t inflate = {0};
+    int lz = RP_LogHost_Inflate(map.data, map.size, &inflated, &inflate);
+    if (lz < 0)
+    {
+        fprintf(stderr, "rp_log_histogram: out of memory\n");
+        RP_LogHost_UnmapFile(&map);
+        return -1;
+    }
+    const uint8_t *data = lz ? (const uint8_t *)inflated.data : map.data;
+    size_t size = lz ? inflated.len : map.size;
+
+    for (size_t pos = 0; pos < size;)
+    {
+        const uint8_t *p = data + pos;
+        const uint8_t *nl = (const uint8_t *)memchr(p, '\n', size - pos);
+        size_t n = nl ? (size_t)(nl - p) : size - pos;
+        RP_LogHostLine_t info;
+        int64_t time;
+
+        pos += n + (nl ? 1 : 0);
+        if (n > 0 && p[n - 1] == '\r')
+        {
+            n--;
+        }
+        if (RP_LogHost_ParseLine(p, n, elf, dwt_hz, &info) < 0)
+        {
+            // 变量表帧不是日志行，但要用来解析之后的采样帧
+            if (g_tel_fp != NULL && info.prefix_len < n && p[info.prefix_len] == RP_LOG_HOST_FRAME_SYNC)
+            {
+                RP_LogHost_ParseSample(p, n, &info, elf, &g_schema, &g_sample);
+            }
+            continue;
+        }
+        if (Hist_Time(&info, &time) != 0)
+        {
+            g_skipped++;
+            continue;
+        }
+        if (info.is_sample)
+        {
+            g_samples++;
+            if (g_tel_fp != NULL && RP_LogHost_ParseSample(p, n, &info, elf, &g_schema, &g_sample) == 1)
+            {
+                Hist_Sample(time, &g_sample);
+            }
+            continue;
+        }
+        Hist_Add(time, info.level);
+    }
+
+    if (lz)
+    {
+        RP_LogHost_BufFree(&inflated);
+    }
+    RP_LogHost_UnmapFile(&map);
+    return 0;
+}
+
+// 选取不超过 HIST_SVG_BARS 个桶的最细分辨率，重新读入其 CSV 画堆叠柱状图
+static int Hist_WriteSvg(const char *svg_path)
+{
+    Hist_Level_t *lv = NULL;
+    for (int i = 0; i < g_level_count; i++)
+    {
+        if (g_levels[i].rows > 0 && g_levels[i].rows <= HIST_SVG_BARS)
+        {
+            lv = &g_levels[i];
+            break;
+        }
+    }
+    if (lv == NULL)
+    {
+        fprintf(stderr, "rp_log_histogram: no resolution fits in %d bars, use a larger -n\n", HIST_SVG_BARS);
+        return -1;
+    }
+
+    FILE *in = fopen(lv->path, "r");
+    FILE *out = fopen(svg_path, "w");
+    if (in == NULL || out == NULL)
+    {
+        if (in)
+            fclose(in);
+        if (out)
+            fclose(out);
+        fprintf(stderr, "rp_log_histogram: cannot write %s\n", svg_path);
+        return -1;
+    }
+
+    long long *start = (long long *)malloc(lv->rows * sizeof(long long));
+    uint32_t(*counts)[6] = (uint32_t(*)[6])malloc(lv->rows * sizeof(*counts));
+    size_t rows = 0;
+    char line[256];
+    uint32_t peak = 1;
+
+    if (start == NULL || counts == NULL)
+    {
+        free(start);
+        free(counts);
+        fclose(in);
+        fclose(out);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), in) != NULL && rows < lv->rows)
+    {
+        uint32_t *c = counts[rows];
+        if (sscanf(line, "%lld,%u,%u,%u,%u,%u,%u", &start[rows], &c[0], &c[1], &c[2], &c[3], &c[4], &c[5]) == 7)
+        {
+            uint32_t sum = c[0] + c[1] + c[2] + c[3] + c[4] + c[5];
+            peak = sum > peak ? sum : peak;
+            rows++;
+        }
+    }
+    fclose(in);
+
+    // 横轴按时间排列（跨越的空桶留白），纵轴为桶内条数，严重的等级画在底部
+    long long t0 = rows ? start[0] : 0, t1 = rows ? start[0] : 0;
+    for (size_t r = 0; r < rows; r++)
+    {
+        t0 = start[r] < t0 ? start[r] : t0;
+        t1 = start[r] > t1 ? start[r] : t1;
+    }
+    double span = (double)(t1 - t0 + lv->width);
+    double bar = HIST_SVG_WIDTH * (double)lv->width / span;
+    char label[32];
+    Hist_Label(label, sizeof(label), lv->width);
+
+    fprintf(out, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\">\n", HIST_SVG_WIDTH,
+            HIST_SVG_HEIGHT + 20);
+    fprintf(out, "<rect width=\"100%%\" height=\"100%%\" fill=\"#ffffff\"/>\n");
+    for (size_t r = 0; r < rows; r++)
+    {
+        double x = HIST_SVG_WIDTH * (double)(start[r] - t0) / span;
+        double y = HIST_SVG_HEIGHT;
+        for (int l = 0; l < 6; l++)
+        {
+            if (counts[r][l] == 0)
+            {
+                continue;
+            }
+            double h = (double)HIST_SVG_HEIGHT * counts[r][l] / peak;
+            y -= h;
+            fprintf(out, "<rect x=\"%.2f\" y=\"%.2f\" width=\"%.2f\" height=\"%.2f\" fill=\"%s\"/>\n", x, y,
+                    bar < 1.0 ? 1.0 : bar, h, g_svg_colors[l]);
+        }
+    }
+    fprintf(out,
+            "<text x=\"4\" y=\"%d\" font-size=\"12\" font-family=\"monospace\">bucket %s, peak %u lines, "
+            "%02lld:%02lld:%02lld - %02lld:%02lld:%02lld</text>\n",
+            HIST_SVG_HEIGHT + 15, label, peak, (t0 / 3600000000LL) % 24, (t0 / 60000000LL) % 60, (t0 / 1000000LL) % 60,
+            ((t1 + lv->width) / 3600000000LL) % 24, ((t1 + lv->width) / 60000000LL) % 60,
+            ((t1 + lv->width) / 1000000LL) % 60);
+    fprintf(out, "</svg>\n");
+    fclose(out);
+    free(start);
+    free(counts);
+    return 0;
+}
+
+static void Hist_Usage(void)
+{
+    fprintf(stderr,
+            "usage: rp_log_histogram [-w base_us] [-k factor] [-n resolutions] [-e app.elf] [-f dwt_hz]\n"
+            "                        [-svg out.svg] [-t samples.csv] -o prefix file.LOG ...\n"
+            "  -w  finest bucket width in microseconds (default 1000 = 1ms)\n"
+            "  -k  width factor between resolutions (default 10)\n"
+            "  -n  number of resolutions (default: up to one day)\n"
+            "  -o  output prefix, writes prefix_<width>.csv per resolution\n"
+            "      columns: start_us,fatal,error,warn,info,debug,trace (start from 00:00 of the first day)\n"
+            "  -svg  stacked waveform at the finest resolution with at most %d buckets\n"
+            "  -t  variable samples (RP_LOG_USE_TELEMETRY), columns: time_us,seq,name,value\n"
+            "      (same time axis as the buckets; binary frames need -e for variable names)\n",
+            HIST_SVG_BARS);
+}
+
+int main(int argc, char **argv)
+{
+    RP_LogHostElf_t elf;
+    const RP_LogHostElf_t *elf_ptr = NULL;
+    const char *elf_path = NULL, *prefix = NULL, *svg_path = NULL, *tel_path = NULL;
+    int64_t base = 1000, factor = 10;
+    int count = 0;
+    uint32_t dwt_hz = 0;
+    int first = argc;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (argv[i][0] != '-')
+        {
+            first = i;
+            break;
+        }
+        if (i + 1 >= argc)
+        {
+            Hist_Usage();
+            return 2;
+        }
+        const char *opt = argv[i];
+        const char *v = argv[++i];
+        if (strcmp(opt, "-w") == 0)
+            base = strtoll(v, NULL, 0);
+        else if (strcmp(opt, "-k") == 0)
+            factor = strtoll(v, NULL, 0);
+        else if (strcmp(opt, "-n") == 0)
+            count = atoi(v);
+        else if (strcmp(opt, "-e") == 0)
+            elf_path = v;
+        else if (strcmp(opt, "-f") == 0)
+            dwt_hz = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(opt, "-o") == 0)
+            prefix = v;
+        else if (strcmp(opt, "-svg") == 0)
+            svg_path = v;
+        else if (strcmp(opt, "-t") == 0)
+            tel_path = v;
+        else
+        {
+            Hist_Usage();
+            return 2;
+        }
+    }
+    if (first >= argc || prefix == NULL || base <= 0 || factor < 2)
+    {
+        Hist_Usage();
+        return 2;
+    }
+
+    // 分辨率：base, base*k, base*k^2 ...，缺省一直到不小于一天
+    if (count <= 0)
+    {
+        for (int64_t w = base; count < HIST_LEVEL_MAX; w *= factor)
+        {
+            count++;
+            if (w >= HIST_US_PER_DAY)
+                break;
+        }
+    }
+    if (count > HIST_LEVEL_MAX)
+    {
+        count = HIST_LEVEL_MAX;
+    }
+    int64_t width = base;
+    for (int i = 0; i < count; i++, width *= factor)
+    {
+        char label[32];
+        Hist_Label(label, sizeof(label), width);
+        g_levels[i].width = width;
+        snprintf(g_levels[i].path, sizeof(g_levels[i].path), "%s_%s.csv", prefix, label);
+        g_levels[i].fp = fopen(g_levels[i].path, "w");
+        if (g_levels[i].fp == NULL)
+        {
+            fprintf(stderr, "rp_log_histogram: cannot create %s\n", g_levels[i].path);
+            return 1;
+        }
+        fprintf(g_levels[i].fp, "start_us,fatal,error,warn,info,debug,trace\n");
+        g_level_count = i + 1;
+    }
+
+    if (tel_path != NULL)
+    {
+        g_tel_fp = fopen(tel_path, "w");
+        if (g_tel_fp == NULL)
+        {
+            fprintf(stderr, "rp_log_histogram: cannot create %s\n", tel_path);
+            return 1;
+        }
+        fprintf(g_tel_fp, "time_us,seq,name,value\n");
+    }
+
+    if (elf_path != NULL)
+    {
+        if (RP_LogHost_ElfOpen(&elf, elf_path) != 0)
+        {
+            fprintf(stderr, "rp_log_histogram: cannot load ELF %s\n", elf_path);
+            return 1;
+        }
+        elf_ptr = &elf;
+    }
+
+    int ret = 0;
+    for (int i = first; i < argc; i++)
+    {
+        if (Hist_File(argv[i], elf_ptr, dwt_hz) != 0)
+        {
+            ret = 1;
+        }
+    }
+
+    for (int i = 0; i < g_level_count; i++)
+    {
+        Hist_Flush(&g_levels[i]);
+        fclose(g_levels[i].fp);
+    }
+    if (svg_path != NULL && Hist_WriteSvg(svg_path) != 0)
+    {
+        ret = 1;
+    }
+    if (g_tel_fp != NULL)
+    {
+        fclose(g_tel_fp);
+    }
+    if (elf_ptr != NULL)
+    {
+        RP_LogHost_ElfClose(&elf);
+    }
+
+    fprintf(stderr, "rp_log_histogram: FATAL %llu, ERROR %llu, WARN %llu, INFO %llu, DEBUG %llu, TRACE %llu, "
+                    "%llu without time, %llu boots, %llu sample lines\n",
+            (unsigned long long)g_level_total[0], (unsigned long long)g_level_total[1],
+            (unsigned long long)g_level_total[2], (unsigned long long)g_level_total[3],
+            (unsigned long long)g_level_total[4], (unsigned long long)g_level_total[5],
+            (unsigned long long)g_skipped, (unsigned long long)g_clock.segments, (unsigned long long)g_samples);
+    for (int i = 0; i < g_level_count; i++)
+    {
+        fprintf(stderr, "  %s: %llu buckets\n", g_levels[i].path, (unsigned long long)g_levels[i].rows);
+    }
+    if (tel_path != NULL)
+    {
+        fprintf(stderr, "  %s: %llu values\n", tel_path, (unsigned long long)g_tel_rows);
+    }
+    return ret;
+}
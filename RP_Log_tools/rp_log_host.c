@@ -0,0 +1,1560 @@
+/**
+ ******************************************************************************
+ * File Name          : rp_log_host.c
+ * Description        : RP_Log host-side helpers (PC tools)
+ ******************************************************************************
+ * @attention
+ * Copyright (c) 2026 SZU RobotPilots.
+ *
+ * 文件映射、ELF 字符串查找、二进制帧解码、打包参数格式化、压缩帧解压
+ * 参数按目标 ABI 解包：int 4 字节，long/size_t/指针与 ELF 位数相同，long long/double 8 字节，小端
+ *
+ ******************************************************************************
+ */
+
+#define _FILE_OFFSET_BITS 64
+#include "rp_log_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Private define ------------------------------------------------------------*/
+
+#define RP_LOG_HOST_SHF_ALLOC 0x2  // 段标志：运行时占用内存
+#define RP_LOG_HOST_SHT_NOBITS 8   // 段类型：无文件内容（.bss）
+
+/* Private types -------------------------------------------------------------*/
+
+// 压缩流解压状态（与单片机端 RP_LogCompress_t 对应）
+typedef struct
+{
+    uint8_t window[RP_LOG_HOST_LZ_WINDOW_MAX]; // 最近输出的数据（循环使用）
+    uint64_t pos;                              // 已输出字节数
+    uint64_t base;                             // 最近一个重置块开始时的 pos，匹配不能引用更早的数据
+    uint8_t valid;                             // 已从重置块开始同步
+    uint8_t has_seq;                           // 已收到压缩帧
+    uint16_t next_seq;                         // 下一个压缩帧的序号
+    uint8_t line_start;                        // 下一个输出字节在行首
+    uint64_t skipped;                          // 本次失步跳过的块数
+} RP_LogHost_Lz_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+const char *const g_rp_log_host_level_names[6] = {
+    "FATAL", "ERROR", "WARN ", "INFO ", "DEBUG", "TRACE"};
+
+/* Private functions ---------------------------------------------------------*/
+
+// 按小端读取 n 字节
+static uint64_t RP_LogHost_LoadLE(const uint8_t *p, uint8_t n)
+{
+    uint64_t v = 0;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        v |= (uint64_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+// 输出十进制整数（常见的无标志 %d/%u、时间戳、行号不经过 snprintf），返回长度
+static size_t RP_LogHost_PutDec(char *buf, size_t room, unsigned long long v, int neg)
+{
+    char tmp[24];
+    size_t n = 0;
+
+    do
+    {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    if (neg)
+    {
+        tmp[n++] = '-';
+    }
+    if (n >= room)
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        buf[i] = tmp[n - 1 - i];
+    }
+    return n;
+}
+
+// 解压一个压缩块（payload 含标志字节），每个新行前加上本块所在行的模块前缀
+// 返回 0 成功，-1 数据错误，-2 内存不足
+static int RP_LogHost_LzBlock(RP_LogHost_Lz_t *lz, const uint8_t *payload, size_t n, const uint8_t *prefix,
+                              size_t prefix_len, RP_LogHostBuf_t *out)
+{
+    uint8_t bits = payload[0] & 0x0F;
+    size_t i = 1;
+
+    if (bits < 8 || bits > 12)
+    {
+        return -1;
+    }
+
+    while (i < n)
+    {
+        uint8_t ctrl = payload[i++];
+        for (uint8_t b = 0; b < 8 && i < n; b++)
+        {
+            uint32_t off = 0;
+            size_t len = 1;
+
+            if (ctrl & (1U << b))
+            {
+                if (i + 2 > n)
+                {
+                    return -1;
+                }
+                uint16_t v = (uint16_t)(payload[i] | (payload[i + 1] << 8));
+                i += 2;
+                off = (uint32_t)(v & ((1U << bits) - 1)) + 1;
+                len = (size_t)(v >> bits) + 3;
+                if (off > lz->pos - lz->base)
+                {
+                    return -1;
+                }
+            }
+
+            // 最坏情况每个字节都是换行
+            if (RP_LogHost_BufReserve(out, len * (prefix_len + 1)) != 0)
+            {
+                return -2;
+            }
+            for (size_t k = 0; k < len; k++)
+            {
+                uint8_t c = off ? lz->window[(lz->pos - off) & (RP_LOG_HOST_LZ_WINDOW_MAX - 1)] : payload[i++];
+                lz->window[lz->pos & (RP_LOG_HOST_LZ_WINDOW_MAX - 1)] = c;
+                lz->pos++;
+                if (lz->line_start)
+                {
+                    memcpy(out->data + out->len, prefix, prefix_len);
+                    out->len += prefix_len;
+                    lz->line_start = 0;
+                }
+                out->data[out->len++] = (char)c;
+                lz->line_start = (c == '\n');
+            }
+        }
+    }
+    return 0;
+}
+
+// 压缩流失步：结束被截断的行，之后的块在下一个重置块之前都无法解压
+static int RP_LogHost_LzLost(RP_LogHost_Lz_t *lz, RP_LogHostBuf_t *out)
+{
+    lz->valid = 0;
+    if (!lz->line_start)
+    {
+        lz->line_start = 1;
+        return RP_LogHost_BufAppend(out, "\r\n", 2);
+    }
+    return 0;
+}
+
+// 追加字符串，返回长度（空间不足时截断）
+static size_t RP_LogHost_PutStr(char *buf, size_t room, const char *str)
+{
+    size_t n = strlen(str);
+    if (room == 0)
+    {
+        return 0;
+    }
+    if (n >= room)
+    {
+        n = room - 1;
+    }
+    memcpy(buf, str, n);
+    return n;
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief 只读映射整个文件
+ * @param map 映射结果
+ * @param path 文件路径
+ * @retval 0 成功，-1 失败
+ */
+int RP_LogHost_MapFile(RP_LogHostMap_t *map, const char *path)
+{
+    memset(map, 0, sizeof(*map));
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return -1;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return -1;
+    }
+    map->size = (size_t)size.QuadPart;
+    if (map->size > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL)
+        {
+            map->data = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        if (map->data == NULL)
+        {
+            CloseHandle(file);
+            return -1;
+        }
+    }
+    map->handle = file;
+#else
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    map->size = (size_t)st.st_size;
+    if (map->size > 0)
+    {
+        void *data = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            return -1;
+        }
+        madvise(data, map->size, MADV_SEQUENTIAL);
+        map->data = (const uint8_t *)data;
+    }
+    close(fd);
+#endif
+    return 0;
+}
+
+/**
+ * @brief 取消文件映射
+ * @param map 映射结果
+ */
+void RP_LogHost_UnmapFile(RP_LogHostMap_t *map)
+{
+#ifdef _WIN32
+    if (map->data != NULL)
+    {
+        UnmapViewOfFile(map->data);
+    }
+    if (map->handle != NULL)
+    {
+        CloseHandle((HANDLE)map->handle);
+    }
+#else
+    if (map->data != NULL)
+    {
+        munmap((void *)map->data, map->size);
+    }
+#endif
+    memset(map, 0, sizeof(*map));
+}
+
+/**
+ * @brief 加载 ELF 的可加载段，用于按地址查找格式串和文件名
+ * @param elf 加载结果
+ * @param path ELF 路径（与烧录的固件相同）
+ * @retval 0 成功，-1 失败
+ */
+int RP_LogHost_ElfOpen(RP_LogHostElf_t *elf, const char *path)
+{
+    memset(elf, 0, sizeof(*elf));
+    if (RP_LogHost_MapFile(&elf->map, path) != 0)
+    {
+        return -1;
+    }
+
+    const uint8_t *d = elf->map.data;
+    size_t size = elf->map.size;
+    if (size < 0x34 || memcmp(d, "\x7F" "ELF", 4) != 0 || d[5] != 1) // 只支持小端
+    {
+        RP_LogHost_ElfClose(elf);
+        return -1;
+    }
+
+    uint8_t is64 = (d[4] == 2);
+    if (is64 && size < 0x40)
+    {
+        RP_LogHost_ElfClose(elf);
+        return -1;
+    }
+    uint64_t shoff = is64 ? RP_LogHost_LoadLE(d + 0x28, 8) : RP_LogHost_LoadLE(d + 0x20, 4);
+    uint16_t shentsize = (uint16_t)RP_LogHost_LoadLE(d + (is64 ? 0x3A : 0x2E), 2);
+    uint16_t shnum = (uint16_t)RP_LogHost_LoadLE(d + (is64 ? 0x3C : 0x30), 2);
+    elf->ptr_size = is64 ? 8 : 4;
+
+    if (shentsize < (is64 ? 64 : 40) || shoff > size || (uint64_t)shnum * shentsize > size - shoff)
+    {
+        RP_LogHost_ElfClose(elf);
+        return -1;
+    }
+
+    elf->sections = (RP_LogHostSection_t *)calloc(shnum ? shnum : 1, sizeof(RP_LogHostSection_t));
+    if (elf->sections == NULL)
+    {
+        RP_LogHost_ElfClose(elf);
+        return -1;
+    }
+
+    for (uint16_t i = 0; i < shnum; i++)
+    {
+        const uint8_t *sh = d + shoff + (uint64_t)i * shentsize;
+        uint32_t type = (uint32_t)RP_LogHost_LoadLE(sh + 4, 4);
+        uint64_t flags = is64 ? RP_LogHost_LoadLE(sh + 8, 8) : RP_LogHost_LoadLE(sh + 8, 4);
+        uint64_t addr = is64 ? RP_LogHost_LoadLE(sh + 16, 8) : RP_LogHost_LoadLE(sh + 12, 4);
+        uint64_t offset = is64 ? RP_LogHost_LoadLE(sh + 24, 8) : RP_LogHost_LoadLE(sh + 16, 4);
+        uint64_t length = is64 ? RP_LogHost_LoadLE(sh + 32, 8) : RP_LogHost_LoadLE(sh + 20, 4);
+
+        if (!(flags & RP_LOG_HOST_SHF_ALLOC) || type == RP_LOG_HOST_SHT_NOBITS || length == 0 ||
+            offset > size || length > size - offset)
+        {
+            continue;
+        }
+        elf->sections[elf->count].addr = addr;
+        elf->sections[elf->count].size = length;
+        elf->sections[elf->count].data = d + offset;
+        elf->count++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 释放 ELF
+ * @param elf 加载结果
+ */
+void RP_LogHost_ElfClose(RP_LogHostElf_t *elf)
+{
+    free(elf->sections);
+    RP_LogHost_UnmapFile(&elf->map);
+    memset(elf, 0, sizeof(*elf));
+}
+
+/**
+ * @brief 按运行地址取常量字符串
+ * @param elf 加载结果
+ * @param addr 字符串地址（帧中的文件名/格式串地址）
+ * @retval 字符串，地址不在任何段内或段内没有 '\0' 结尾时返回 NULL
+ */
+const char *RP_LogHost_ElfString(const RP_LogHostElf_t *elf, uint32_t addr)
+{
+    for (int i = 0; i < elf->count; i++)
+    {
+        const RP_LogHostSection_t *s = &elf->sections[i];
+        if (addr >= s->addr && addr - s->addr < s->size)
+        {
+            const uint8_t *p = s->data + (addr - s->addr);
+            if (memchr(p, '\0', (size_t)(s->size - (addr - s->addr))) == NULL)
+            {
+                return NULL;
+            }
+            return (const char *)p;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief CRC16-CCITT（多项式 0x1021，初值由调用者给出，单片机端为 0xFFFF）
+ * 与单片机端结果相同，上位机用整字节查表换取速度
+ */
+uint16_t RP_LogHost_Crc16(uint16_t crc, const uint8_t *data, size_t length)
+{
+    static const uint16_t table[256] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+        0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+        0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+        0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+        0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+        0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+        0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+        0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+        0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+        0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+        0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+        0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+        0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+        0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+        0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+        0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+        0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+        0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+        0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+        0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+        0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+        0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+        0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+        0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+        0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+        0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+        0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+        0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+        0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+        0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+        0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0};
+
+    while (length--)
+    {
+        crc = (uint16_t)((crc << 8) ^ table[(uint8_t)((crc >> 8) ^ *data++)]);
+    }
+    return crc;
+}
+
+/**
+ * @brief 解码一帧
+ * @param p 指向 SYNC 字节
+ * @param n 到本帧结束的字节数（不含 "\r\n"）
+ * @param scratch 去转义缓冲区（RP_LOG_HOST_FRAME_MAX 字节，frame->args 指向其中）
+ * @param frame 解码结果
+ * @retval RP_LOG_HOST_FRAME_OK 或错误码
+ */
+int RP_LogHost_FrameDecode(const uint8_t *p, size_t n, uint8_t *scratch, RP_LogHostFrame_t *frame)
+{
+    size_t len = 0;
+
+    // 去转义
+    for (size_t i = 1; i < n; i++)
+    {
+        uint8_t b = p[i];
+        if (b == RP_LOG_HOST_FRAME_ESC)
+        {
+            if (++i >= n)
+            {
+                return RP_LOG_HOST_FRAME_BAD_LEN;
+            }
+            b = p[i] ^ RP_LOG_HOST_FRAME_ESC_XOR;
+        }
+        if (len >= RP_LOG_HOST_FRAME_MAX)
+        {
+            return RP_LOG_HOST_FRAME_BAD_LEN;
+        }
+        scratch[len++] = b;
+    }
+
+    // 类型(1) + 序号(2) + CRC(2)
+    if (len < 5)
+    {
+        return RP_LOG_HOST_FRAME_BAD_LEN;
+    }
+    if (RP_LogHost_Crc16(0xFFFF, scratch, len - 2) != (uint16_t)RP_LogHost_LoadLE(scratch + len - 2, 2))
+    {
+        return RP_LOG_HOST_FRAME_BAD_CRC;
+    }
+
+    const uint8_t *payload = scratch + 3;
+    size_t payload_len = len - 5;
+
+    memset(frame, 0, sizeof(*frame));
+    frame->type = scratch[0] & (uint8_t)~RP_LOG_HOST_FRAME_TICK64;
+    frame->tick64 = (scratch[0] & RP_LOG_HOST_FRAME_TICK64) ? 1 : 0;
+    frame->seq = (uint16_t)RP_LogHost_LoadLE(scratch + 1, 2);
+
+    switch (frame->type)
+    {
+    case RP_LOG_HOST_FRAME_RECORD:
+    {
+        uint8_t ts_len = frame->tick64 ? 8 : 4;
+        size_t fixed = 1 + 2 + ts_len + 4 + 4;
+        if (payload_len < fixed || payload[0] > 5)
+        {
+            return RP_LOG_HOST_FRAME_BAD_LEN;
+        }
+        frame->level = payload[0];
+        frame->line = (uint16_t)RP_LogHost_LoadLE(payload + 1, 2);
+        frame->timestamp = RP_LogHost_LoadLE(payload + 3, ts_len);
+        frame->file_addr = (uint32_t)RP_LogHost_LoadLE(payload + 3 + ts_len, 4);
+        frame->format_addr = (uint32_t)RP_LogHost_LoadLE(payload + 7 + ts_len, 4);
+        frame->args = payload + fixed;
+        frame->args_len = (uint16_t)(payload_len - fixed);
+        return RP_LOG_HOST_FRAME_OK;
+    }
+    case RP_LOG_HOST_FRAME_DATA:
+    {
+        // 等级(1) | 行号(2) | 时间戳(4/8) | 文件名地址(4) | 方式(1) | 偏移(2) | 数据
+        uint8_t ts_len = frame->tick64 ? 8 : 4;
+        size_t fixed = 1 + 2 + ts_len + 4 + 1 + 2;
+        if (payload_len < fixed || payload[0] > 5)
+        {
+            return RP_LOG_HOST_FRAME_BAD_LEN;
+        }
+        frame->level = payload[0];
+        frame->line = (uint16_t)RP_LogHost_LoadLE(payload + 1, 2);
+        frame->timestamp = RP_LogHost_LoadLE(payload + 3, ts_len);
+        frame->file_addr = (uint32_t)RP_LogHost_LoadLE(payload + 3 + ts_len, 4);
+        frame->data_kind = payload[7 + ts_len];
+        frame->data_offset = (uint16_t)RP_LogHost_LoadLE(payload + 8 + ts_len, 2);
+        frame->args = payload + fixed;
+        frame->args_len = (uint16_t)(payload_len - fixed);
+        return RP_LOG_HOST_FRAME_OK;
+    }
+    case RP_LOG_HOST_FRAME_SAMPLE:
+    {
+        // 等级(1) | 采样序号(2) | 时间戳(4/8) | 变量数(1) | 各变量原始值
+        uint8_t ts_len = frame->tick64 ? 8 : 4;
+        size_t fixed = 1 + 2 + ts_len + 1;
+        if (payload_len < fixed || payload[0] > 5)
+        {
+            return RP_LOG_HOST_FRAME_BAD_LEN;
+        }
+        frame->level = payload[0];
+        frame->sample_seq = (uint16_t)RP_LogHost_LoadLE(payload + 1, 2);
+        frame->timestamp = RP_LogHost_LoadLE(payload + 3, ts_len);
+        frame->var_count = payload[3 + ts_len];
+        frame->args = payload + fixed;
+        frame->args_len = (uint16_t)(payload_len - fixed);
+        return RP_LOG_HOST_FRAME_OK;
+    }
+    case RP_LOG_HOST_FRAME_SCHEMA:
+        // 变量数(1) | 各变量 类型(1) + 变量名地址(4)
+        if (payload_len < 1 || payload_len != 1 + (size_t)payload[0] * 5)
+        {
+            return RP_LOG_HOST_FRAME_BAD_LEN;
+        }
+        frame->var_count = payload[0];
+        frame->args = payload + 1;
+        frame->args_len = (uint16_t)(payload_len - 1);
+        return RP_LOG_HOST_FRAME_OK;
+    case RP_LOG_HOST_FRAME_LZ:
+        if (payload_len < 1)
+        {
+            return RP_LOG_HOST_FRAME_BAD_LEN;
+        }
+        frame->args = payload; // 标志(1) | LZ 数据
+        frame->args_len = (uint16_t)payload_len;
+        return RP_LOG_HOST_FRAME_OK;
+    case RP_LOG_HOST_FRAME_DROPPED:
+        if (payload_len != 4)
+        {
+            return RP_LOG_HOST_FRAME_BAD_LEN;
+        }
+        frame->level = 2; // WARN，与单片机端的文本提示行相同
+        frame->dropped = (uint32_t)RP_LogHost_LoadLE(payload, 4);
+        return RP_LOG_HOST_FRAME_OK;
+    default:
+        return RP_LOG_HOST_FRAME_BAD_TYPE;
+    }
+}
+
+/**
+ * @brief 按打包参数格式化（规则与 RP_Log_FormatArgs 相同，参数不足时停止输出）
+ * @param buf 输出缓冲区
+ * @param size 缓冲区大小（含 '\0'）
+ * @param format 格式串
+ * @param args 打包参数
+ * @param args_len 打包参数长度
+ * @param ptr_size 目标 long、size_t、指针长度
+ * @retval 写入长度
+ */
+int RP_LogHost_FormatArgs(char *buf, size_t size, const char *format, const uint8_t *args,
+                          uint16_t args_len, uint8_t ptr_size)
+{
+    size_t len = 0;
+    size_t pos = 0;
+    const char *p = format;
+
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    while (*p != '\0' && len < size - 1)
+    {
+        if (*p != '%')
+        {
+            buf[len++] = *p++;
+            continue;
+        }
+
+        // 解析说明符：标志、宽度、精度、长度修饰、转换字符
+        char flags[8];
+        int nflags = 0;
+        int width = -1, prec = -1;
+        int width_star = 0, prec_star = 0;
+        int lng = 0, half = 0, zsize = 0;
+
+        p++;
+        while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+        {
+            if (nflags < (int)sizeof(flags) - 1)
+                flags[nflags++] = *p;
+            p++;
+        }
+        flags[nflags] = '\0';
+        if (*p == '*')
+        {
+            width_star = 1;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9')
+        {
+            width = (width < 0 ? 0 : width) * 10 + (*p++ - '0');
+            if (width > 1000)
+                width = 1000;
+        }
+        if (*p == '.')
+        {
+            p++;
+            prec = 0;
+            if (*p == '*')
+            {
+                prec_star = 1;
+                p++;
+            }
+            while (*p >= '0' && *p <= '9')
+            {
+                prec = prec * 10 + (*p++ - '0');
+                if (prec > 1000)
+                    prec = 1000;
+            }
+        }
+        while (*p == 'h' || *p == 'l' || *p == 'j' || *p == 'z' || *p == 't' || *p == 'L')
+        {
+            if (*p == 'l')
+                lng++;
+            else if (*p == 'h')
+                half++;
+            else if (*p == 'j')
+                lng = 2;
+            else if (*p == 'z' || *p == 't')
+                zsize = 1;
+            p++;
+        }
+        char conv = *p;
+        if (conv == '\0')
+        {
+            break;
+        }
+        p++;
+
+        if (conv == '%')
+        {
+            buf[len++] = '%';
+            continue;
+        }
+        if (strchr("diuxXocfFeEgGaAspn", conv) == NULL)
+        {
+            continue; // 未知转换，单片机端同样不输出
+        }
+
+        // '*' 宽度和精度，按 int 打包
+        if (width_star)
+        {
+            if (pos + 4 > args_len)
+                break;
+            int32_t w = (int32_t)RP_LogHost_LoadLE(args + pos, 4);
+            pos += 4;
+            if (w < 0 && nflags < (int)sizeof(flags) - 1)
+            {
+                flags[nflags++] = '-';
+                flags[nflags] = '\0';
+                w = -w;
+            }
+            width = (w > 1000) ? 1000 : w;
+        }
+        if (prec_star)
+        {
+            if (pos + 4 > args_len)
+                break;
+            int32_t pr = (int32_t)RP_LogHost_LoadLE(args + pos, 4);
+            pos += 4;
+            prec = (pr < 0) ? -1 : (pr > 1000 ? 1000 : pr);
+        }
+
+        char *out = buf + len;
+        size_t room = size - len;
+        char fmt[48];
+        int n = 0;
+
+        // 参数区中的字符串不以 '\0' 结尾，用精度限制读取长度
+        uint8_t str_len = 0;
+        if (conv == 's')
+        {
+            if (pos + 1 > args_len)
+                break;
+            str_len = args[pos++];
+            if (pos + str_len > args_len)
+                break;
+            if (prec < 0 || prec > str_len)
+                prec = str_len;
+        }
+
+        // 重建说明符，整数统一按 long long 输出
+        int f = snprintf(fmt, sizeof(fmt), "%%%s", flags);
+        if (width >= 0)
+            f += snprintf(fmt + f, sizeof(fmt) - f, "%d", width);
+        if (prec >= 0)
+            f += snprintf(fmt + f, sizeof(fmt) - f, ".%d", prec);
+
+        if (strchr("diuxXoc", conv) != NULL)
+        {
+            uint8_t arg_size = (conv == 'c') ? 4 : (zsize ? ptr_size : (lng >= 2 ? 8 : (lng == 1 ? ptr_size : 4)));
+            if (pos + arg_size > args_len)
+                break;
+            uint64_t raw = RP_LogHost_LoadLE(args + pos, arg_size);
+            pos += arg_size;
+
+            if (conv == 'c')
+            {
+                snprintf(fmt + f, sizeof(fmt) - f, "c");
+                n = snprintf(out, room, fmt, (int)(uint8_t)raw);
+            }
+            else
+            {
+                long long v;
+                uint8_t is_signed = (conv == 'd' || conv == 'i');
+                if (half >= 2)
+                    v = is_signed ? (long long)(int8_t)raw : (long long)(uint8_t)raw;
+                else if (half == 1)
+                    v = is_signed ? (long long)(int16_t)raw : (long long)(uint16_t)raw;
+                else if (arg_size == 4)
+                    v = is_signed ? (long long)(int32_t)raw : (long long)(uint32_t)raw;
+                else
+                    v = (long long)raw;
+                if (nflags == 0 && width < 0 && prec < 0 && (conv == 'd' || conv == 'i' || conv == 'u'))
+                {
+                    n = (int)RP_LogHost_PutDec(out, room, (v < 0 && conv != 'u') ? 0ULL - (unsigned long long)v : (unsigned long long)v,
+                                               v < 0 && conv != 'u');
+                }
+                else
+                {
+                    snprintf(fmt + f, sizeof(fmt) - f, "ll%c", conv);
+                    n = snprintf(out, room, fmt, v);
+                }
+            }
+        }
+        else if (strchr("fFeEgGaA", conv) != NULL)
+        {
+            double v;
+            uint64_t raw;
+            if (pos + 8 > args_len)
+                break;
+            raw = RP_LogHost_LoadLE(args + pos, 8);
+            memcpy(&v, &raw, sizeof(v));
+            pos += 8;
+            snprintf(fmt + f, sizeof(fmt) - f, "%c", conv);
+            n = snprintf(out, room, fmt, v);
+        }
+        else if (conv == 's')
+        {
+            snprintf(fmt + f, sizeof(fmt) - f, "s");
+            n = snprintf(out, room, fmt, (const char *)(args + pos));
+            pos += str_len;
+        }
+        else // 'p'、'n'
+        {
+            if (pos + ptr_size > args_len)
+                break;
+            uint64_t v = RP_LogHost_LoadLE(args + pos, ptr_size);
+            pos += ptr_size;
+            if (conv == 'p')
+            {
+                n = snprintf(out, room, "0x%llx", (unsigned long long)v);
+            }
+        }
+
+        if (n > 0)
+        {
+            len += ((size_t)n < room) ? (size_t)n : room - 1;
+        }
+    }
+
+    buf[len] = '\0';
+    return (int)len;
+}
+
+/**
+ * @brief 格式化时间戳，与单片机端输出相同
+ * @param dwt_hz DWT 计数频率（为 0 时输出原始周期数，格式为 "[N cyc] "）
+ * @retval 写入长度
+ */
+int RP_LogHost_FormatTimestamp(char *buf, size_t size, const RP_LogHostFrame_t *frame, uint32_t dwt_hz)
+{
+    int n;
+    if (!frame->tick64)
+    {
+        if (size < 16)
+        {
+            return 0;
+        }
+        n = 0;
+        buf[n++] = '[';
+        n += (int)RP_LogHost_PutDec(buf + n, size - n, frame->timestamp, 0);
+        buf[n++] = ']';
+        buf[n++] = ' ';
+        buf[n] = '\0';
+    }
+    else if (dwt_hz == 0)
+    {
+        n = snprintf(buf, size, "[%llu cyc] ", (unsigned long long)frame->timestamp);
+    }
+    else
+    {
+        unsigned long long sec = frame->timestamp / dwt_hz;
+        unsigned long long us = (frame->timestamp % dwt_hz) * 1000000ULL / dwt_hz;
+        n = snprintf(buf, size, "[%llu.%06llu] ", sec, us);
+    }
+    return (n < 0) ? 0 : ((size_t)n < size ? n : (int)size - 1);
+}
+
+/**
+ * @brief 将一帧还原为与文本模式相同的日志行（不含换行）
+ * @param elf 固件 ELF（为 NULL 或找不到字符串时输出地址）
+ * @retval 写入长度
+ */
+int RP_LogHost_FormatFrame(char *buf, size_t size, const RP_LogHostElf_t *elf,
+                           const RP_LogHostFrame_t *frame, uint32_t dwt_hz)
+{
+    int len = 0;
+    int n;
+
+    if (frame->type == RP_LOG_HOST_FRAME_DROPPED)
+    {
+        n = snprintf(buf, size, "[%s][RP_Log:0]: %lu messages dropped", g_rp_log_host_level_names[2],
+                     (unsigned long)frame->dropped);
+        return (n < 0) ? 0 : ((size_t)n < size ? n : (int)size - 1);
+    }
+    if (frame->type == RP_LOG_HOST_FRAME_SCHEMA)
+    {
+        n = snprintf(buf, size, "[RP_Log:0]: @schema %u vars", (unsigned)frame->var_count);
+        return (n < 0) ? 0 : ((size_t)n < size ? n : (int)size - 1);
+    }
+    if (frame->type == RP_LOG_HOST_FRAME_SAMPLE)
+    {
+        return RP_LogHost_FormatSample(buf, size, NULL, frame, dwt_hz); // 没有变量表时只输出序号和长度
+    }
+
+    len += RP_LogHost_FormatTimestamp(buf, size, frame, dwt_hz);
+
+    const char *file = elf ? RP_LogHost_ElfString(elf, frame->file_addr) : NULL;
+    const char *format = elf ? RP_LogHost_ElfString(elf, frame->format_addr) : NULL;
+    char file_hex[16];
+    if (file == NULL)
+    {
+        snprintf(file_hex, sizeof(file_hex), "0x%08lx", (unsigned long)frame->file_addr);
+        file = file_hex;
+    }
+
+    // "[等级][文件:行号]: "
+    len += (int)RP_LogHost_PutStr(buf + len, size - len, "[");
+    len += (int)RP_LogHost_PutStr(buf + len, size - len, g_rp_log_host_level_names[frame->level]);
+    len += (int)RP_LogHost_PutStr(buf + len, size - len, "][");
+    len += (int)RP_LogHost_PutStr(buf + len, size - len, file);
+    len += (int)RP_LogHost_PutStr(buf + len, size - len, ":");
+    len += (int)RP_LogHost_PutDec(buf + len, size - len, frame->line, 0);
+    len += (int)RP_LogHost_PutStr(buf + len, size - len, "]: ");
+    buf[len] = '\0';
+
+    if (frame->type == RP_LOG_HOST_FRAME_DATA)
+    {
+        // 与单片机文本输出相同：分段时 "偏移: "，十六进制以空格分隔，可打印字符原样、其他为 '.'，截断时末尾 " ..."
+        static const char hex[] = "0123456789ABCDEF";
+        uint8_t raw = (frame->data_kind & RP_LOG_HOST_DATA_RAW) != 0;
+        if (frame->data_kind & RP_LOG_HOST_DATA_SPLIT)
+        {
+            n = snprintf(buf + len, size - len, "%04X: ", (unsigned)frame->data_offset);
+            if (n > 0)
+            {
+                len += ((size_t)n < size - len) ? n : (int)(size - len) - 1;
+            }
+        }
+        for (uint16_t i = 0; i < frame->args_len && (size_t)len + 4 < size; i++)
+        {
+            uint8_t b = frame->args[i];
+            if (raw)
+            {
+                buf[len++] = (b >= 0x20 && b < 0x7F) ? (char)b : '.';
+                continue;
+            }
+            if (i != 0)
+            {
+                buf[len++] = ' ';
+            }
+            buf[len++] = hex[b >> 4];
+            buf[len++] = hex[b & 0x0F];
+        }
+        buf[len] = '\0';
+        if (frame->data_kind & RP_LOG_HOST_DATA_CUT)
+        {
+            len += (int)RP_LogHost_PutStr(buf + len, size - len, " ...");
+        }
+        return len;
+    }
+
+    if (format != NULL)
+    {
+        len += RP_LogHost_FormatArgs(buf + len, size - len, format, frame->args, frame->args_len,
+                                     elf->ptr_size);
+    }
+    else
+    {
+        n = snprintf(buf + len, size - len, "<format 0x%08lx, %u bytes of args>",
+                     (unsigned long)frame->format_addr, (unsigned)frame->args_len);
+        if (n > 0)
+        {
+            len += ((size_t)n < size - len) ? n : (int)(size - len) - 1;
+        }
+    }
+    return len;
+}
+
+// 变量类型的字节数（RP_LogVarType_t），未知类型为 0
+static uint8_t RP_LogHost_VarSize(uint8_t type)
+{
+    static const uint8_t sizes[7] = {1, 1, 2, 2, 4, 4, 4};
+    return (type < 7) ? sizes[type] : 0;
+}
+
+// 读取一个变量的原始值（小端）
+static double RP_LogHost_VarValue(uint8_t type, const uint8_t *p)
+{
+    uint32_t raw = (uint32_t)RP_LogHost_LoadLE(p, RP_LogHost_VarSize(type));
+    float f;
+
+    switch (type)
+    {
+    case 1:
+        return (double)(int8_t)raw;
+    case 3:
+        return (double)(int16_t)raw;
+    case 5:
+        return (double)(int32_t)raw;
+    case 6:
+        memcpy(&f, &raw, sizeof(f));
+        return (double)f;
+    default:
+        return (double)raw;
+    }
+}
+
+// 采样帧与变量表是否一致（变量只追加注册，采样的变量数不超过变量表）
+static int RP_LogHost_SampleMatch(const RP_LogHostSchema_t *schema, const RP_LogHostFrame_t *frame)
+{
+    size_t total = 0;
+
+    if (schema == NULL || frame->var_count > schema->count)
+    {
+        return 0;
+    }
+    for (uint16_t i = 0; i < frame->var_count; i++)
+    {
+        total += RP_LogHost_VarSize(schema->types[i]);
+    }
+    return total == frame->args_len;
+}
+
+/**
+ * @brief 从变量表帧更新变量表
+ * @param elf 固件 ELF（为 NULL 或找不到变量名时用地址代替）
+ */
+void RP_LogHost_SchemaLoad(RP_LogHostSchema_t *schema, const RP_LogHostElf_t *elf, const RP_LogHostFrame_t *frame)
+{
+    schema->count = frame->var_count;
+    for (uint16_t i = 0; i < frame->var_count; i++)
+    {
+        const uint8_t *entry = frame->args + i * 5;
+        uint32_t addr = (uint32_t)RP_LogHost_LoadLE(entry + 1, 4);
+        const char *name = elf ? RP_LogHost_ElfString(elf, addr) : NULL;
+
+        schema->types[i] = entry[0];
+        if (name == NULL)
+        {
+            snprintf(schema->unnamed[i], sizeof(schema->unnamed[i]), "0x%08lx", (unsigned long)addr);
+            name = schema->unnamed[i];
+        }
+        schema->names[i] = name;
+    }
+}
+
+/**
+ * @brief 将采样帧还原为与文本模式相同的行（不含换行）："[时间戳] [等级][RP_Log:0]: @tel 序号 变量=值 ..."
+ * @param schema 变量表（为 NULL 或与本帧不一致时只输出变量数和长度）
+ * @retval 写入长度
+ * @note 整数按十进制输出，float 保留 3 位小数，与单片机端相同；来源与单片机端相同为 RP_Log:0
+ */
+int RP_LogHost_FormatSample(char *buf, size_t size, const RP_LogHostSchema_t *schema,
+                            const RP_LogHostFrame_t *frame, uint32_t dwt_hz)
+{
+    int len = RP_LogHost_FormatTimestamp(buf, size, frame, dwt_hz);
+    int n;
+
+    n = snprintf(buf + len, size - len, "[%s][RP_Log:0]: @tel %u", g_rp_log_host_level_names[frame->level],
+                 (unsigned)frame->sample_seq);
+    if (n > 0)
+    {
+        len += ((size_t)n < size - len) ? n : (int)(size - len) - 1;
+    }
+
+    if (!RP_LogHost_SampleMatch(schema, frame))
+    {
+        n = snprintf(buf + len, size - len, " <%u vars, %u bytes, no schema>", (unsigned)frame->var_count,
+                     (unsigned)frame->args_len);
+        if (n > 0)
+        {
+            len += ((size_t)n < size - len) ? n : (int)(size - len) - 1;
+        }
+        return len;
+    }
+
+    const uint8_t *p = frame->args;
+    for (uint16_t i = 0; i < frame->var_count; i++)
+    {
+        uint8_t type = schema->types[i];
+        double v = RP_LogHost_VarValue(type, p);
+        p += RP_LogHost_VarSize(type);
+
+        if (type == 6)
+            n = snprintf(buf + len, size - len, " %s=%.3f", schema->names[i], v);
+        else
+            n = snprintf(buf + len, size - len, " %s=%.0f", schema->names[i], v);
+        if (n > 0)
+        {
+            len += ((size_t)n < size - len) ? n : (int)(size - len) - 1;
+        }
+    }
+    return len;
+}
+
+/**
+ * @brief 解析一行中的变量采样（采样帧或文本 "@tel" 行）
+ * @param p 行首
+ * @param n 行长度（不含换行）
+ * @param info RP_LogHost_ParseLine() 对本行的解析结果
+ * @param elf 固件 ELF（用于变量表帧中的变量名，可为 NULL）
+ * @param schema 变量表（收到变量表帧时更新，解析采样帧时使用）
+ * @param sample 解析结果，变量名指向本行或 schema
+ * @retval 1=采样，2=变量表帧，0=其他（含没有变量表的采样帧）
+ */
+int RP_LogHost_ParseSample(const uint8_t *p, size_t n, const RP_LogHostLine_t *info, const RP_LogHostElf_t *elf,
+                           RP_LogHostSchema_t *schema, RP_LogHostSample_t *sample)
+{
+    size_t i = info->prefix_len;
+
+    sample->count = 0;
+    if (i < n && p[i] == RP_LOG_HOST_FRAME_SYNC)
+    {
+        uint8_t scratch[RP_LOG_HOST_FRAME_MAX];
+        RP_LogHostFrame_t frame;
+        const uint8_t *end = (const uint8_t *)memchr(p + i + 1, RP_LOG_HOST_FRAME_SYNC, n - i - 1);
+
+        if (RP_LogHost_FrameDecode(p + i, (size_t)((end ? end : p + n) - (p + i)), scratch, &frame) !=
+            RP_LOG_HOST_FRAME_OK)
+        {
+            return 0;
+        }
+        if (frame.type == RP_LOG_HOST_FRAME_SCHEMA)
+        {
+            RP_LogHost_SchemaLoad(schema, elf, &frame);
+            return 2;
+        }
+        if (frame.type != RP_LOG_HOST_FRAME_SAMPLE || !RP_LogHost_SampleMatch(schema, &frame))
+        {
+            return 0;
+        }
+
+        const uint8_t *v = frame.args;
+        sample->seq = frame.sample_seq;
+        sample->count = frame.var_count;
+        for (uint16_t k = 0; k < frame.var_count; k++)
+        {
+            sample->names[k] = schema->names[k];
+            sample->name_lens[k] = (uint16_t)strlen(schema->names[k]);
+            sample->values[k] = RP_LogHost_VarValue(schema->types[k], v);
+            v += RP_LogHost_VarSize(schema->types[k]);
+        }
+        return 1;
+    }
+
+    // 文本行："]: @tel 序号 变量=值 ..."
+    if (!info->is_sample)
+    {
+        return 0;
+    }
+    const uint8_t *tag = NULL;
+    for (; i + 8 <= n; i++)
+    {
+        if (memcmp(p + i, "]: @tel ", 8) == 0)
+        {
+            tag = p + i + 8;
+            break;
+        }
+    }
+    if (tag == NULL)
+    {
+        return 0;
+    }
+
+    const char *q = (const char *)tag;
+    const char *end = (const char *)p + n;
+    char num[64];
+    sample->seq = 0;
+    while (q < end && *q >= '0' && *q <= '9')
+    {
+        sample->seq = (uint16_t)(sample->seq * 10 + (*q++ - '0'));
+    }
+    while (q < end && sample->count < RP_LOG_HOST_VAR_MAX)
+    {
+        while (q < end && *q == ' ')
+        {
+            q++;
+        }
+        const char *name = q;
+        const char *eq = NULL;
+        while (q < end && *q != ' ')
+        {
+            if (*q == '=')
+            {
+                eq = q; // 变量名中可能有 '='（如数组下标表达式），取最后一个
+            }
+            q++;
+        }
+        if (eq == NULL || eq == name || q - eq - 1 <= 0 || (size_t)(q - eq - 1) >= sizeof(num))
+        {
+            continue;
+        }
+        memcpy(num, eq + 1, (size_t)(q - eq - 1));
+        num[q - eq - 1] = '\0';
+        char *stop;
+        double v = strtod(num, &stop);
+        if (stop == num)
+        {
+            continue;
+        }
+        sample->names[sample->count] = name;
+        sample->name_lens[sample->count] = (uint16_t)(eq - name);
+        sample->values[sample->count] = v;
+        sample->count++;
+    }
+    return 1;
+}
+
+/**
+ * @brief 解压文件中的压缩帧（RP_LOG_USE_COMPRESS），还原为未压缩时的 .LOG 内容
+ * @param p 文件内容
+ * @param n 文件长度
+ * @param out 解压结果（返回 1 时有效，由调用者释放）
+ * @param stats 统计（累加）
+ * @retval 1 已解压，0 文件中没有压缩帧，-1 内存不足
+ * @note 解压出的每一行加上该行开始所在块的 TF_Log 模块前缀，其余文本行原样保留
+ *       丢帧或 CRC 错误后跳过各块直到下一个重置块，并插入一行 "[RP_Log_inflate] ..." 提示
+ */
+int RP_LogHost_Inflate(const uint8_t *p, size_t n, RP_LogHostBuf_t *out, RP_LogHostInflate_t *stats)
+{
+    const uint8_t *end = p + n;
+    const uint8_t *s = p;
+
+    // 类型字节不会被转义，压缩帧总以 SYNC, 0x03 开头
+    for (;;)
+    {
+        s = (const uint8_t *)memchr(s, RP_LOG_HOST_FRAME_SYNC, (size_t)(end - s));
+        if (s == NULL)
+        {
+            return 0;
+        }
+        if (s + 1 < end && s[1] == RP_LOG_HOST_FRAME_LZ)
+        {
+            break;
+        }
+        s++;
+    }
+
+    RP_LogHost_Lz_t *lz = (RP_LogHost_Lz_t *)calloc(1, sizeof(RP_LogHost_Lz_t));
+    uint8_t *scratch = (uint8_t *)malloc(RP_LOG_HOST_FRAME_MAX);
+    int ret = 1;
+    memset(out, 0, sizeof(*out));
+    if (lz == NULL || scratch == NULL)
+    {
+        ret = -1;
+    }
+    else
+    {
+        lz->line_start = 1;
+    }
+
+    while (p < end && ret > 0)
+    {
+        const uint8_t *nl = (const uint8_t *)memchr(p, '\n', (size_t)(end - p));
+        const uint8_t *next = nl ? nl + 1 : end;
+        const uint8_t *eol = nl ? nl : end;
+        if (eol > p && eol[-1] == '\r')
+        {
+            eol--;
+        }
+
+        // 与 rp_log_decode 相同：SYNC 之前只能是 TF_Log 模块前缀
+        const uint8_t *sync = (const uint8_t *)memchr(p, RP_LOG_HOST_FRAME_SYNC, (size_t)(eol - p));
+        size_t prefix_len = sync ? (size_t)(sync - p) : 0;
+        if (sync == NULL || sync + 1 >= eol || sync[1] != RP_LOG_HOST_FRAME_LZ ||
+            (prefix_len > 0 && p[prefix_len - 1] != ']'))
+        {
+            // 其他行（模块文件头、未压缩的日志）原样输出
+            if ((!lz->line_start && RP_LogHost_BufAppend(out, "\r\n", 2) != 0) ||
+                RP_LogHost_BufAppend(out, p, (size_t)(next - p)) != 0)
+            {
+                ret = -1;
+            }
+            lz->line_start = 1;
+            p = next;
+            continue;
+        }
+
+        while (sync != NULL && ret > 0)
+        {
+            const uint8_t *after = sync + 1;
+            const uint8_t *frame_end = (const uint8_t *)memchr(after, RP_LOG_HOST_FRAME_SYNC, (size_t)(eol - after));
+            RP_LogHostFrame_t frame;
+            int rc = RP_LogHost_FrameDecode(sync, (size_t)((frame_end ? frame_end : eol) - sync), scratch, &frame);
+
+            stats->in_bytes += (size_t)((frame_end ? frame_end : next) - sync);
+            sync = frame_end;
+            if (rc != RP_LOG_HOST_FRAME_OK || frame.type != RP_LOG_HOST_FRAME_LZ)
+            {
+                stats->bad_blocks++;
+                lz->skipped++;
+                ret = (RP_LogHost_LzLost(lz, out) != 0) ? -1 : ret;
+                continue;
+            }
+
+            if (lz->has_seq && frame.seq != lz->next_seq && lz->valid)
+            {
+                ret = (RP_LogHost_LzLost(lz, out) != 0) ? -1 : ret;
+            }
+            lz->has_seq = 1;
+            lz->next_seq = (uint16_t)(frame.seq + 1);
+
+            if (frame.args[0] & RP_LOG_HOST_LZ_RESET)
+            {
+                if (lz->skipped != 0)
+                {
+                    char text[96];
+                    int len = snprintf(text, sizeof(text), "[RP_Log_inflate] %llu compressed blocks skipped\r\n",
+                                       (unsigned long long)lz->skipped);
+                    if (RP_LogHost_BufAppend(out, p, prefix_len) != 0 ||
+                        RP_LogHost_BufAppend(out, text, (size_t)len) != 0)
+                    {
+                        ret = -1;
+                    }
+                    lz->skipped = 0;
+                }
+                lz->valid = 1;
+                lz->base = lz->pos;
+            }
+            if (!lz->valid)
+            {
+                stats->skipped++;
+                lz->skipped++;
+                continue;
+            }
+
+            rc = RP_LogHost_LzBlock(lz, frame.args, frame.args_len, p, prefix_len, out);
+            if (rc == -2)
+            {
+                ret = -1;
+            }
+            else if (rc != 0)
+            {
+                stats->bad_blocks++;
+                lz->skipped++;
+                ret = (RP_LogHost_LzLost(lz, out) != 0) ? -1 : ret;
+            }
+            else
+            {
+                stats->blocks++;
+            }
+        }
+        p = next;
+    }
+
+    free(scratch);
+    free(lz);
+    if (ret < 0)
+    {
+        RP_LogHost_BufFree(out);
+        return ret;
+    }
+    stats->out_bytes += out->len;
+    return ret;
+}
+
+/**
+ * @brief 解析一行日志：TF_Log 模块时间前缀、主控时间戳、等级、文件名和行号
+ * @param p 行首
+ * @param n 行长度（不含换行）
+ * @param elf 固件 ELF（用于二进制帧的文件名，可为 NULL）
+ * @param dwt_hz DWT 计数频率（二进制帧的 64 位时间戳换算为微秒，为 0 时不换算）
+ * @param info 解析结果
+ * @retval 日志等级，不是 RP_Log 日志行时返回 -1
+ * @note 模块前缀为若干个只含数字和 "/_:- " 的方括号，如 "[12/28][00:00:03]"、"[2026_01_23 15:30:45]"
+ */
+int RP_LogHost_ParseLine(const uint8_t *p, size_t n, const RP_LogHostElf_t *elf, uint32_t dwt_hz,
+                         RP_LogHostLine_t *info)
+{
+    size_t i = 0;
+
+    memset(info, 0, sizeof(*info));
+    info->level = -1;
+
+    // TF_Log 模块前缀，含 ':' 的为时间，其余数字为日期
+    while (i < n && p[i] == '[')
+    {
+        uint32_t num[6];
+        int count = 0;
+        uint8_t colon = 0, date_sep = 0, digits = 0;
+        uint32_t v = 0;
+        size_t j = i + 1;
+
+        for (; j < n && p[j] != ']'; j++)
+        {
+            uint8_t c = p[j];
+            if (c >= '0' && c <= '9')
+            {
+                v = v * 10 + (uint32_t)(c - '0');
+                digits = 1;
+                continue;
+            }
+            if (c != ':' && c != '/' && c != '_' && c != '-' && c != ' ')
+            {
+                break;
+            }
+            colon |= (c == ':');
+            date_sep |= (c != ':' && c != ' ');
+            if (digits && count < 6)
+            {
+                num[count++] = v;
+            }
+            v = 0;
+            digits = 0;
+        }
+        if (j >= n || p[j] != ']' || !(colon || date_sep))
+        {
+            break; // 不是模块前缀（主控时间戳只含数字和 '.'）
+        }
+        if (digits && count < 6)
+        {
+            num[count++] = v;
+        }
+
+        int date_count = count;
+        if (colon && count >= 3)
+        {
+            info->has_clock = 1;
+            info->sec_of_day = num[count - 3] * 3600 + num[count - 2] * 60 + num[count - 1];
+            date_count = count - 3;
+        }
+        if (date_count == 1)
+        {
+            info->date = num[0];
+        }
+        else if (date_count == 2)
+        {
+            info->date = num[0] * 100 + num[1];
+        }
+        else if (date_count >= 3)
+        {
+            info->date = num[0] * 10000 + num[1] * 100 + num[2];
+        }
+        i = j + 1;
+    }
+    info->prefix_len = i;
+
+    // 二进制帧
+    if (i < n && p[i] == RP_LOG_HOST_FRAME_SYNC)
+    {
+        uint8_t scratch[RP_LOG_HOST_FRAME_MAX];
+        RP_LogHostFrame_t frame;
+        const uint8_t *end = (const uint8_t *)memchr(p + i + 1, RP_LOG_HOST_FRAME_SYNC, n - i - 1);
+
+        if (RP_LogHost_FrameDecode(p + i, (size_t)((end ? end : p + n) - (p + i)), scratch, &frame) !=
+            RP_LOG_HOST_FRAME_OK)
+        {
+            return -1;
+        }
+        if (frame.type == RP_LOG_HOST_FRAME_SCHEMA)
+        {
+            return -1; // 变量表不是日志行
+        }
+        info->is_frame = 1;
+        info->level = (int8_t)frame.level;
+        if (frame.type == RP_LOG_HOST_FRAME_DROPPED)
+        {
+            info->file = "RP_Log";
+            info->file_len = 6;
+            return info->level;
+        }
+        info->line = frame.line;
+        if (!frame.tick64)
+        {
+            info->has_tick = 1;
+            info->tick_us = frame.timestamp * 1000;
+        }
+        else if (dwt_hz != 0)
+        {
+            info->has_tick = 1;
+            info->tick_us = frame.timestamp / dwt_hz * 1000000 + (frame.timestamp % dwt_hz) * 1000000 / dwt_hz;
+        }
+        if (frame.type == RP_LOG_HOST_FRAME_SAMPLE)
+        {
+            info->is_sample = 1;
+            info->file = "RP_Log";
+            info->file_len = 6;
+            return info->level;
+        }
+        info->file = elf ? RP_LogHost_ElfString(elf, frame.file_addr) : NULL;
+        info->file_len = info->file ? (uint16_t)strlen(info->file) : 0;
+        return info->level;
+    }
+
+    // 主控时间戳 "[毫秒] " 或 "[秒.微秒] "
+    if (i < n && p[i] == '[')
+    {
+        uint64_t whole = 0, frac = 0;
+        int frac_digits = -1;
+        size_t j = i + 1;
+        for (; j < n && ((p[j] >= '0' && p[j] <= '9') || (p[j] == '.' && frac_digits < 0)); j++)
+        {
+            if (p[j] == '.')
+                frac_digits = 0;
+            else if (frac_digits < 0)
+                whole = whole * 10 + (uint64_t)(p[j] - '0');
+            else if (frac_digits < 6)
+            {
+                frac = frac * 10 + (uint64_t)(p[j] - '0');
+                frac_digits++;
+            }
+        }
+        if (j > i + 1 && j + 1 < n && p[j] == ']' && p[j + 1] == ' ')
+        {
+            info->has_tick = 1;
+            if (frac_digits < 0)
+            {
+                info->tick_us = whole * 1000;
+            }
+            else
+            {
+                while (frac_digits++ < 6)
+                    frac *= 10;
+                info->tick_us = whole * 1000000 + frac;
+            }
+            i = j + 2;
+        }
+    }
+
+    // "[等级][文件:行号]: "
+    if (i + 8 > n || p[i] != '[' || p[i + 6] != ']' || p[i + 7] != '[')
+    {
+        return -1;
+    }
+    for (int l = 0; l < 6; l++)
+    {
+        if (memcmp(p + i + 1, g_rp_log_host_level_names[l], 5) == 0)
+        {
+            info->level = (int8_t)l;
+            break;
+        }
+    }
+    if (info->level < 0)
+    {
+        return -1;
+    }
+
+    const uint8_t *file = p + i + 8;
+    const uint8_t *close = (const uint8_t *)memchr(file, ']', n - (i + 8));
+    if (close == NULL)
+    {
+        return info->level;
+    }
+    const uint8_t *colon = close;
+    while (colon > file && colon[-1] != ':')
+    {
+        colon--;
+    }
+    if (colon > file)
+    {
+        uint32_t line = 0;
+        for (const uint8_t *d = colon; d < close && *d >= '0' && *d <= '9'; d++)
+        {
+            line = line * 10 + (uint32_t)(*d - '0');
+        }
+        info->line = (uint16_t)line;
+        colon--;
+    }
+    else
+    {
+        colon = close;
+    }
+    info->file = (const char *)file;
+    info->file_len = (uint16_t)(colon - file);
+    info->is_sample = (size_t)(close - p) + 8 <= n && memcmp(close, "]: @tel ", 8) == 0;
+    return info->level;
+}
+
+/**
+ * @brief 保证缓冲区还能写入 n 字节
+ * @retval 0 成功，-1 内存不足
+ */
+int RP_LogHost_BufReserve(RP_LogHostBuf_t *buf, size_t n)
+{
+    if (buf->len + n <= buf->cap)
+    {
+        return 0;
+    }
+    size_t cap = buf->cap ? buf->cap : 4096;
+    while (cap < buf->len + n)
+    {
+        cap *= 2;
+    }
+    char *data = (char *)realloc(buf->data, cap);
+    if (data == NULL)
+    {
+        return -1;
+    }
+    buf->data = data;
+    buf->cap = cap;
+    return 0;
+}
+
+/**
+ * @brief 追加数据
+ * @retval 0 成功，-1 内存不足
+ */
+int RP_LogHost_BufAppend(RP_LogHostBuf_t *buf, const void *data, size_t n)
+{
+    if (RP_LogHost_BufReserve(buf, n) != 0)
+    {
+        return -1;
+    }
+    memcpy(buf->data + buf->len, data, n);
+    buf->len += n;
+    return 0;
+}
+
+/**
+ * @brief 释放缓冲区
+ */
+void RP_LogHost_BufFree(RP_LogHostBuf_t *buf)
+{
+    free(buf->data);
+    memset(buf, 0, sizeof(*buf));
+}
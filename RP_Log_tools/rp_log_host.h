@@ -0,0 +1,193 @@
+/**
+ ******************************************************************************
+ * File Name          : rp_log_host.h
+ * Description        : RP_Log host-side helpers (PC tools)
+ ******************************************************************************
+ * @attention
+ * Copyright (c) 2026 SZU RobotPilots.
+ *
+ * 上位机工具公用部分：文件映射、ELF 字符串查找、二进制帧解码、打包参数格式化、压缩帧解压、变量采样解析
+ * 与 RP_Log.c 中的帧格式（RP_LOG_USE_BINARY、RP_LOG_USE_COMPRESS、RP_LOG_USE_TELEMETRY）和参数打包规则保持一致
+ *
+ ******************************************************************************
+ */
+
+#ifndef RP_LOG_HOST_H
+#define RP_LOG_HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 帧格式（与 RP_Log.h 中的 RP_LOG_FRAME_XXX 相同） -------------------------*/
+
+#define RP_LOG_HOST_FRAME_SYNC 0xA5
+#define RP_LOG_HOST_FRAME_ESC 0x7D
+#define RP_LOG_HOST_FRAME_ESC_XOR 0x20
+#define RP_LOG_HOST_FRAME_RECORD 0x01
+#define RP_LOG_HOST_FRAME_DROPPED 0x02
+#define RP_LOG_HOST_FRAME_LZ 0x03
+#define RP_LOG_HOST_FRAME_DATA 0x04
+#define RP_LOG_HOST_FRAME_SAMPLE 0x05
+#define RP_LOG_HOST_FRAME_SCHEMA 0x06
+#define RP_LOG_HOST_FRAME_TICK64 0x80
+
+#define RP_LOG_HOST_DATA_RAW 0x01   // 原始数据方式：可打印字符（否则十六进制）
+#define RP_LOG_HOST_DATA_SPLIT 0x40 // 原始数据分多帧，行首带偏移
+#define RP_LOG_HOST_DATA_CUT 0x80   // 原始数据被截断，本帧为最后一段
+
+#define RP_LOG_HOST_VAR_MAX 255 // 变量表最多变量数（RP_LOG_TELEMETRY_VAR_MAX 最大 255）
+
+#define RP_LOG_HOST_LZ_RESET 0x80       // 压缩块标志：从空窗口开始
+#define RP_LOG_HOST_LZ_WINDOW_MAX 4096  // 压缩窗口最大长度（RP_LOG_COMPRESS_WINDOW_BITS 最大 12）
+
+#define RP_LOG_HOST_FRAME_MAX 4096 // 去转义后单帧最大长度
+#define RP_LOG_HOST_LINE_MAX 4096  // 还原后单行最大长度
+
+/* 帧解码结果 */
+#define RP_LOG_HOST_FRAME_OK 0        // 解码成功
+#define RP_LOG_HOST_FRAME_BAD_CRC -1  // CRC 错误
+#define RP_LOG_HOST_FRAME_BAD_LEN -2  // 长度与类型不符
+#define RP_LOG_HOST_FRAME_BAD_TYPE -3 // 未知类型
+
+/* Exported types ------------------------------------------------------------*/
+
+// 只读映射的文件
+typedef struct
+{
+    const uint8_t *data; // 文件内容
+    size_t size;         // 文件大小
+    void *handle;        // 平台相关句柄
+} RP_LogHostMap_t;
+
+// ELF 中一个可加载段
+typedef struct
+{
+    uint64_t addr;       // 运行地址
+    uint64_t size;       // 长度
+    const uint8_t *data; // 在映射文件中的位置
+} RP_LogHostSection_t;
+
+// 已加载的 ELF（只保留有内容的 SHF_ALLOC 段）
+typedef struct
+{
+    RP_LogHostMap_t map;
+    RP_LogHostSection_t *sections;
+    int count;
+    uint8_t ptr_size; // 目标的 long、size_t、指针长度（ELF32=4，ELF64=8）
+} RP_LogHostElf_t;
+
+// 解码后的一帧
+typedef struct
+{
+    uint8_t type;         // 帧类型（已去掉 TICK64 标志）
+    uint16_t seq;         // 序号
+    uint8_t level;        // 日志等级
+    uint16_t line;        // 行号
+    uint8_t tick64;       // 时间戳为 64 位 DWT 周期数
+    uint64_t timestamp;   // 时间戳原始计数
+    uint32_t file_addr;   // 文件名地址
+    uint32_t format_addr; // 格式串地址
+    const uint8_t *args;  // 打包参数（指向解码缓冲区），DATA 帧为原始数据
+    uint16_t args_len;    // 打包参数长度
+    uint32_t dropped;     // 丢弃条数（DROPPED 帧）
+    uint8_t data_kind;    // 原始数据方式 | 标志（DATA 帧）
+    uint16_t data_offset; // 本帧数据在整条中的偏移（DATA 帧）
+    uint16_t sample_seq;  // 采样序号（SAMPLE 帧）
+    uint8_t var_count;    // 变量数（SAMPLE、SCHEMA 帧），args 为各变量原始值或 类型(1) + 变量名地址(4)
+} RP_LogHostFrame_t;
+
+// 变量表（SCHEMA 帧），类型与 RP_Log.h 中的 RP_LogVarType_t 相同
+typedef struct
+{
+    uint16_t count;                            // 变量数（0=尚未收到变量表）
+    uint8_t types[RP_LOG_HOST_VAR_MAX];        // 变量类型
+    const char *names[RP_LOG_HOST_VAR_MAX];    // 变量名（ELF 中找不到时为 "0x地址"）
+    char unnamed[RP_LOG_HOST_VAR_MAX][12];     // 找不到变量名时的地址文本
+} RP_LogHostSchema_t;
+
+// 一次采样（采样帧或文本 "@tel" 行，文本行一次采样可能分为多行）
+typedef struct
+{
+    uint16_t seq;                              // 采样序号
+    uint16_t count;                            // 本行的变量数
+    const char *names[RP_LOG_HOST_VAR_MAX];    // 变量名（不以 '\0' 结尾）
+    uint16_t name_lens[RP_LOG_HOST_VAR_MAX];   // 变量名长度
+    double values[RP_LOG_HOST_VAR_MAX];        // 变量值
+} RP_LogHostSample_t;
+
+// 压缩帧解压统计
+typedef struct
+{
+    uint64_t blocks;     // 解压的压缩块
+    uint64_t skipped;    // 丢帧后等待下一个重置块期间跳过的块
+    uint64_t bad_blocks; // CRC 或数据错误的块
+    uint64_t in_bytes;   // 压缩帧字节数（含帧头尾和转义）
+    uint64_t out_bytes;  // 解压后的字节数
+} RP_LogHostInflate_t;
+
+// 一行日志的解析结果
+typedef struct
+{
+    int8_t level;          // 日志等级（-1=不是 RP_Log 日志行，如模块文件头）
+    uint8_t is_frame;      // 二进制帧
+    uint8_t has_clock;     // 有 TF_Log 模块的时间前缀
+    uint8_t has_tick;      // 有主控时间戳
+    uint8_t is_sample;     // 变量采样（文本 "@tel" 行或采样帧），不是普通日志
+    uint32_t date;         // 模块日期 年*10000+月*100+日（没有年份时年为 0）
+    uint32_t sec_of_day;   // 模块时间（当天秒数）
+    uint64_t tick_us;      // 主控时间戳（微秒）
+    const char *file;      // 源文件名（不以 '\0' 结尾）
+    uint16_t file_len;     // 源文件名长度
+    uint16_t line;         // 行号
+    size_t prefix_len;     // 模块时间前缀长度
+} RP_LogHostLine_t;
+
+// 可增长的输出缓冲区
+typedef struct
+{
+    char *data;
+    size_t len;
+    size_t cap;
+} RP_LogHostBuf_t;
+
+/* Exported functions --------------------------------------------------------*/
+
+extern const char *const g_rp_log_host_level_names[6]; // "FATAL" ... "TRACE"（与 RP_Log.c 相同，含尾部空格）
+
+int RP_LogHost_MapFile(RP_LogHostMap_t *map, const char *path); // 映射文件，成功返回 0
+void RP_LogHost_UnmapFile(RP_LogHostMap_t *map);                // 取消映射
+
+int RP_LogHost_ElfOpen(RP_LogHostElf_t *elf, const char *path);                // 加载 ELF，成功返回 0
+void RP_LogHost_ElfClose(RP_LogHostElf_t *elf);                                // 释放 ELF
+const char *RP_LogHost_ElfString(const RP_LogHostElf_t *elf, uint32_t addr);   // 按地址取常量字符串，找不到返回 NULL
+
+uint16_t RP_LogHost_Crc16(uint16_t crc, const uint8_t *data, size_t length);   // CRC16-CCITT
+int RP_LogHost_FrameDecode(const uint8_t *p, size_t n, uint8_t *scratch,
+                           RP_LogHostFrame_t *frame);                          // 解码一帧（p 指向 SYNC），返回 RP_LOG_HOST_FRAME_XXX
+
+int RP_LogHost_FormatArgs(char *buf, size_t size, const char *format, const uint8_t *args,
+                          uint16_t args_len, uint8_t ptr_size);                // 按打包参数格式化，返回长度
+int RP_LogHost_FormatTimestamp(char *buf, size_t size, const RP_LogHostFrame_t *frame,
+                               uint32_t dwt_hz);                               // 格式化时间戳（与单片机输出相同）
+int RP_LogHost_FormatFrame(char *buf, size_t size, const RP_LogHostElf_t *elf,
+                           const RP_LogHostFrame_t *frame, uint32_t dwt_hz);   // 还原为一行文本（不含换行），返回长度
+
+void RP_LogHost_SchemaLoad(RP_LogHostSchema_t *schema, const RP_LogHostElf_t *elf,
+                           const RP_LogHostFrame_t *frame);                    // 从变量表帧更新变量表
+int RP_LogHost_FormatSample(char *buf, size_t size, const RP_LogHostSchema_t *schema,
+                            const RP_LogHostFrame_t *frame, uint32_t dwt_hz);  // 采样帧还原为一行文本（不含换行），返回长度
+int RP_LogHost_ParseSample(const uint8_t *p, size_t n, const RP_LogHostLine_t *info, const RP_LogHostElf_t *elf,
+                           RP_LogHostSchema_t *schema,
+                           RP_LogHostSample_t *sample);                        // 解析一行中的采样，返回 1=采样，2=变量表帧，0=其他
+
+int RP_LogHost_Inflate(const uint8_t *p, size_t n, RP_LogHostBuf_t *out,
+                       RP_LogHostInflate_t *stats);                            // 解压文件中的压缩帧，返回 1=已解压到 out，0=没有压缩帧，-1=内存不足
+
+int RP_LogHost_ParseLine(const uint8_t *p, size_t n, const RP_LogHostElf_t *elf, uint32_t dwt_hz,
+                         RP_LogHostLine_t *info);                              // 解析一行（不含换行），返回 info->level
+
+int RP_LogHost_BufReserve(RP_LogHostBuf_t *buf, size_t n);                     // 保证还能写入 n 字节，失败返回 -1
+int RP_LogHost_BufAppend(RP_LogHostBuf_t *buf, const void *data, size_t n);    // 追加数据，失败返回 -1
+void RP_LogHost_BufFree(RP_LogHostBuf_t *buf);                                 // 释放缓冲区
+
+#endif
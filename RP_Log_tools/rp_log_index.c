@@ -0,0 +1,897 @@
+/**
+ ******************************************************************************
+ * File Name          : rp_log_index.c
+ * Description        : RP_Log .LOG indexer and search (PC tool)
+ ******************************************************************************
+ * @attention
+ * Copyright (c) 2026 SZU RobotPilots.
+ *
+ * 为每个 .LOG 文件生成旁路索引（xxx.LOG.idx），按等级、源文件、时间快速检索
+ * 索引一次顺序扫描生成，日志文件大小或修改时间变化后查询时自动重建
+ *
+ * 编译：gcc -O2 rp_log_index.c rp_log_host.c -o rp_log_index
+ * 用法：rp_log_index build [-e app.elf] [-f dwt_hz] xxx.LOG ...
+ *       rp_log_index query [-l 等级] [-s 源文件] [-t 开始-结束] [-c] [-e app.elf] [-f dwt_hz] 文件或目录 ...
+ *   如：rp_log_index query -l ERROR -s motor.c -t 02:10-02:40 /media/TF
+ *
+ ******************************************************************************
+ */
+
+#define _FILE_OFFSET_BITS 64
+#include "rp_log_host.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/* Private define ------------------------------------------------------------*/
+
+#define INDEX_MAGIC "RPLI"
+#define INDEX_VERSION 1
+#define INDEX_NO_TIME 0xFFFFFFFFu // 查询未限定时间
+
+/* Private types -------------------------------------------------------------*/
+
+// 索引文件头（其后依次为：文件名表、各等级偏移表、各源文件偏移表、时间分桶）
+// 偏移均为 32 位：TF 卡为 FAT32，单个文件不超过 4GB；多字节字段按主机字节序（小端）存放
+typedef struct
+{
+    char magic[4];           // "RPLI"
+    uint32_t version;        // INDEX_VERSION
+    uint64_t log_size;       // 建立索引时的日志文件大小
+    int64_t log_mtime;       // 建立索引时的日志修改时间
+    uint32_t level_count[6]; // 各等级日志行数
+    uint32_t file_count;     // 源文件数
+    uint32_t bucket_count;   // 时间分桶数
+    uint32_t names_size;     // 文件名表字节数
+} Index_Header_t;
+
+// 时间分桶：模块时间每变化一秒记录一次该秒第一行的位置
+typedef struct
+{
+    uint32_t date;   // 模块日期
+    uint32_t sec;    // 当天秒数
+    uint32_t offset; // 该秒第一行在日志中的偏移
+} Index_Bucket_t;
+
+// 可增长的 32 位数组
+typedef struct
+{
+    uint32_t *data;
+    size_t len;
+    size_t cap;
+} Index_Vec_t;
+
+// 建立索引时的源文件表项
+typedef struct
+{
+    char *name;
+    uint16_t len;
+    Index_Vec_t offsets;
+} Index_File_t;
+
+// 已加载的索引
+typedef struct
+{
+    RP_LogHostMap_t map;
+    const Index_Header_t *hdr;
+    const uint8_t *names;                  // 文件名表：{ 条数(4) 长度(2) 文件名 } x file_count
+    const uint32_t *levels[6];             // 各等级偏移表
+    const uint32_t **files;                // 各源文件偏移表
+    const Index_Bucket_t *buckets;         // 时间分桶
+} Index_t;
+
+// 查询条件
+typedef struct
+{
+    uint8_t level_mask;     // 等级（bit n = 等级 n，0=不限）
+    const char *sources[16]; // 源文件名（NULL 结尾）
+    uint32_t t_begin;       // 开始时间（当天秒数，INDEX_NO_TIME=不限）
+    uint32_t t_end;         // 结束时间（含）
+    int count_only;         // 只统计条数
+} Index_Query_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+static const RP_LogHostElf_t *g_elf;
+static uint32_t g_dwt_hz;
+
+/* Private functions ---------------------------------------------------------*/
+
+static int Index_VecPush(Index_Vec_t *v, uint32_t x)
+{
+    if (v->len == v->cap)
+    {
+        size_t cap = v->cap ? v->cap * 2 : 256;
+        uint32_t *data = (uint32_t *)realloc(v->data, cap * sizeof(uint32_t));
+        if (data == NULL)
+        {
+            return -1;
+        }
+        v->data = data;
+        v->cap = cap;
+    }
+    v->data[v->len++] = x;
+    return 0;
+}
+
+// 源文件名散列（FNV-1a）
+static uint32_t Index_Hash(const char *s, uint16_t len)
+{
+    uint32_t h = 2166136261u;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        h = (h ^ (uint8_t)s[i]) * 16777619u;
+    }
+    return h;
+}
+
+// 索引文件路径
+static void Index_Path(char *buf, size_t size, const char *log_path)
+{
+    snprintf(buf, size, "%s.idx", log_path);
+}
+
+/**
+ * @brief 顺序扫描一次日志，生成索引文件
+ * @retval 0 成功，-1 失败
+ */
+static int Index_Build(const char *log_path)
+{
+    RP_LogHostMap_t map;
+    struct stat st;
+    Index_Vec_t levels[6] = {{0}};
+    Index_Bucket_t *buckets = NULL;
+    size_t bucket_count = 0, bucket_cap = 0;
+    Index_File_t *files = NULL;
+    size_t file_count = 0;
+    int32_t *table = NULL; // 散列表：源文件序号，-1 为空
+    size_t table_size = 256;
+    uint32_t cur_date = 0, cur_sec = INDEX_NO_TIME;
+    int ret = -1;
+    FILE *fp = NULL;
+    char idx_path[1024], tmp_path[1040];
+
+    if (stat(log_path, &st) != 0 || RP_LogHost_MapFile(&map, log_path) != 0)
+    {
+        fprintf(stderr, "rp_log_index: cannot open %s\n", log_path);
+        return -1;
+    }
+    if (map.size > 0xFFFFFFFFu)
+    {
+        fprintf(stderr, "rp_log_index: %s is larger than 4GB\n", log_path);
+        RP_LogHost_UnmapFile(&map);
+        return -1;
+    }
+
+    table = (int32_t *)malloc(table_size * sizeof(int32_t));
+    if (table == NULL)
+    {
+        goto out;
+    }
+    memset(table, 0xFF, table_size * sizeof(int32_t));
+
+    for (size_t pos = 0; pos < map.size;)
+    {
+        const uint8_t *p = map.data + pos;
+        const uint8_t *nl = (const uint8_t *)memchr(p, '\n', map.size - pos);
+        size_t n = nl ? (size_t)(nl - p) : map.size - pos;
+        size_t next = pos + n + (nl ? 1 : 0);
+        RP_LogHostLine_t info;
+
+        if (n > 0 && p[n - 1] == '\r')
+        {
+            n--;
+        }
+        RP_LogHost_ParseLine(p, n, g_elf, g_dwt_hz, &info);
+
+        // 时间分桶
+        if (info.has_clock && (info.sec_of_day != cur_sec || info.date != cur_date))
+        {
+            if (bucket_count == bucket_cap)
+            {
+                size_t cap = bucket_cap ? bucket_cap * 2 : 1024;
+                Index_Bucket_t *b = (Index_Bucket_t *)realloc(buckets, cap * sizeof(Index_Bucket_t));
+                if (b == NULL)
+                {
+                    goto out;
+                }
+                buckets = b;
+                bucket_cap = cap;
+            }
+            cur_sec = info.sec_of_day;
+            cur_date = info.date;
+            buckets[bucket_count].date = cur_date;
+            buckets[bucket_count].sec = cur_sec;
+            buckets[bucket_count].offset = (uint32_t)pos;
+            bucket_count++;
+        }
+
+        if (info.level >= 0)
+        {
+            const char *name = info.file ? info.file : "?";
+            uint16_t len = info.file ? info.file_len : 1;
+
+            if (Index_VecPush(&levels[info.level], (uint32_t)pos) != 0)
+            {
+                goto out;
+            }
+
+            // 查找或新建源文件表项
+            size_t h = Index_Hash(name, len) & (table_size - 1);
+            while (table[h] >= 0 && (files[table[h]].len != len || memcmp(files[table[h]].name, name, len) != 0))
+            {
+                h = (h + 1) & (table_size - 1);
+            }
+            if (table[h] < 0)
+            {
+                Index_File_t *f = (Index_File_t *)realloc(files, (file_count + 1) * sizeof(Index_File_t));
+                if (f == NULL)
+                {
+                    goto out;
+                }
+                files = f;
+                memset(&files[file_count], 0, sizeof(Index_File_t));
+                files[file_count].name = (char *)malloc(len);
+                if (files[file_count].name == NULL)
+                {
+                    goto out;
+                }
+                memcpy(files[file_count].name, name, len);
+                files[file_count].len = len;
+                table[h] = (int32_t)file_count++;
+            }
+            int32_t id = table[h];
+            if (Index_VecPush(&files[id].offsets, (uint32_t)pos) != 0)
+            {
+                goto out;
+            }
+
+            // 装载率超过一半时扩容
+            if (file_count * 2 > table_size)
+            {
+                int32_t *t = (int32_t *)malloc(table_size * 2 * sizeof(int32_t));
+                if (t == NULL)
+                {
+                    goto out;
+                }
+                free(table);
+                table = t;
+                table_size *= 2;
+                memset(table, 0xFF, table_size * sizeof(int32_t));
+                for (size_t i = 0; i < file_count; i++)
+                {
+                    size_t k = Index_Hash(files[i].name, files[i].len) & (table_size - 1);
+                    while (table[k] >= 0)
+                    {
+                        k = (k + 1) & (table_size - 1);
+                    }
+                    table[k] = (int32_t)i;
+                }
+            }
+        }
+
+        pos = next;
+    }
+
+    // 写出：先写临时文件再替换，中途失败不会留下半个索引
+    Index_Header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, INDEX_MAGIC, 4);
+    hdr.version = INDEX_VERSION;
+    hdr.log_size = map.size;
+    hdr.log_mtime = (int64_t)st.st_mtime;
+    for (int l = 0; l < 6; l++)
+    {
+        hdr.level_count[l] = (uint32_t)levels[l].len;
+    }
+    hdr.file_count = (uint32_t)file_count;
+    hdr.bucket_count = (uint32_t)bucket_count;
+    for (size_t i = 0; i < file_count; i++)
+    {
+        hdr.names_size += 4 + 2 + files[i].len;
+    }
+
+    Index_Path(idx_path, sizeof(idx_path), log_path);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", idx_path);
+    fp = fopen(tmp_path, "wb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "rp_log_index: cannot create %s\n", tmp_path);
+        goto out;
+    }
+    fwrite(&hdr, sizeof(hdr), 1, fp);
+    for (size_t i = 0; i < file_count; i++)
+    {
+        uint32_t count = (uint32_t)files[i].offsets.len;
+        fwrite(&count, 4, 1, fp);
+        fwrite(&files[i].len, 2, 1, fp);
+        fwrite(files[i].name, 1, files[i].len, fp);
+    }
+    // 偏移表按 4 字节对齐
+    static const uint8_t pad[4] = {0};
+    fwrite(pad, 1, (4 - (sizeof(hdr) + hdr.names_size) % 4) % 4, fp);
+    for (int l = 0; l < 6; l++)
+    {
+        fwrite(levels[l].data, 4, levels[l].len, fp);
+    }
+    for (size_t i = 0; i < file_count; i++)
+    {
+        fwrite(files[i].offsets.data, 4, files[i].offsets.len, fp);
+    }
+    fwrite(buckets, sizeof(Index_Bucket_t), bucket_count, fp);
+    if (ferror(fp) | fclose(fp))
+    {
+        fp = NULL;
+        remove(tmp_path);
+        goto out;
+    }
+    fp = NULL;
+    remove(idx_path);
+    if (rename(tmp_path, idx_path) != 0)
+    {
+        goto out;
+    }
+    ret = 0;
+
+out:
+    if (ret != 0)
+    {
+        fprintf(stderr, "rp_log_index: failed to index %s\n", log_path);
+    }
+    for (int l = 0; l < 6; l++)
+    {
+        free(levels[l].data);
+    }
+    for (size_t i = 0; i < file_count; i++)
+    {
+        free(files[i].name);
+        free(files[i].offsets.data);
+    }
+    free(files);
+    free(table);
+    free(buckets);
+    RP_LogHost_UnmapFile(&map);
+    return ret;
+}
+
+static void Index_Close(Index_t *idx)
+{
+    free(idx->files);
+    RP_LogHost_UnmapFile(&idx->map);
+    memset(idx, 0, sizeof(*idx));
+}
+
+/**
+ * @brief 加载索引，并检查是否与日志文件一致
+ * @retval 0 成功，-1 索引不存在、损坏或已过期
+ */
+static int Index_Open(Index_t *idx, const char *log_path)
+{
+    char idx_path[1024];
+    struct stat st;
+
+    memset(idx, 0, sizeof(*idx));
+    Index_Path(idx_path, sizeof(idx_path), log_path);
+    if (stat(log_path, &st) != 0 || RP_LogHost_MapFile(&idx->map, idx_path) != 0)
+    {
+        return -1;
+    }
+
+    const Index_Header_t *hdr = (const Index_Header_t *)idx->map.data;
+    if (idx->map.size < sizeof(*hdr) || memcmp(hdr->magic, INDEX_MAGIC, 4) != 0 || hdr->version != INDEX_VERSION ||
+        hdr->log_size != (uint64_t)st.st_size || hdr->log_mtime != (int64_t)st.st_mtime)
+    {
+        Index_Close(idx);
+        return -1;
+    }
+
+    // 校验各部分长度
+    uint64_t total = 0;
+    for (int l = 0; l < 6; l++)
+    {
+        total += hdr->level_count[l];
+    }
+    size_t offsets_at = (sizeof(*hdr) + hdr->names_size + 3) & ~(size_t)3;
+    uint64_t need = (uint64_t)offsets_at + total * 4 * 2 + (uint64_t)hdr->bucket_count * sizeof(Index_Bucket_t);
+    if (need != idx->map.size)
+    {
+        Index_Close(idx);
+        return -1;
+    }
+
+    idx->hdr = hdr;
+    idx->names = idx->map.data + sizeof(*hdr);
+    idx->files = (const uint32_t **)calloc(hdr->file_count ? hdr->file_count : 1, sizeof(uint32_t *));
+    if (idx->files == NULL)
+    {
+        Index_Close(idx);
+        return -1;
+    }
+
+    const uint32_t *p = (const uint32_t *)(idx->map.data + offsets_at);
+    for (int l = 0; l < 6; l++)
+    {
+        idx->levels[l] = p;
+        p += hdr->level_count[l];
+    }
+    const uint8_t *name = idx->names;
+    for (uint32_t i = 0; i < hdr->file_count; i++)
+    {
+        uint32_t count;
+        uint16_t len;
+        memcpy(&count, name, 4);
+        memcpy(&len, name + 4, 2);
+        idx->files[i] = p;
+        p += count;
+        name += 6 + len;
+    }
+    idx->buckets = (const Index_Bucket_t *)p;
+    return 0;
+}
+
+// 第一个不小于 x 的位置
+static size_t Index_LowerBound(const uint32_t *a, size_t n, uint32_t x)
+{
+    size_t lo = 0, hi = n;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (a[mid] < x)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// 把有序表 a 中落在 [begin, end) 内的偏移追加到 out
+static int Index_Collect(Index_Vec_t *out, const uint32_t *a, size_t n, uint32_t begin, uint32_t end)
+{
+    for (size_t i = Index_LowerBound(a, n, begin); i < n && a[i] < end; i++)
+    {
+        if (Index_VecPush(out, a[i]) != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int Index_CompareU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// 时间是否在查询范围内（结束早于开始时视为跨过零点）
+static int Index_TimeMatch(const Index_Query_t *q, uint32_t sec)
+{
+    if (q->t_begin <= q->t_end)
+    {
+        return sec >= q->t_begin && sec <= q->t_end;
+    }
+    return sec >= q->t_begin || sec <= q->t_end;
+}
+
+// 输出一行，二进制帧在给出 ELF 时还原为文本
+static void Index_PrintLine(const char *log_path, int show_name, const uint8_t *data, size_t size, uint32_t offset)
+{
+    const uint8_t *p = data + offset;
+    const uint8_t *nl = (const uint8_t *)memchr(p, '\n', size - offset);
+    size_t n = nl ? (size_t)(nl - p) : size - offset;
+    if (n > 0 && p[n - 1] == '\r')
+    {
+        n--;
+    }
+
+    if (show_name)
+    {
+        fputs(log_path, stdout);
+        fputc(':', stdout);
+    }
+
+    const uint8_t *sync = (const uint8_t *)memchr(p, RP_LOG_HOST_FRAME_SYNC, n);
+    if (g_elf != NULL && sync != NULL)
+    {
+        uint8_t scratch[RP_LOG_HOST_FRAME_MAX];
+        char text[RP_LOG_HOST_LINE_MAX];
+        RP_LogHostFrame_t frame;
+        const uint8_t *end = (const uint8_t *)memchr(sync + 1, RP_LOG_HOST_FRAME_SYNC, (size_t)(p + n - sync - 1));
+        if (RP_LogHost_FrameDecode(sync, (size_t)((end ? end : p + n) - sync), scratch, &frame) == RP_LOG_HOST_FRAME_OK)
+        {
+            int len = RP_LogHost_FormatFrame(text, sizeof(text), g_elf, &frame, g_dwt_hz);
+            fwrite(p, 1, (size_t)(sync - p), stdout);
+            fwrite(text, 1, (size_t)len, stdout);
+            fputc('\n', stdout);
+            return;
+        }
+    }
+    fwrite(p, 1, n, stdout);
+    fputc('\n', stdout);
+}
+
+/**
+ * @brief 在一个日志文件中查询
+ * @retval 匹配条数，失败返回 -1
+ */
+static long Index_QueryFile(const char *log_path, const Index_Query_t *q, int show_name)
+{
+    Index_t idx;
+    RP_LogHostMap_t log;
+    Index_Vec_t ranges = {0};  // 成对的 [开始, 结束) 偏移
+    Index_Vec_t by_level = {0};
+    Index_Vec_t by_file = {0};
+    long matched = 0;
+
+    if (Index_Open(&idx, log_path) != 0)
+    {
+        if (Index_Build(log_path) != 0 || Index_Open(&idx, log_path) != 0)
+        {
+            return -1;
+        }
+    }
+    if (RP_LogHost_MapFile(&log, log_path) != 0)
+    {
+        Index_Close(&idx);
+        return -1;
+    }
+
+    const Index_Header_t *hdr = idx.hdr;
+    uint64_t size = hdr->log_size;
+
+    // 时间范围：连续匹配的分桶合并为一段
+    if (q->t_begin == INDEX_NO_TIME)
+    {
+        Index_VecPush(&ranges, 0);
+        Index_VecPush(&ranges, (uint32_t)size);
+    }
+    else
+    {
+        for (uint32_t b = 0; b < hdr->bucket_count; b++)
+        {
+            if (!Index_TimeMatch(q, idx.buckets[b].sec))
+            {
+                continue;
+            }
+            uint32_t end = (b + 1 < hdr->bucket_count) ? idx.buckets[b + 1].offset : (uint32_t)size;
+            if (ranges.len > 0 && ranges.data[ranges.len - 1] == idx.buckets[b].offset)
+            {
+                ranges.data[ranges.len - 1] = end;
+            }
+            else
+            {
+                Index_VecPush(&ranges, idx.buckets[b].offset);
+                Index_VecPush(&ranges, end);
+            }
+        }
+    }
+
+    // 等级和源文件分别取并集，再求交集
+    for (size_t r = 0; r + 1 < ranges.len; r += 2)
+    {
+        uint32_t begin = ranges.data[r];
+        uint32_t end = ranges.data[r + 1];
+        for (int l = 0; l < 6; l++)
+        {
+            if (q->level_mask == 0 || (q->level_mask & (1u << l)))
+            {
+                Index_Collect(&by_level, idx.levels[l], hdr->level_count[l], begin, end);
+            }
+        }
+        if (q->sources[0] != NULL)
+        {
+            const uint8_t *name = idx.names;
+            for (uint32_t i = 0; i < hdr->file_count; i++)
+            {
+                uint32_t count;
+                uint16_t len;
+                memcpy(&count, name, 4);
+                memcpy(&len, name + 4, 2);
+                for (int s = 0; q->sources[s] != NULL; s++)
+                {
+                    if (strlen(q->sources[s]) == len && memcmp(q->sources[s], name + 6, len) == 0)
+                    {
+                        Index_Collect(&by_file, idx.files[i], count, begin, end);
+                        break;
+                    }
+                }
+                name += 6 + len;
+            }
+        }
+    }
+    qsort(by_level.data, by_level.len, sizeof(uint32_t), Index_CompareU32);
+
+    const uint32_t *hits = by_level.data;
+    size_t hit_count = by_level.len;
+    if (q->sources[0] != NULL)
+    {
+        qsort(by_file.data, by_file.len, sizeof(uint32_t), Index_CompareU32);
+        size_t i = 0, j = 0, k = 0;
+        while (i < by_level.len && j < by_file.len)
+        {
+            if (by_level.data[i] < by_file.data[j])
+                i++;
+            else if (by_level.data[i] > by_file.data[j])
+                j++;
+            else
+            {
+                by_level.data[k++] = by_level.data[i];
+                i++;
+                j++;
+            }
+        }
+        hit_count = k;
+    }
+
+    for (size_t i = 0; i < hit_count; i++)
+    {
+        if (!q->count_only)
+        {
+            Index_PrintLine(log_path, show_name, log.data, log.size, hits[i]);
+        }
+    }
+    matched = (long)hit_count;
+
+    free(ranges.data);
+    free(by_level.data);
+    free(by_file.data);
+    RP_LogHost_UnmapFile(&log);
+    Index_Close(&idx);
+    return matched;
+}
+
+// 展开目录下的 .LOG 文件（按文件名排序，与模块的命名规则一致即为时间顺序）
+static int Index_CompareName(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int Index_ListDir(const char *dir, char ***list, size_t *count)
+{
+    DIR *d = opendir(dir);
+    struct dirent *e;
+    size_t start = *count;
+
+    if (d == NULL)
+    {
+        return -1;
+    }
+    while ((e = readdir(d)) != NULL)
+    {
+        size_t len = strlen(e->d_name);
+        if (len < 4 || (strcmp(e->d_name + len - 4, ".LOG") != 0 && strcmp(e->d_name + len - 4, ".log") != 0))
+        {
+            continue;
+        }
+        char **l = (char **)realloc(*list, (*count + 1) * sizeof(char *));
+        if (l == NULL)
+        {
+            break;
+        }
+        *list = l;
+        size_t size = strlen(dir) + 1 + len + 1;
+        (*list)[*count] = (char *)malloc(size);
+        if ((*list)[*count] == NULL)
+        {
+            break;
+        }
+        snprintf((*list)[*count], size, "%s/%s", dir, e->d_name);
+        (*count)++;
+    }
+    closedir(d);
+    qsort(*list + start, *count - start, sizeof(char *), Index_CompareName);
+    return 0;
+}
+
+// 解析 "HH:MM[:SS]"，只给到分钟时 is_end 为 1 则取该分钟最后一秒
+static int Index_ParseTime(const char *s, int is_end, uint32_t *sec)
+{
+    unsigned h = 0, m = 0, x = 0;
+    int n = sscanf(s, "%u:%u:%u", &h, &m, &x);
+    if (n < 2 || h > 23 || m > 59 || x > 59)
+    {
+        return -1;
+    }
+    *sec = h * 3600 + m * 60 + (n == 3 ? x : (is_end ? 59 : 0));
+    return 0;
+}
+
+static int Index_ParseLevels(const char *s, uint8_t *mask)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s", s);
+    for (char *tok = strtok(buf, ","); tok != NULL; tok = strtok(NULL, ","))
+    {
+        size_t len = strlen(tok);
+        int at_least = (len > 0 && tok[len - 1] == '+'); // "WARN+" 表示 WARN 及更严重的等级
+        if (at_least)
+        {
+            tok[--len] = '\0';
+        }
+        int level = -1;
+        for (int l = 0; l < 6; l++)
+        {
+            const char *name = g_rp_log_host_level_names[l];
+            size_t name_len = (name[4] == ' ') ? 4 : 5;
+            if (len == name_len && strncmp(tok, name, name_len) == 0)
+            {
+                level = l;
+            }
+        }
+        if (level < 0)
+        {
+            return -1;
+        }
+        *mask |= at_least ? (uint8_t)((1u << (level + 1)) - 1) : (uint8_t)(1u << level);
+    }
+    return 0;
+}
+
+static void Index_Usage(void)
+{
+    fprintf(stderr,
+            "usage: rp_log_index build [-e app.elf] [-f dwt_hz] file.LOG ...\n"
+            "       rp_log_index query [-l LEVELS] [-s SOURCES] [-t HH:MM[:SS]-HH:MM[:SS]] [-c]\n"
+            "                          [-e app.elf] [-f dwt_hz] file.LOG|dir ...\n"
+            "  -l  levels, comma separated; WARN+ means WARN and more severe\n"
+            "  -s  source file names, comma separated (as printed in [file:line])\n"
+            "  -t  TF_Log module time range (end before start wraps past midnight)\n"
+            "  -c  print match counts only\n"
+            "  -e  firmware ELF, needed to index and print binary frames (RP_LOG_USE_BINARY)\n");
+}
+
+int main(int argc, char **argv)
+{
+    RP_LogHostElf_t elf;
+    Index_Query_t q;
+    char source_buf[256] = {0};
+    const char *elf_path = NULL;
+    int first = argc;
+
+    if (argc < 3 || (strcmp(argv[1], "build") != 0 && strcmp(argv[1], "query") != 0))
+    {
+        Index_Usage();
+        return 2;
+    }
+    int build = (strcmp(argv[1], "build") == 0);
+
+    memset(&q, 0, sizeof(q));
+    q.t_begin = INDEX_NO_TIME;
+    for (int i = 2; i < argc; i++)
+    {
+        if (argv[i][0] != '-')
+        {
+            first = i;
+            break;
+        }
+        if (argv[i][1] == 'c')
+        {
+            q.count_only = 1;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            Index_Usage();
+            return 2;
+        }
+        const char *v = argv[++i];
+        switch (argv[i - 1][1])
+        {
+        case 'e':
+            elf_path = v;
+            break;
+        case 'f':
+            g_dwt_hz = (uint32_t)strtoul(v, NULL, 0);
+            break;
+        case 'l':
+            if (Index_ParseLevels(v, &q.level_mask) != 0)
+            {
+                fprintf(stderr, "rp_log_index: bad level list %s\n", v);
+                return 2;
+            }
+            break;
+        case 's':
+        {
+            int s = 0;
+            snprintf(source_buf, sizeof(source_buf), "%s", v);
+            for (char *tok = strtok(source_buf, ","); tok != NULL && s < 15; tok = strtok(NULL, ","))
+            {
+                q.sources[s++] = tok;
+            }
+            q.sources[s] = NULL;
+            break;
+        }
+        case 't':
+        {
+            const char *dash = strchr(v, '-');
+            if (dash == NULL || Index_ParseTime(v, 0, &q.t_begin) != 0 || Index_ParseTime(dash + 1, 1, &q.t_end) != 0)
+            {
+                fprintf(stderr, "rp_log_index: bad time range %s\n", v);
+                return 2;
+            }
+            break;
+        }
+        default:
+            Index_Usage();
+            return 2;
+        }
+    }
+    if (first >= argc)
+    {
+        Index_Usage();
+        return 2;
+    }
+
+    if (elf_path != NULL)
+    {
+        if (RP_LogHost_ElfOpen(&elf, elf_path) != 0)
+        {
+            fprintf(stderr, "rp_log_index: cannot load ELF %s\n", elf_path);
+            return 1;
+        }
+        g_elf = &elf;
+    }
+
+    // 展开目录
+    char **paths = NULL;
+    size_t path_count = 0;
+    for (int i = first; i < argc; i++)
+    {
+        struct stat st;
+        if (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode))
+        {
+            Index_ListDir(argv[i], &paths, &path_count);
+            continue;
+        }
+        char **l = (char **)realloc(paths, (path_count + 1) * sizeof(char *));
+        if (l == NULL)
+        {
+            break;
+        }
+        paths = l;
+        paths[path_count++] = strdup(argv[i]);
+    }
+
+    int ret = 0;
+    long total = 0;
+    for (size_t i = 0; i < path_count; i++)
+    {
+        if (build)
+        {
+            if (Index_Build(paths[i]) != 0)
+            {
+                ret = 1;
+            }
+            continue;
+        }
+
+        long n = Index_QueryFile(paths[i], &q, path_count > 1);
+        if (n < 0)
+        {
+            ret = 1;
+            continue;
+        }
+        if (q.count_only)
+        {
+            printf("%s: %ld\n", paths[i], n);
+        }
+        total += n;
+    }
+    if (!build && q.count_only && path_count > 1)
+    {
+        printf("total: %ld\n", total);
+    }
+
+    for (size_t i = 0; i < path_count; i++)
+    {
+        free(paths[i]);
+    }
+    free(paths);
+    if (g_elf != NULL)
+    {
+        RP_LogHost_ElfClose(&elf);
+    }
+    return ret;
+}